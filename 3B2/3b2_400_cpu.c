@@ -78,6 +78,10 @@ uint32 *ROM = NULL;
 /* Main memory. */
 uint32 *RAM = NULL;
 
+/* Memory file backing main memory, if any. */
+static char *cpu_memfile = NULL;
+static SHMEM *cpu_memshm = NULL;
+
 /* Save environment for setjmp/longjmp */
 jmp_buf save_env;
 volatile uint32 abort_context;
@@ -255,6 +259,10 @@ MTAB cpu_mod[] = {
       &cpu_set_size, NULL, NULL, "Set Memory to 2M bytes" },
     { UNIT_MSIZE, (1u << 22), NULL, "4M",
       &cpu_set_size, NULL, NULL, "Set Memory to 4M bytes" },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR|MTAB_NMO|MTAB_NC, 1, "MEMFILE", "MEMFILE=filename",
+      &cpu_set_memfile, &cpu_show_memfile, NULL, "Keep memory in a file" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOMEMFILE",
+      &cpu_set_memfile, NULL, NULL, "Keep memory in process memory" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP, 0, "HISTORY", "HISTORY",
       &cpu_set_hist, &cpu_show_hist, NULL, "Displays instruction history" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP, 0, "VIRTUAL", NULL,
@@ -1355,10 +1363,48 @@ void cpu_show_operand(FILE *st, operand *op)
     }
 }
 
-t_stat cpu_set_size(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+/*
+ * Replace main memory with a new, zeroed memory of the given size,
+ * either from the heap or mapped from a memory file.
+ */
+static t_stat cpu_alloc_ram(const char *file, uint32 size)
 {
     uint32 *nRAM = NULL;
+    SHMEM *nshm = NULL;
+    t_stat r;
+
+    if (cpu_memshm != NULL) {
+        /* Unmap first, the file may be mapped again */
+        sim_shmem_close(cpu_memshm);
+        cpu_memshm = NULL;
+        RAM = NULL;
+    }
+
+    if (file != NULL) {
+        r = sim_memmap_open(file, size, &nshm, (void **)&nRAM);
+        if (r != SCPE_OK) {
+            return r;
+        }
+    } else {
+        nRAM = (uint32 *) calloc(size >> 2, sizeof(uint32));
+        if (nRAM == NULL) {
+            return SCPE_MEM;
+        }
+    }
+
+    free(RAM);
+    RAM = nRAM;
+    cpu_memshm = nshm;
+
+    MEM_SIZE = size;
+
+    return SCPE_OK;
+}
+
+t_stat cpu_set_size(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
     uint32 uval = (uint32) val;
+    t_stat r;
 
     if ((val <= 0) || (val > MAXMEMSIZE)) {
         return SCPE_ARG;
@@ -1366,18 +1412,85 @@ t_stat cpu_set_size(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 
     /* Do (re-)allocation for memory. */
 
-    nRAM = (uint32 *) calloc(uval >> 2, sizeof(uint32));
+    r = cpu_alloc_ram(cpu_memfile, uval);
+
+    if (r != SCPE_OK && RAM == NULL) {
+        /* The memory file is lost, fall back to the heap */
+        free(cpu_memfile);
+        cpu_memfile = NULL;
+        cpu_alloc_ram(NULL, uval);
+    }
+
+    return r;
+}
+
+/*
+ * SET CPU MEMFILE=name keeps main memory in a shared mapping of a
+ * file, so that other programs can inspect it while the simulator
+ * runs. The file holds memory as host order words. The current
+ * memory contents are copied to the file.
+ */
+t_stat cpu_set_memfile(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+    uint32 *oRAM;
+    char *nfile = NULL;
+    t_stat r;
+
+    if (val == 0 && cptr != NULL) {
+        return SCPE_ARG;
+    }
+
+    if (val != 0) {
+        if (cptr == NULL || *cptr == 0) {
+            return SCPE_ARG;
+        }
+        nfile = (char *) malloc(1 + strlen(cptr));
+        if (nfile == NULL) {
+            return SCPE_MEM;
+        }
+        strcpy(nfile, cptr);
+    }
 
-    if (nRAM == NULL) {
+    /* Keep a copy of memory while it is being moved */
+    oRAM = (uint32 *) malloc((size_t) MEM_SIZE);
+    if (oRAM == NULL) {
+        free(nfile);
         return SCPE_MEM;
     }
+    memcpy(oRAM, RAM, (size_t) MEM_SIZE);
 
-    free(RAM);
-    RAM = nRAM;
+    r = cpu_alloc_ram(nfile, MEM_SIZE);
+
+    if (r != SCPE_OK) {
+        free(nfile);
+        nfile = NULL;
+        if (RAM == NULL) {
+            /* The old memory file is lost, fall back to the heap */
+            cpu_alloc_ram(NULL, MEM_SIZE);
+        } else {
+            nfile = cpu_memfile;
+            cpu_memfile = NULL;
+        }
+    }
 
-    MEM_SIZE = uval;
+    if (RAM != NULL) {
+        memcpy(RAM, oRAM, (size_t) MEM_SIZE);
+    }
+
+    free(oRAM);
+    free(cpu_memfile);
+    cpu_memfile = nfile;
+
+    return (RAM == NULL) ? SCPE_MEM : r;
+}
 
-    memset(RAM, 0, (size_t)(MEM_SIZE >> 2));
+t_stat cpu_show_memfile(FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+    if (cpu_memfile == NULL) {
+        fprintf(st, "no memory file\n");
+    } else {
+        fprintf(st, "memory file=%s\n", cpu_memfile);
+    }
 
     return SCPE_OK;
 }
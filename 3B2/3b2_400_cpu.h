@@ -498,6 +498,8 @@ t_stat cpu_ex(t_value *vptr, t_addr addr, UNIT *uptr, int32 sw);
 t_stat cpu_dep(t_value val, t_addr addr, UNIT *uptr, int32 sw);
 t_stat cpu_reset(DEVICE *dptr);
 t_stat cpu_set_size(UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_set_memfile(UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_memfile(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_set_hist(UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_hist(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_show_virt(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
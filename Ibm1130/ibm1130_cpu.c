@@ -478,18 +478,14 @@ static const char *xio_funcs[] = {
 static int32 ibm1130_qcount ()
 {
     int32 i, cnt;
-    UNIT *uptr;
+    uint32 j;
     DEVICE *dptr;
 
     cnt = 0;
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
-        dptr = find_dev_from_unit (uptr);
-        for (i=0; sim_devices[i]; i++)
-            if (dptr == sim_devices[i]) {
+    for (i=0; (dptr = sim_devices[i]) != NULL; i++)
+        for (j=0; j < dptr->numunits; j++)
+            if (_sim_activate_queue_time (&dptr->units[j]) != 0)   /* on the event queue? */
                 cnt++;
-                break;
-            }
-    }
     return cnt;
 }
 
@@ -667,6 +667,9 @@ MTAB cpu_mod[] = {
     { 0 }
     };
 
+BRKWATCH cpu_watch_vir;                                 /* virtual data breakpoint pages */
+BRKWATCH cpu_watch_phy;                                 /* physical data breakpoint pages */
+
 BRKTYPTAB cpu_breakpoints [] = {
     BRKTYPE('E',"Execute Instruction at Virtual Address"),
     BRKTYPE('P',"Execute Instruction at Physical Address"),
@@ -2605,9 +2608,7 @@ if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     ABORT (TRAP_ODD);
     }
 pa = relocR (va);                                       /* relocate */
-if (BPT_SUMM_RD &&
-    (sim_brk_test (va & 0177777, BPT_RDVIR) ||
-     sim_brk_test (pa, BPT_RDPHY)))                     /* read breakpoint? */
+if (BPT_TEST_RD (va, pa))                               /* read breakpoint? */
     ABORT (ABRT_BKPT);                                  /* stop simulation */
 if (ADDR_IS_MEM (pa))                                   /* memory address? */
     return RdMemW (pa);
@@ -2632,9 +2633,7 @@ if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     ABORT (TRAP_ODD);
     }
 pa = relocR (va);                                       /* relocate */
-if (BPT_SUMM_RD &&
-    (sim_brk_test (va & 0177777, BPT_RDVIR) ||
-     sim_brk_test (pa, BPT_RDPHY)))                     /* read breakpoint? */
+if (BPT_TEST_RD (va, pa))                               /* read breakpoint? */
     ABORT (ABRT_BKPT);                                  /* stop simulation */
 return PReadW (pa);
 }
@@ -2644,9 +2643,7 @@ int32 ReadB (int32 va)
 int32 pa;
 
 pa = relocR (va);                                       /* relocate */
-if (BPT_SUMM_RD &&
-    (sim_brk_test (va & 0177777, BPT_RDVIR) ||
-     sim_brk_test (pa, BPT_RDPHY)))                     /* read breakpoint? */
+if (BPT_TEST_RD (va, pa))                               /* read breakpoint? */
     ABORT (ABRT_BKPT);                                  /* stop simulation */
 return PReadB (pa);
 }
@@ -2663,9 +2660,7 @@ if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     ABORT (TRAP_ODD);
     }
 pa = relocR (va);                                       /* relocate */
-if (BPT_SUMM_RD &&
-    (sim_brk_test (va & 0177777, BPT_RDVIR) ||
-     sim_brk_test (pa, BPT_RDPHY)))                     /* read breakpoint? */
+if (BPT_TEST_RD (va, pa))                               /* read breakpoint? */
     reason = STOP_IBKPT;                                /* report that */
 return PReadW (pa);
 }
@@ -2677,9 +2672,7 @@ if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     ABORT (TRAP_ODD);
     }
 last_pa = relocW (va);                                  /* reloc, wrt chk */
-if (BPT_SUMM_RW &&
-    (sim_brk_test (va & 0177777, BPT_RWVIR) ||
-     sim_brk_test (last_pa, BPT_RWPHY)))                /* read or write breakpoint? */
+if (BPT_TEST_RW (va, last_pa))                          /* read or write breakpoint? */
     ABORT (ABRT_BKPT);                                  /* stop simulation */
 return PReadW (last_pa);
 }
@@ -2687,9 +2680,7 @@ return PReadW (last_pa);
 int32 ReadMB (int32 va)
 {
 last_pa = relocW (va);                                  /* reloc, wrt chk */
-if (BPT_SUMM_RW &&
-    (sim_brk_test (va & 0177777, BPT_RWVIR) ||
-     sim_brk_test (last_pa, BPT_RWPHY)))                /* read or write breakpoint? */
+if (BPT_TEST_RW (va, last_pa))                          /* read or write breakpoint? */
     ABORT (ABRT_BKPT);                                  /* stop simulation */
 return PReadB (last_pa);
 }
@@ -2746,9 +2737,7 @@ if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     ABORT (TRAP_ODD);
     }
 pa = relocW (va);                                       /* relocate */
-if (BPT_SUMM_WR &&
-    (sim_brk_test (va & 0177777, BPT_WRVIR) ||
-     sim_brk_test (pa, BPT_WRPHY)))                     /* write breakpoint? */
+if (BPT_TEST_WR (va, pa))                               /* write breakpoint? */
     ABORT (ABRT_BKPT);                                  /* stop simulation */
 PWriteW (data, pa);
 }
@@ -2758,9 +2747,7 @@ void WriteB (int32 data, int32 va)
 int32 pa;
 
 pa = relocW (va);                                       /* relocate */
-if (BPT_SUMM_WR &&
-    (sim_brk_test (va & 0177777, BPT_WRVIR) ||
-     sim_brk_test (pa, BPT_WRPHY)))                     /* write breakpoint? */
+if (BPT_TEST_WR (va, pa))                               /* write breakpoint? */
     ABORT (ABRT_BKPT);                                  /* stop simulation */
 PWriteB (data, pa);
 }
@@ -2777,9 +2764,7 @@ if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     ABORT (TRAP_ODD);
     }
 pa = relocW (va);                                       /* relocate */
-if (BPT_SUMM_WR &&
-    (sim_brk_test (va & 0177777, BPT_WRVIR) ||
-     sim_brk_test (pa, BPT_WRPHY)))                     /* write breakpoint? */
+if (BPT_TEST_WR (va, pa))                               /* write breakpoint? */
     reason = STOP_IBKPT;                                /* report that */
 PWriteW (data, pa);
 }
@@ -3374,6 +3359,9 @@ if (M == NULL) {                    /* First time init */
                     SWMASK ('R')|SWMASK ('S')|
                     SWMASK ('W')|SWMASK ('X');
     sim_brk_type_desc = cpu_breakpoints;
+    if ((sim_brk_watch_init (&cpu_watch_vir, BPT_RWVIR, 16, BPT_WVIR_PGSHIFT) != SCPE_OK) ||
+        (sim_brk_watch_init (&cpu_watch_phy, BPT_RWPHY, 22, BPT_WPHY_PGSHIFT) != SCPE_OK))
+        return SCPE_MEM;
     sim_vm_is_subroutine_call = &cpu_is_pc_a_subroutine_call;
     sim_clock_precalibrate_commands = pdp11_clock_precalibrate_commands;
     auto_config(NULL, 0);           /* do an initial auto configure */
@@ -847,6 +847,17 @@ typedef struct pdp_dib DIB;
 #define BPT_SUMM_RD (sim_brk_summ & (BPT_RDVIR | BPT_RDPHY))
 #define BPT_SUMM_WR (sim_brk_summ & (BPT_WRVIR | BPT_WRPHY))
 #define BPT_SUMM_RW (sim_brk_summ & (BPT_RWVIR | BPT_RWPHY))
+/* Data breakpoint tests.  The page watch maps let accesses to pages
+   without read or write breakpoints skip the breakpoint table search. */
+#define BPT_WVIR_PGSHIFT 6                              /* 64B virtual watch pages */
+#define BPT_WPHY_PGSHIFT 9                              /* 512B physical watch pages */
+#define BPT_TEST(va,pa,vt,pt) \
+    ((SIM_BRK_WATCHED (&cpu_watch_vir, va) && sim_brk_test ((va) & 0177777, vt)) || \
+     (SIM_BRK_WATCHED (&cpu_watch_phy, pa) && sim_brk_test (pa, pt)))
+#define BPT_TEST_RD(va,pa) (BPT_SUMM_RD && BPT_TEST (va, pa, BPT_RDVIR, BPT_RDPHY))
+#define BPT_TEST_WR(va,pa) (BPT_SUMM_WR && BPT_TEST (va, pa, BPT_WRVIR, BPT_WRPHY))
+#define BPT_TEST_RW(va,pa) (BPT_SUMM_RW && BPT_TEST (va, pa, BPT_RWVIR, BPT_RWPHY))
+extern BRKWATCH cpu_watch_vir, cpu_watch_phy;
 
 /* Function prototypes */
 
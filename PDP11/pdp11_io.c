@@ -249,8 +249,83 @@ return uba_last;
      trimmed to 18b.
    - In a Qbus configuration, the map is always disabled.
      Device addresses are trimmed to 22b.
+
+   On little-endian hosts the bus byte order matches the layout of M,
+   so each run of bus addresses that is contiguous in memory is moved
+   with memcpy.  Big-endian hosts (and the UC15, whose memory is not in
+   M) use the byte and word loops.
 */
 
+#if !defined (UC15)
+
+/* Find the memory run for bus addresses ba..lim-1 - returns length, 0 if NXM */
+
+static uint32 Map_Run (uint32 ba, uint32 lim, uint32 *ma)
+{
+uint32 lnt;
+
+if (cpu_bme) {                                          /* map enabled? */
+    *ma = Map_Addr (ba);
+    lnt = UBM_PAGSIZE - UBM_GETOFF (ba);                /* rest of page */
+    while ((lnt < (lim - ba)) &&                        /* extend run */
+        (Map_Addr (ba + lnt) == (*ma + lnt)))
+        lnt = lnt + UBM_PAGSIZE;
+    }
+else {                                                  /* physical */
+    *ma = ba;
+    lnt = lim - ba;
+    }
+if (!ADDR_IS_MEM (*ma))                                 /* NXM? */
+    return 0;
+if (lnt > (lim - ba))
+    lnt = lim - ba;
+if ((*ma + lnt) > MEMSIZE)                              /* trim to memory */
+    lnt = MEMSIZE - *ma;
+return lnt;
+}
+
+static int32 Map_ReadBulk (uint32 ba, uint32 lim, uint8 *buf)
+{
+uint32 lnt, ma;
+
+if (ba >= lim)                                          /* nothing to do? */
+    return 0;
+for ( ; ba < lim; ba = ba + lnt, buf = buf + lnt) {
+    if ((lnt = Map_Run (ba, lim, &ma)) == 0)            /* NXM? err */
+        break;
+    memcpy (buf, ((uint8 *) M) + ma, lnt);
+    }
+if (cpu_bme)                                            /* last map access */
+    Map_Addr ((ba < lim)? ba: lim - 1);
+return (lim - ba);
+}
+
+static int32 Map_WriteBulk (uint32 ba, uint32 lim, const uint8 *buf)
+{
+uint32 lnt, ma;
+
+if (ba >= lim)                                          /* nothing to do? */
+    return 0;
+for ( ; ba < lim; ba = ba + lnt, buf = buf + lnt) {
+    if ((lnt = Map_Run (ba, lim, &ma)) == 0)            /* NXM? err */
+        break;
+    memcpy (((uint8 *) M) + ma, buf, lnt);
+    }
+if (cpu_bme)                                            /* last map access */
+    Map_Addr ((ba < lim)? ba: lim - 1);
+return (lim - ba);
+}
+
+#define MAP_BULK_OK(ba) (sim_end && (cpu_bme || ADDR_IS_MEM (ba)))
+
+#else
+
+#define MAP_BULK_OK(ba) 0
+#define Map_ReadBulk(ba,lim,buf) 0
+#define Map_WriteBulk(ba,lim,buf) 0
+
+#endif
+
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
 {
 uint32 alim, lim, ma;
@@ -271,6 +346,8 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
     }
 ba = ba & BUSMASK;                                      /* trim address */
 lim = ba + bc;
+if (MAP_BULK_OK (ba))                                   /* memcpy runs? */
+    return Map_ReadBulk (ba, lim, buf);
 if (cpu_bme) {                                          /* map enabled? */
     for ( ; ba < lim; ba++) {                           /* by bytes */
         ma = Map_Addr (ba);                             /* map addr */
@@ -314,6 +391,8 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
     }
 ba = (ba & BUSMASK) & ~01;                              /* trim, align addr */
 lim = ba + (bc & ~01);
+if (MAP_BULK_OK (ba))                                   /* memcpy runs? */
+    return Map_ReadBulk (ba, lim, (uint8 *) buf);
 if (cpu_bme) {                                          /* map enabled? */
     for (; ba < lim; ba = ba + 2) {                     /* by words */
         ma = Map_Addr (ba);                             /* map addr */
@@ -353,6 +432,8 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 }
 ba = ba & BUSMASK;                                      /* trim address */
 lim = ba + bc;
+if (MAP_BULK_OK (ba))                                   /* memcpy runs? */
+    return Map_WriteBulk (ba, lim, buf);
 if (cpu_bme) {                                          /* map enabled? */
     for ( ; ba < lim; ba++) {                           /* by bytes */
         ma = Map_Addr (ba);                             /* map addr */
@@ -394,6 +475,8 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 }
 ba = (ba & BUSMASK) & ~01;                              /* trim, align addr */
 lim = ba + (bc & ~01);
+if (MAP_BULK_OK (ba))                                   /* memcpy runs? */
+    return Map_WriteBulk (ba, lim, (const uint8 *) buf);
 if (cpu_bme) {                                          /* map enabled? */
     for (; ba < lim; ba = ba + 2) {                     /* by words */
         ma = Map_Addr (ba);                             /* map addr */
@@ -153,6 +153,7 @@ extern int32 MMR2;
 #define RQ_NUMBY        512                             /* bytes per block */
 #define RQ_MAXFR        (1 << 16)                       /* max xfer */
 #define RQ_MAPXFER      (1u << 31)                      /* mapped xfer */
+#define RQ_MAXQD        8                               /* max xfers in flight/unit */
 #define RQ_M_PFN        0x1FFFFF                        /* map entry PFN */
 
 #define UNIT_V_ONL      (DKUF_V_UF + 0)                 /* online */
@@ -176,6 +177,8 @@ extern int32 MMR2;
 #define io_status       u5                              /* io status from callback */
 #define io_complete     u6                              /* io completion flag */
 #define rqxb            filebuf                         /* xfer buffer */
+#define rqxf            up7                             /* queued xfer state */
+#define xfpk            u3                              /* pkts in xfer slots */
 #define UNIT_WPRT       (UNIT_WLK | UNIT_RO)            /* write prot */
 #define RQ_RMV(u)       ((drv_tab[GET_DTYPE (u->flags)].flgs & RQDF_RMV)? \
                         UF_RMV: 0)
@@ -192,6 +195,13 @@ extern int32 MMR2;
 #define CST_UP          7                               /* online */
 #define CST_DEAD        8                               /* fatal error */
 
+#define XF_FREE         0                               /* slot unused */
+#define XF_TOP          1                               /* start next chunk */
+#define XF_IO           2                               /* chunk I/O in progress */
+#define XF_BOT          3                               /* chunk I/O done */
+#define XF_ABO          4                               /* aborted, I/O in progress */
+#define XF_DONE         5                               /* command finished */
+
 #define ERR             0                               /* must be SCPE_OK! */
 #define OK              1
 
@@ -845,8 +855,51 @@ typedef struct {
     struct uq_ring      rq;                             /* rsp ring */
     struct rqpkt        pak[RQ_NPKTS];                  /* packet queue */
     uint16              max_plug;                       /* highest unit plug number */
+    uint32              qdepth;                         /* xfers in flight per unit */
+    uint32              xseq;                           /* chunk issue sequence */
     } MSC;
 
+#define RQ_XQ(cp)       ((cp)->qdepth > 1)              /* cmd queueing? */
+
+/* Command queueing state
+
+   With SET RQ CMDQUEUE=n (n > 1), up to n transfer commands per unit are
+   in flight at once, each in its own slot with its own transfer buffer.
+   sim_disk services a unit's requests in issue order, so chunk completions
+   are matched to slots by issue sequence.  Each command is answered as
+   soon as it finishes, so a short transfer queued behind a long one can
+   complete first.  Waiting transfers are started in elevator (LOOK) order
+   from the last block issued, except that a transfer is never started
+   ahead of an overlapping write (or a write ahead of an overlapping
+   transfer).  A non-transfer command waits until the unit is idle.
+
+   The disk unit cannot be rescheduled while it has requests outstanding,
+   so queued transfers are driven from the controller's queue unit.
+
+   The slots themselves are not saved; each unit's mask of the packets
+   holding its slots (xfpk) is.  When a unit is attached, which includes
+   the reattach done by RESTORE, or when the queue unit finds a mask
+   that no longer matches the slots, the slots are dropped and their
+   packets go back to the head of the unit queue, so those transfers
+   start over from their first block.
+*/
+
+typedef struct {
+    uint16              pkt;                            /* command packet */
+    uint16              state;                          /* XF_xxx */
+    t_stat              io_status;                      /* chunk status */
+    uint32              iostarttime;                    /* chunk start time */
+    uint32              seq;                            /* chunk issue sequence */
+    uint16              *xb;                            /* xfer buffer */
+    } RQXF;
+
+typedef struct {
+    uint32              nact;                           /* slots in use */
+    uint32              head;                           /* lbn after last chunk */
+    int32               dir;                            /* elevator direction */
+    RQXF                xf[RQ_MAXQD];                   /* xfer slots */
+    } RQUQ;
+
 /* debugging bitmaps */
 #define DBG_TRC  0x0001                                 /* trace routine calls */
 #define DBG_INI  0x0002                                 /* display setup/init sequence info */
@@ -913,6 +966,8 @@ t_stat rq_show_plug (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_set_drives (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat rq_show_type (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_ctype (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat rq_set_cmdq (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat rq_show_cmdq (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_wlk (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_ctrl (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_unitq (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
@@ -944,6 +999,17 @@ t_bool rq_getdesc (MSC *cp, struct uq_ring *ring, uint32 *desc);
 t_bool rq_putdesc (MSC *cp, struct uq_ring *ring, uint32 desc);
 uint16 rq_rw_valid (MSC *cp, uint16 pkt, UNIT *uptr, uint16 cmd);
 t_bool rq_rw_end (MSC *cp, UNIT *uptr, uint16 flg, uint16 sts);
+t_stat rq_xfer (MSC *cp, UNIT *uptr, RQXF *xf, t_bool bottom, t_stat io_status);
+RQXF *rq_xf_get (MSC *cp, UNIT *uptr);
+uint16 rq_xf_find (MSC *cp, UNIT *uptr, uint32 ref);
+uint16 rq_xf_next (MSC *cp, UNIT *uptr);
+t_bool rq_xf_conflict (MSC *cp, UNIT *uptr, uint16 pkt, uint16 stop);
+void rq_xf_step (MSC *cp, UNIT *uptr, RQXF *xf);
+void rq_xf_abo (UNIT *uptr, uint16 pkt);
+void rq_xf_bind (UNIT *uptr);
+void rq_xf_restart (MSC *cp, UNIT *uptr);
+void rq_xf_svc (MSC *cp, DEVICE *dptr);
+void rq_xf_sched (MSC *cp, int32 delay);
 uint32 rq_map_ba (uint32 ba, uint32 ma);
 int32 rq_readb (uint32 ba, int32 bc, uint32 ma, uint8 *buf);
 int32 rq_readw (uint32 ba, int32 bc, uint32 ma, uint16 *buf);
@@ -1014,6 +1080,7 @@ REG rq_reg[] = {
     { FLDATA  (PRGI,    rq_ctx.prgi,                 0), REG_HIDDEN },
     { FLDATA  (PIP,     rq_ctx.pip,                  0), REG_HIDDEN },
     { BINRDATA(CTYPE,   rq_ctx.ctype,               32), REG_HIDDEN },
+    { DRDATA  (QDEPTH,  rq_ctx.qdepth,               4), REG_HIDDEN },
     { DRDATAD (ITIME,   rq_itime,                   24, "init time delay, except stage 4"), PV_LEFT + REG_NZ },
     { DRDATAD (I4TIME,  rq_itime4,                  24, "init stage 4 delay"), PV_LEFT + REG_NZ },
     { DRDATAD (QTIME,   rq_qtime,                   24, "response time for 'immediate' packets"), PV_LEFT + REG_NZ },
@@ -1022,6 +1089,7 @@ REG rq_reg[] = {
     { URDATAD (CPKT,    rq_unit[0].cpkt, 10, 5, 0, RQ_NUMDR, 0, "current packet, units 0 to 3") },
     { URDATAD (UCNUM,   rq_unit[0].cnum, 10, 5, 0, RQ_NUMDR, 0, "ctrl number, units 0 to 3") },
     { URDATAD (PKTQ,    rq_unit[0].pktq, 10, 5, 0, RQ_NUMDR, 0, "packet queue, units 0 to 3") },
+    { URDATAD (XFPK,    rq_unit[0].xfpk, DEV_RDX, 32, 0, RQ_NUMDR, REG_HIDDEN, "xfer slot packets, units 0 to 3") },
     { URDATAD (UFLG,    rq_unit[0].uf,  DEV_RDX, 16, 0, RQ_NUMDR, 0, "unit flags, units 0 to 3") },
     { URDATA  (CAPAC,   rq_unit[0].capac, 10, T_ADDR_W, 0, RQ_NUMDR, PV_LEFT | REG_HRO) },
     { URDATAD (PLUG,    rq_unit[0].unit_plug, 10, 32, 0, RQ_NUMDR, PV_LEFT | REG_RO, "unit plug value, units 0 to 3") },
@@ -1118,6 +1186,8 @@ MTAB rq_mod[] = {
       &rq_set_plug, &rq_show_plug, NULL, "Set/Display Unit plug value" },
     { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, NULL, "DRIVES=val (4-254)",
       &rq_set_drives, NULL, NULL, "Set Number of Drives" },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "CMDQUEUE", "CMDQUEUE=val (1-8)",
+      &rq_set_cmdq, &rq_show_cmdq, NULL, "Set/Display transfer commands in flight per drive" },
     { UNIT_NOAUTO, UNIT_NOAUTO, "noautosize", "NOAUTOSIZE", NULL, NULL, NULL, "Disable disk autosize on attach" },
     { UNIT_NOAUTO,           0, "autosize",   "AUTOSIZE",   NULL, NULL, NULL, "Enable disk autosize on attach" },
     { MTAB_XTD|MTAB_VUN|MTAB_VALR, 0, "FORMAT", "FORMAT={AUTO|SIMH|VHD|RAW}",
@@ -1199,10 +1269,12 @@ REG rqb_reg[] = {
     { FLDATA  (PRGI,    rqb_ctx.prgi,                 0), REG_HIDDEN },
     { FLDATA  (PIP,     rqb_ctx.pip,                  0), REG_HIDDEN },
     { BINRDATA(CTYPE,   rqb_ctx.ctype,               32), REG_HIDDEN },
+    { DRDATA  (QDEPTH,  rqb_ctx.qdepth,               4), REG_HIDDEN },
     { BRDATAD (PKTS,    rqb_ctx.pak,     DEV_RDX,    16, sizeof(rq_ctx.pak)/2, "packet buffers, 33W each, 32 entries") },
     { URDATAD (CPKT,    rqb_unit[0].cpkt, 10, 5, 0, RQ_NUMDR, 0, "current packet, units 0 to 3") },
     { URDATAD (UCNUM,   rqb_unit[0].cnum, 10, 5, 0, RQ_NUMDR, 0, "ctrl number, units 0 to 3") },
     { URDATAD (PKTQ,    rqb_unit[0].pktq, 10, 5, 0, RQ_NUMDR, 0, "packet queue, units 0 to 3") },
+    { URDATAD (XFPK,    rqb_unit[0].xfpk, DEV_RDX, 32, 0, RQ_NUMDR, REG_HIDDEN, "xfer slot packets, units 0 to 3") },
     { URDATAD (UFLG,    rqb_unit[0].uf,  DEV_RDX, 16, 0, RQ_NUMDR, 0, "unit flags, units 0 to 3") },
     { URDATA  (CAPAC,   rqb_unit[0].capac, 10, T_ADDR_W, 0, RQ_NUMDR, PV_LEFT | REG_HRO) },
     { URDATAD (PLUG,    rqb_unit[0].unit_plug, 10, 32, 0, RQ_NUMDR, PV_LEFT | REG_RO, "unit plug value, units 0 to 3") },
@@ -1272,10 +1344,12 @@ REG rqc_reg[] = {
     { FLDATA  (PRGI,    rqc_ctx.prgi,                 0), REG_HIDDEN },
     { FLDATA  (PIP,     rqc_ctx.pip,                  0), REG_HIDDEN },
     { BINRDATA(CTYPE,   rqc_ctx.ctype,               32), REG_HIDDEN },
+    { DRDATA  (QDEPTH,  rqc_ctx.qdepth,               4), REG_HIDDEN },
     { BRDATAD (PKTS,    rqc_ctx.pak,     DEV_RDX,    16, sizeof(rq_ctx.pak)/2, "packet buffers, 33W each, 32 entries") },
     { URDATAD (CPKT,    rqc_unit[0].cpkt, 10, 5, 0, RQ_NUMDR, 0, "current packet, units 0 to 3") },
     { URDATAD (UCNUM,   rqc_unit[0].cnum, 10, 5, 0, RQ_NUMDR, 0, "ctrl number, units 0 to 3") },
     { URDATAD (PKTQ,    rqc_unit[0].pktq, 10, 5, 0, RQ_NUMDR, 0, "packet queue, units 0 to 3") },
+    { URDATAD (XFPK,    rqc_unit[0].xfpk, DEV_RDX, 32, 0, RQ_NUMDR, REG_HIDDEN, "xfer slot packets, units 0 to 3") },
     { URDATAD (UFLG,    rqc_unit[0].uf,  DEV_RDX, 16, 0, RQ_NUMDR, 0, "unit flags, units 0 to 3") },
     { URDATA  (CAPAC,   rqc_unit[0].capac, 10, T_ADDR_W, 0, RQ_NUMDR, PV_LEFT | REG_HRO) },
     { URDATAD (PLUG,    rqc_unit[0].unit_plug, 10, 32, 0, RQ_NUMDR, PV_LEFT | REG_RO, "unit plug value, units 0 to 3") },
@@ -1345,10 +1419,12 @@ REG rqd_reg[] = {
     { FLDATA  (PRGI,    rqd_ctx.prgi,                 0), REG_HIDDEN },
     { FLDATA  (PIP,     rqd_ctx.pip,                  0), REG_HIDDEN },
     { BINRDATA(CTYPE,   rqd_ctx.ctype,               32), REG_HIDDEN },
+    { DRDATA  (QDEPTH,  rqd_ctx.qdepth,               4), REG_HIDDEN },
     { BRDATAD (PKTS,    rqd_ctx.pak,     DEV_RDX,    16, sizeof(rq_ctx.pak)/2, "packet buffers, 33W each, 32 entries") },
     { URDATAD (CPKT,    rqd_unit[0].cpkt, 10, 5, 0, RQ_NUMDR, 0, "current packet, units 0 to 3") },
     { URDATAD (UCNUM,   rqd_unit[0].cnum, 10, 5, 0, RQ_NUMDR, 0, "ctrl number, units 0 to 3") },
     { URDATAD (PKTQ,    rqd_unit[0].pktq, 10, 5, 0, RQ_NUMDR, 0, "packet queue, units 0 to 3") },
+    { URDATAD (XFPK,    rqd_unit[0].xfpk, DEV_RDX, 32, 0, RQ_NUMDR, REG_HIDDEN, "xfer slot packets, units 0 to 3") },
     { URDATAD (UFLG,    rqd_unit[0].uf,  DEV_RDX, 16, 0, RQ_NUMDR, 0, "unit flags, units 0 to 3") },
     { URDATA  (CAPAC,   rqd_unit[0].capac, 10, T_ADDR_W, 0, RQ_NUMDR, PV_LEFT | REG_HRO) },
     { URDATAD (PLUG,    rqd_unit[0].unit_plug, 10, 32, 0, RQ_NUMDR, PV_LEFT | REG_RO, "unit plug value, units 0 to 3") },
@@ -1584,6 +1660,8 @@ if (cp->csta < CST_UP) {                                /* still init? */
     return SCPE_OK;
     }                                                   /* end if */
 
+if (RQ_XQ (cp))                                         /* cmd queueing? */
+    rq_xf_svc (cp, dptr);                               /* run queued xfers */
 for (i = 0; i < RQ_NUMDR; i++) {                        /* chk unit q's */
     nuptr = dptr->units + i;                            /* ptr to unit */
     if (nuptr->cpkt || (nuptr->pktq == 0))
@@ -1624,8 +1702,11 @@ if (cp->rspq) {                                         /* resp q? */
         return SCPE_OK;
     sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_quesvc - rq_putpkt failed - 1\n");
     }                                                   /* end if resp q */
-if (pkt)                                                /* more to do? */
-    sim_activate (uptr, rq_qtime);
+if (pkt) {                                              /* more to do? */
+    if (RQ_XQ (cp))                                     /* may be waiting */
+        rq_xf_sched (cp, rq_qtime);                     /* on a chunk */
+    else sim_activate (uptr, rq_qtime);
+    }
 return SCPE_OK;                                         /* done */
 }
 
@@ -1660,6 +1741,7 @@ return SCPE_OK;
 t_bool rq_mscp (MSC *cp, uint16 pkt, t_bool q)
 {
 uint16 sts, cmd = GETP (pkt, CMD_OPC, OPC);
+UNIT *uptr;
 
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_mscp - %s\n", q? "Queue" : "No Queue");
 
@@ -1696,9 +1778,13 @@ switch (cmd) {
     case OP_WR:                                         /* write */
         return rq_rw (cp, pkt, q);
 
+    case OP_FLU:                                        /* flush */
+        if ((uptr = rq_getucb (cp, cp->pak[pkt].d[CMD_UN])) &&
+            (uptr->flags & UNIT_ATT))
+            sim_disk_flush (uptr);                      /* write back cached data */
+        /* fall through */
     case OP_CCD:                                        /* nops */
     case OP_DAP:
-    case OP_FLU:
         cmd = cmd | OP_END;                             /* set end flag */
         sts = ST_SUC;                                   /* success */
         break;
@@ -1720,7 +1806,7 @@ t_bool rq_abo (MSC *cp, uint16 pkt, t_bool q)
 uint16 lu = cp->pak[pkt].d[CMD_UN];                     /* unit # */
 uint16 cmd = GETP (pkt, CMD_OPC, OPC);                  /* opcode */
 uint32 ref = GETP32 (pkt, ABO_REFL);                    /* cmd ref # */
-uint16 tpkt, prv;
+uint16 tpkt, prv, cpkt;
 UNIT *uptr;
 DEVICE *dptr = rq_devmap[cp->cnum];
 
@@ -1728,11 +1814,15 @@ sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_abo\n");
 
 tpkt = 0;                                               /* set no mtch */
 if ((uptr = rq_getucb (cp, lu))) {                      /* get unit */
-    if (uptr->cpkt &&                                   /* curr pkt? */
-        (GETP32 (uptr->cpkt, CMD_REFL) == ref)) {       /* match ref? */
-        tpkt = uptr->cpkt;                              /* save match */
-        uptr->cpkt = 0;                                 /* gonzo */
-        sim_cancel (uptr);                              /* cancel unit */
+    if ((cpkt = rq_xf_find (cp, uptr, ref)) &&          /* curr pkt? */
+        (GETP32 (cpkt, CMD_REFL) == ref)) {             /* match ref? */
+        tpkt = cpkt;                                    /* save match */
+        if (RQ_XQ (cp))                                 /* queued xfer? */
+            rq_xf_abo (uptr, tpkt);                     /* release slot */
+        else {
+            uptr->cpkt = 0;                             /* gonzo */
+            sim_cancel (uptr);                          /* cancel unit */
+            }
         sim_activate (dptr->units + RQ_QUEUE, rq_qtime);
         }
     else if (uptr->pktq &&                              /* head of q? */
@@ -1801,7 +1891,7 @@ UNIT *uptr;
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_gcs\n");
 
 if ((uptr = rq_getucb (cp, lu)) &&                      /* valid lu? */
-    (tpkt = uptr->cpkt) &&                              /* queued pkt? */
+    (tpkt = rq_xf_find (cp, uptr, ref)) &&              /* queued pkt? */
     (GETP32 (tpkt, CMD_REFL) == ref) &&                 /* match ref? */
     (GETP (tpkt, CMD_OPC, OPC) >= OP_ACC)) {            /* rd/wr cmd? */
     cp->pak[pkt].d[GCS_STSL] = cp->pak[tpkt].d[RW_WBCL];
@@ -2005,11 +2095,21 @@ uint16 lu = cp->pak[pkt].d[CMD_UN];                     /* unit # */
 uint16 cmd = GETP (pkt, CMD_OPC, OPC);                  /* opcode */
 uint16 sts;
 UNIT *uptr;
+RQXF *xf = NULL;
 
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_rw(lu=%d, pkt=%d, queue=%s)\n", lu, pkt, q?"yes" : "no");
 
 if ((uptr = rq_getucb (cp, lu))) {                      /* unit exist? */
-    if (q && uptr->cpkt) {                              /* need to queue? */
+    if (RQ_XQ (cp)) {                                   /* cmd queueing? */
+        xf = rq_xf_get (cp, uptr);                      /* free slot? */
+        if ((xf == NULL) && !q &&                       /* none, slots busy? */
+            uptr->rqxf && ((RQUQ *) uptr->rqxf)->nact) {
+            rq_enqh (cp, &uptr->pktq, pkt);             /* retry later */
+            return OK;
+            }
+        }
+    if (q && (RQ_XQ (cp)? (uptr->pktq || (xf == NULL) || /* need to queue? */
+        rq_xf_conflict (cp, uptr, pkt, 0)): uptr->cpkt)) {
         uint16 tpktq = uptr->pktq;
 
         sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_rw - queued\n");
@@ -2019,6 +2119,8 @@ if ((uptr = rq_getucb (cp, lu))) {                      /* unit exist? */
         return OK;
         }
     sts = rq_rw_valid (cp, pkt, uptr, cmd);             /* validity checks */
+    if ((sts == 0) && RQ_XQ (cp) && (xf == NULL))       /* no xfer buffer? */
+        sts = ST_CNT;                                   /* ctrl err */
     if (sts == 0) {                                     /* ok? */
         uptr->cpkt = pkt;                               /* op in progress */
         cp->pak[pkt].d[RW_WBAL] = cp->pak[pkt].d[RW_BAL];
@@ -2029,6 +2131,15 @@ if ((uptr = rq_getucb (cp, lu))) {                      /* unit exist? */
         cp->pak[pkt].d[RW_WBLH] = cp->pak[pkt].d[RW_LBNH];
         cp->pak[pkt].d[RW_WMPL] = cp->pak[pkt].d[RW_MAPL];
         cp->pak[pkt].d[RW_WMPH] = cp->pak[pkt].d[RW_MAPH];
+        if (xf) {                                       /* queued xfer? */
+            xf->pkt = pkt;                              /* claim slot */
+            xf->state = XF_TOP;
+            ((RQUQ *) uptr->rqxf)->nact++;
+            uptr->xfpk |= (1u << pkt);
+            rq_xf_step (cp, uptr, xf);                  /* start it */
+            sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_rw - started, slot %d\n", (int)(xf - ((RQUQ *) uptr->rqxf)->xf));
+            return OK;
+            }
         uptr->iostarttime = sim_grtime();
         sim_activate (uptr, 0);                         /* activate */
         sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_rw - started\n");
@@ -2089,6 +2200,31 @@ MSC *cp = rq_ctxmap[uptr->cnum];
 
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_io_complete(status=%d)\n", status);
 
+if (RQ_XQ (cp)) {                                       /* queued xfer? */
+    RQUQ *uq = (RQUQ *) uptr->rqxf;
+    RQXF *xf = NULL;
+    uint32 i;
+
+    for (i = 0; uq && (i < RQ_MAXQD); i++) {            /* oldest chunk */
+        if (((uq->xf[i].state == XF_IO) || (uq->xf[i].state == XF_ABO)) &&
+            ((xf == NULL) || ((int32)(uq->xf[i].seq - xf->seq) < 0)))
+            xf = &uq->xf[i];
+        }
+    if (xf == NULL)                                     /* none (reset)? */
+        return;
+    xf->io_status = status;
+    if (xf->state == XF_ABO) {                          /* aborted? */
+        xf->state = XF_FREE;                            /* slot now free */
+        uq->nact--;
+        rq_xf_bind (uptr);
+        rq_xf_sched (cp, 0);
+        }
+    else {
+        xf->state = XF_BOT;                             /* finish after delay */
+        rq_xf_sched (cp, (int32)(xf->iostarttime + rq_xtime - sim_grtime ()));
+        }
+    return;
+    }
 uptr->io_status = status;
 uptr->io_complete = 1;
 /* Reschedule for the appropriate delay */
@@ -2194,13 +2330,33 @@ return Map_WriteW (ba, bc, buf);                        /* unmapped xfer */
 t_stat rq_svc (UNIT *uptr)
 {
 MSC *cp = rq_ctxmap[uptr->cnum];
+t_bool bottom;
+
+if ((cp != NULL) && RQ_XQ (cp))                         /* queued xfers are */
+    return SCPE_OK;                                     /* run by rq_quesvc */
+if ((cp == NULL) || (uptr->cpkt == 0))                  /* what??? */
+    return STOP_RQ;
+bottom = (uptr->io_complete != 0);
+uptr->io_complete = 0;
+return rq_xfer (cp, uptr, NULL, bottom, uptr->io_status);
+}
+
+/* Process one chunk of the current transfer command
+
+   If bottom is FALSE, the next chunk is started; otherwise the chunk
+   whose disk I/O completed with io_status is finished.  xf is the
+   command's slot when command queueing is enabled; in that case the
+   caller has bound uptr->cpkt to the slot's packet.
+*/
+
+t_stat rq_xfer (MSC *cp, UNIT *uptr, RQXF *xf, t_bool bottom, t_stat io_status)
+{
 uint32 i, t, tbc, abc, wwc;
 uint32 err = 0;
 int32 pkt = uptr->cpkt;                                 /* get packet */
+uint16 *xb = xf? xf->xb: (uint16 *) uptr->rqxb;         /* xfer buffer */
 uint32 cmd, ba, bc, bl, ma;
 
-if ((cp == NULL) || (pkt == 0))                         /* what??? */
-    return STOP_RQ;
 cmd = GETP (pkt, CMD_OPC, OPC);                         /* get cmd */
 ba = GETP32 (pkt, RW_WBAL);                             /* buf addr */
 bc = GETP32 (pkt, RW_WBCL);                             /* byte count */
@@ -2209,7 +2365,7 @@ ma = GETP32 (pkt, RW_WMPL);                             /* block addr */
 
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_svc(%s,unit=%d, pkt=%d, cmd=%s, lbn=%0X, bc=%0x, phase=%s)\n",
            sim_uname (uptr), uptr->unit_plug, pkt, rq_cmdname[cp->pak[pkt].d[CMD_OPC]&0x3f], bl, bc,
-           uptr->io_complete ? "bottom" : "top");
+           bottom ? "bottom" : "top");
 
 tbc = (bc > RQ_MAXFR)? RQ_MAXFR: bc;                    /* trim cnt to max */
 
@@ -2233,38 +2389,43 @@ if ((cmd == OP_ERS) || (cmd == OP_WR)) {                /* write op? */
         }
     }
 
-if (!uptr->io_complete) { /* Top End (I/O Initiation) Processing */
+if (!bottom) { /* Top End (I/O Initiation) Processing */
+    if (xf) {                                           /* queued xfer? */
+        xf->state = XF_IO;                              /* chunk in flight */
+        xf->seq = ++cp->xseq;
+        xf->iostarttime = sim_grtime();
+        ((RQUQ *) uptr->rqxf)->head = bl + ((tbc + (RQ_NUMBY - 1)) / RQ_NUMBY);
+        }
     if (cmd == OP_ERS) {                                /* erase? */
         wwc = ((tbc + (RQ_NUMBY - 1)) & ~(RQ_NUMBY - 1)) >> 1;
-        memset (uptr->rqxb, 0, wwc * sizeof(uint16));   /* clr buf */
-        sim_disk_data_trace(uptr, (uint8 *)uptr->rqxb, bl, wwc << 1, "sim_disk_wrsect-ERS", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
-        err = sim_disk_wrsect_a (uptr, bl, (uint8 *)uptr->rqxb, NULL, (wwc << 1) / RQ_NUMBY, rq_io_complete);
+        memset (xb, 0, wwc * sizeof(uint16));           /* clr buf */
+        sim_disk_data_trace(uptr, (uint8 *)xb, bl, wwc << 1, "sim_disk_wrsect-ERS", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
+        err = sim_disk_wrsect_a (uptr, bl, (uint8 *)xb, NULL, (wwc << 1) / RQ_NUMBY, rq_io_complete);
         }
 
     else if (cmd == OP_WR) {                            /* write? */
-        t = rq_readw (ba, tbc, ma, (uint16 *)uptr->rqxb);/* fetch buffer */
+        t = rq_readw (ba, tbc, ma, xb);                 /* fetch buffer */
         if ((abc = tbc - t)) {                          /* any xfer? */
             wwc = ((abc + (RQ_NUMBY - 1)) & ~(RQ_NUMBY - 1)) >> 1;
             for (i = (abc >> 1); i < wwc; i++)
-                ((uint16 *)(uptr->rqxb))[i] = 0;
-            sim_disk_data_trace(uptr, (uint8 *)uptr->rqxb, bl, wwc << 1, "sim_disk_wrsect-WR", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
-            err = sim_disk_wrsect_a (uptr, bl, (uint8 *)uptr->rqxb, NULL, (wwc << 1) / RQ_NUMBY, rq_io_complete);
+                xb[i] = 0;
+            sim_disk_data_trace(uptr, (uint8 *)xb, bl, wwc << 1, "sim_disk_wrsect-WR", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
+            err = sim_disk_wrsect_a (uptr, bl, (uint8 *)xb, NULL, (wwc << 1) / RQ_NUMBY, rq_io_complete);
             }
         }
 
     else {  /* OP_RD & OP_CMP */
-        err = sim_disk_rdsect_a (uptr, bl, (uint8 *)uptr->rqxb, NULL, (tbc + RQ_NUMBY - 1) / RQ_NUMBY, rq_io_complete);
+        err = sim_disk_rdsect_a (uptr, bl, (uint8 *)xb, NULL, (tbc + RQ_NUMBY - 1) / RQ_NUMBY, rq_io_complete);
         }                                               /* end else read */
     return SCPE_OK;                                     /* done for now until callback */    
     }
 else { /* Bottom End (After I/O processing) */
-    uptr->io_complete = 0;
-    err = uptr->io_status;
+    err = io_status;
     if (cmd == OP_ERS) {                                /* erase? */
         }
 
     else if (cmd == OP_WR) {                            /* write? */
-        t = rq_readw (ba, tbc, ma, (uint16 *)uptr->rqxb);/* fetch buffer */
+        t = rq_readw (ba, tbc, ma, xb);                 /* fetch buffer */
         abc = tbc - t;                                  /* any xfer? */
         if (t) {                                        /* nxm? */
             PUTP32 (pkt, RW_WBCL, bc - abc);            /* adj bc */
@@ -2276,9 +2437,9 @@ else { /* Bottom End (After I/O processing) */
         }
 
     else {
-        sim_disk_data_trace(uptr, (uint8 *)uptr->rqxb, bl, tbc, "sim_disk_rdsect", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
+        sim_disk_data_trace(uptr, (uint8 *)xb, bl, tbc, "sim_disk_rdsect", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
         if ((cmd == OP_RD) && !err) {                   /* read? */
-            if ((t = rq_writew (ba, tbc, ma, (uint16 *)uptr->rqxb))) {/* store, nxm? */
+            if ((t = rq_writew (ba, tbc, ma, xb))) {    /* store, nxm? */
                 PUTP32 (pkt, RW_WBCL, bc - (tbc - t));  /* adj bc */
                 PUTP32 (pkt, RW_WBAL, ba + (tbc - t));  /* adj ba */
                 if (rq_hbe (cp, uptr))                  /* post err log */
@@ -2296,7 +2457,7 @@ else { /* Bottom End (After I/O processing) */
                         rq_rw_end (cp, uptr, EF_LOG, ST_HST | SB_HST_NXM);
                     return SCPE_OK;
                     }
-                dby = (((uint16 *)(uptr->rqxb))[i >> 1] >> ((i & 1)? 8: 0)) & 0xFF;
+                dby = (xb[i >> 1] >> ((i & 1)? 8: 0)) & 0xFF;
                 if (mby != dby) {                       /* cmp err? */
                     PUTP32 (pkt, RW_WBCL, bc - i);      /* adj bc */
                     rq_rw_end (cp, uptr, 0, ST_CMP);    /* done */
@@ -2319,8 +2480,11 @@ bl = bl + ((tbc + (RQ_NUMBY - 1)) / RQ_NUMBY);          /* incr blk # */
 PUTP32 (pkt, RW_WBAL, ba);                              /* update pkt */
 PUTP32 (pkt, RW_WBCL, bc);
 PUTP32 (pkt, RW_WBLL, bl);
-if (bc)                                                 /* more? resched */
-    sim_activate (uptr, 0);
+if (bc) {                                               /* more? resched */
+    if (xf)
+        xf->state = XF_TOP;
+    else sim_activate (uptr, 0);
+    }
 else rq_rw_end (cp, uptr, 0, ST_SUC);                   /* done! */
 return SCPE_OK;
 }
@@ -2355,6 +2519,307 @@ if (uptr->pktq)                                         /* more to do? */
 return OK;
 }
 
+/* Command queueing - get a free transfer slot, allocating on first use */
+
+RQXF *rq_xf_get (MSC *cp, UNIT *uptr)
+{
+RQUQ *uq = (RQUQ *) uptr->rqxf;
+uint32 i;
+
+if (uq == NULL) {
+    uq = (RQUQ *) calloc (1, sizeof (RQUQ));
+    if (uq == NULL)
+        return NULL;
+    uq->dir = 1;
+    uptr->rqxf = uq;
+    }
+if (uq->nact >= cp->qdepth)                             /* at depth limit? */
+    return NULL;
+for (i = 0; i < RQ_MAXQD; i++) {
+    RQXF *xf = &uq->xf[i];
+
+    if (xf->state != XF_FREE)
+        continue;
+    if ((xf->xb == NULL) &&
+        ((xf->xb = (uint16 *) malloc (RQ_MAXFR)) == NULL))
+        return NULL;
+    return xf;
+    }
+return NULL;
+}
+
+/* Command queueing - current packet for GCS/ABO
+
+   Without command queueing this is the unit's current packet; with it,
+   the in-flight transfer with reference number ref, if any.
+*/
+
+uint16 rq_xf_find (MSC *cp, UNIT *uptr, uint32 ref)
+{
+RQUQ *uq = (RQUQ *) uptr->rqxf;
+uint32 i;
+
+if (!RQ_XQ (cp))
+    return uptr->cpkt;
+for (i = 0; uq && (i < RQ_MAXQD); i++) {
+    if ((uq->xf[i].state != XF_FREE) && (uq->xf[i].state != XF_ABO) &&
+        (GETP32 (uq->xf[i].pkt, CMD_REFL) == ref))
+        return uq->xf[i].pkt;
+    }
+return 0;
+}
+
+/* Command queueing - does a transfer overlap an earlier write?
+
+   The blocks of pkt are checked against the transfers in flight and the
+   queued transfers ahead of stop (0 = the whole queue).  Two transfers
+   conflict if their block ranges overlap and either one writes.
+*/
+
+static t_bool rq_xf_overlap (MSC *cp, uint16 a, uint16 b)
+{
+uint16 ca = GETP (a, CMD_OPC, OPC), cb = GETP (b, CMD_OPC, OPC);
+uint32 la = GETP32 (a, RW_LBNL), lb = GETP32 (b, RW_LBNL);
+uint32 na = (GETP32 (a, RW_BCL) + (RQ_NUMBY - 1)) / RQ_NUMBY;
+uint32 nb = (GETP32 (b, RW_BCL) + (RQ_NUMBY - 1)) / RQ_NUMBY;
+
+if ((ca != OP_WR) && (ca != OP_ERS) && (cb != OP_WR) && (cb != OP_ERS))
+    return FALSE;                                       /* reads commute */
+return ((la < (lb + nb)) && (lb < (la + na)));
+}
+
+t_bool rq_xf_conflict (MSC *cp, UNIT *uptr, uint16 pkt, uint16 stop)
+{
+RQUQ *uq = (RQUQ *) uptr->rqxf;
+uint16 tpkt;
+uint32 i;
+
+for (i = 0; uq && (i < RQ_MAXQD); i++) {
+    if ((uq->xf[i].state != XF_FREE) && (uq->xf[i].state != XF_ABO) &&
+        rq_xf_overlap (cp, pkt, uq->xf[i].pkt))
+        return TRUE;
+    }
+for (tpkt = uptr->pktq; tpkt && (tpkt != stop); tpkt = cp->pak[tpkt].link) {
+    if (rq_xf_overlap (cp, pkt, tpkt))
+        return TRUE;
+    }
+return FALSE;
+}
+
+/* Command queueing - pick the next queued transfer (elevator order)
+
+   Only the transfers at the front of the unit queue are candidates; a
+   non-transfer command ends the scan so that it is not overtaken.  The
+   pick is the nearest block at or beyond the last block issued in the
+   current direction; if there is none, the direction reverses.
+*/
+
+uint16 rq_xf_next (MSC *cp, UNIT *uptr)
+{
+RQUQ *uq = (RQUQ *) uptr->rqxf;
+uint16 pkt, prv, best, bprv;
+uint32 lbn, blbn, pass;
+
+for (pass = 0, best = bprv = 0, blbn = 0; (pass < 2) && (best == 0); pass++) {
+    for (prv = 0, pkt = uptr->pktq; pkt; prv = pkt, pkt = cp->pak[pkt].link) {
+        uint16 cmd = GETP (pkt, CMD_OPC, OPC);
+
+        if ((cmd != OP_ACC) && (cmd != OP_CMP) && (cmd != OP_ERS) &&
+            (cmd != OP_RD) && (cmd != OP_WR))
+            break;                                      /* not a transfer */
+        if (rq_xf_conflict (cp, uptr, pkt, pkt))        /* must wait? */
+            continue;
+        lbn = GETP32 (pkt, RW_LBNL);
+        if ((uq->dir > 0)? ((lbn >= uq->head) && ((best == 0) || (lbn < blbn))):
+                           ((lbn <= uq->head) && ((best == 0) || (lbn > blbn)))) {
+            best = pkt;
+            bprv = prv;
+            blbn = lbn;
+            }
+        }
+    if (best == 0)                                      /* none this way? */
+        uq->dir = -uq->dir;                             /* reverse */
+    }
+if (best) {                                             /* unlink pick */
+    if (bprv)
+        cp->pak[bprv].link = cp->pak[best].link;
+    else uptr->pktq = cp->pak[best].link;
+    cp->pak[best].link = 0;
+    }
+return best;
+}
+
+/* Command queueing - the unit's current packet tracks the slots
+
+   While any slot is in use, cpkt is one of their packets, so that the
+   legacy "unit busy" tests queue non-transfer commands behind them.
+*/
+
+void rq_xf_bind (UNIT *uptr)
+{
+RQUQ *uq = (RQUQ *) uptr->rqxf;
+uint32 i;
+
+uptr->cpkt = 0;
+for (i = 0; uq && (i < RQ_MAXQD); i++) {
+    if (uq->xf[i].state != XF_FREE) {
+        uptr->cpkt = uq->xf[i].pkt;
+        if (uq->xf[i].state != XF_ABO)
+            break;
+        }
+    }
+}
+
+/* Command queueing - start the slots' transfers over
+
+   The slots are rebuilt from the saved packet mask: every slot which is
+   not waiting for aborted I/O is dropped, and the packets in the mask
+   are put back at the head of the unit queue.  rq_rw reloads the
+   working fields of each, so the transfer is redone from its start.
+*/
+
+void rq_xf_restart (MSC *cp, UNIT *uptr)
+{
+RQUQ *uq = (RQUQ *) uptr->rqxf;
+uint32 pk = (uint32) uptr->xfpk;
+uint16 pkt;
+uint32 i;
+
+sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_xf_restart(%s, pkts=%X)\n", sim_uname (uptr), pk);
+
+for (i = 0; uq && (i < RQ_MAXQD); i++) {
+    if ((uq->xf[i].state != XF_FREE) && (uq->xf[i].state != XF_ABO)) {
+        uq->xf[i].state = XF_FREE;
+        uq->nact--;
+        }
+    }
+uptr->xfpk = 0;
+for (pkt = RQ_NPKTS - 1; pkt > 0; pkt--) {              /* requeue at head */
+    if (pk & (1u << pkt))
+        rq_enqh (cp, &uptr->pktq, pkt);
+    }
+rq_xf_bind (uptr);
+if (pk)
+    rq_xf_sched (cp, 0);
+}
+
+/* Command queueing - run the next step of a slot (XF_TOP or XF_BOT) */
+
+void rq_xf_step (MSC *cp, UNIT *uptr, RQXF *xf)
+{
+RQUQ *uq = (RQUQ *) uptr->rqxf;
+t_bool bottom = (xf->state == XF_BOT);
+
+uptr->cpkt = xf->pkt;                                   /* bind to slot */
+xf->state = XF_DONE;
+rq_xfer (cp, uptr, xf, bottom, xf->io_status);
+if (xf->state == XF_DONE) {                             /* cmd finished? */
+    xf->state = XF_FREE;
+    uq->nact--;
+    uptr->xfpk &= ~(1u << xf->pkt);
+    }
+rq_xf_bind (uptr);
+}
+
+/* Command queueing - abort an in-flight transfer
+
+   A slot whose chunk is still in the disk's hands keeps its buffer until
+   the I/O completes.
+*/
+
+void rq_xf_abo (UNIT *uptr, uint16 pkt)
+{
+RQUQ *uq = (RQUQ *) uptr->rqxf;
+uint32 i;
+
+for (i = 0; uq && (i < RQ_MAXQD); i++) {
+    RQXF *xf = &uq->xf[i];
+
+    if ((xf->pkt != pkt) || (xf->state == XF_FREE) || (xf->state == XF_ABO))
+        continue;
+    uptr->xfpk &= ~(1u << pkt);
+    if (xf->state == XF_IO)
+        xf->state = XF_ABO;
+    else {
+        xf->state = XF_FREE;
+        uq->nact--;
+        }
+    break;
+    }
+rq_xf_bind (uptr);
+}
+
+/* Command queueing - advance all units' queued transfers
+
+   Called from the queue unit service.  Starts pending chunks, finishes
+   chunks whose transfer time has elapsed and refills free slots from
+   the unit queues, then reschedules the queue unit for the earliest
+   chunk still waiting.
+*/
+
+void rq_xf_svc (MSC *cp, DEVICE *dptr)
+{
+uint32 i, j, pk;
+int32 due, next = -1;
+t_bool busy;
+
+for (i = 0; i < (dptr->numunits - 2); i++) {
+    UNIT *uptr = dptr->units + i;
+    RQUQ *uq = (RQUQ *) uptr->rqxf;
+    uint16 pkt;
+
+    for (j = 0, pk = 0; uq && (j < RQ_MAXQD); j++) {    /* slots match mask? */
+        if ((uq->xf[j].state != XF_FREE) && (uq->xf[j].state != XF_ABO))
+            pk |= (1u << uq->xf[j].pkt);
+        }
+    if (pk != (uint32) uptr->xfpk)                      /* no, restored */
+        rq_xf_restart (cp, uptr);
+    if (uq == NULL)
+        continue;
+    do {
+        busy = FALSE;
+        for (j = 0; j < RQ_MAXQD; j++) {
+            RQXF *xf = &uq->xf[j];
+
+            if ((xf->state == XF_BOT) &&
+                ((int32)(xf->iostarttime + rq_xtime - sim_grtime ()) > 0))
+                continue;                               /* not yet */
+            if ((xf->state == XF_TOP) || (xf->state == XF_BOT)) {
+                rq_xf_step (cp, uptr, xf);
+                busy = TRUE;
+                }
+            }
+        while ((uq->nact < cp->qdepth) && (pkt = rq_xf_next (cp, uptr))) {
+            if (!rq_mscp (cp, pkt, FALSE))              /* start it */
+                return;
+            busy = TRUE;
+            }
+        } while (busy);
+    for (j = 0; j < RQ_MAXQD; j++) {                    /* earliest wait */
+        if (uq->xf[j].state != XF_BOT)
+            continue;
+        due = (int32)(uq->xf[j].iostarttime + rq_xtime - sim_grtime ());
+        if ((next < 0) || (due < next))
+            next = due;
+        }
+    }
+if (next >= 0)
+    rq_xf_sched (cp, next);
+}
+
+/* Command queueing - run the queue unit within delay */
+
+void rq_xf_sched (MSC *cp, int32 delay)
+{
+UNIT *uptr = rq_devmap[cp->cnum]->units + RQ_QUEUE;
+
+if (delay < 0)
+    delay = 0;
+if (sim_is_active (uptr) && ((sim_activate_time (uptr) - 1) <= delay))
+    return;
+sim_activate_abs (uptr, delay);
+}
+
 /* Data transfer error log packet */
 
 t_bool rq_dte (MSC *cp, UNIT *uptr, uint16 err)
@@ -2959,6 +3424,41 @@ fprintf (st, "%s", ctlr_tab[cp->ctype].name);
 return SCPE_OK;
 }
 
+/* Set transfer commands in flight per drive */
+
+t_stat rq_set_cmdq (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+MSC *cp = rq_ctxmap[uptr->cnum];
+DEVICE *dptr = rq_devmap[uptr->cnum];
+uint32 depth, i;
+t_stat r;
+
+if ((cptr == NULL) || (*cptr == '\0'))
+    return sim_messagef (SCPE_ARG, "Must specify CMDQUEUE=value\n");
+depth = (uint32) get_uint (cptr, 10, RQ_MAXQD, &r);
+if ((r != SCPE_OK) || (depth < 1))
+    return sim_messagef (SCPE_ARG, "Invalid Command Queue Depth: %s\n", cptr);
+for (i = 0; i < (dptr->numunits - 2); i++) {
+    RQUQ *uq = (RQUQ *) dptr->units[i].rqxf;
+
+    if (dptr->units[i].cpkt || (uq && uq->nact))
+        return sim_messagef (SCPE_NOFNC, "Can't change command queue depth on %s while %s is busy\n",
+                                         dptr->name, sim_uname (&dptr->units[i]));
+    }
+cp->qdepth = (depth > 1)? depth: 0;
+return SCPE_OK;
+}
+
+/* Show transfer commands in flight per drive */
+
+t_stat rq_show_cmdq (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+MSC *cp = rq_ctxmap[uptr->cnum];
+
+fprintf (st, "command queue depth=%d", RQ_XQ (cp)? cp->qdepth: 1);
+return SCPE_OK;
+}
+
 /* Device attach */
 
 t_stat rq_attach (UNIT *uptr, CONST char *cptr)
@@ -2973,6 +3473,8 @@ if (r != SCPE_OK)
 
 if ((cp->csta == CST_UP) && sim_disk_isavailable (uptr))
     uptr->flags = uptr->flags | UNIT_ATP;
+if (uptr->xfpk)                                         /* xfers in slots? */
+    rq_xf_restart (cp, uptr);                           /* start them over */
 return SCPE_OK;
 }
 
@@ -2980,11 +3482,26 @@ return SCPE_OK;
 
 t_stat rq_detach (UNIT *uptr)
 {
+MSC *cp = rq_ctxmap[uptr->cnum];
+RQUQ *uq = (RQUQ *) uptr->rqxf;
 t_stat r;
+uint32 i;
 
 r = sim_disk_detach (uptr);                             /* detach unit */
 if (r != SCPE_OK)
     return r;
+for (i = 0; uq && (i < RQ_MAXQD); i++) {                /* chunks in flight */
+    if (uq->xf[i].state == XF_IO)                       /* won't complete; */
+        uq->xf[i].state = XF_BOT;                       /* finish as offline */
+    else if (uq->xf[i].state == XF_ABO) {
+        uq->xf[i].state = XF_FREE;
+        uq->nact--;
+        }
+    }
+if (uq && uq->nact) {
+    rq_xf_bind (uptr);
+    rq_xf_sched (cp, 0);
+    }
 uptr->flags = uptr->flags & ~(UNIT_ONL | UNIT_ATP);     /* clr onl, atn pend */
 uptr->uf = 0;                                           /* clr unit flgs */
 return SCPE_OK;
@@ -3081,6 +3598,21 @@ for (i = 0; i < dptr->numunits; i++) {                  /* init units */
     uptr->flags = uptr->flags & ~(UNIT_ONL | UNIT_ATP);
     uptr->uf = 0;                                       /* clr unit flags */
     uptr->cpkt = uptr->pktq = 0;                        /* clr pkt q's */
+    uptr->xfpk = 0;                                     /* no xfer slots */
+    if (uptr->rqxf) {                                   /* queued xfers? */
+        RQUQ *uq = (RQUQ *) uptr->rqxf;
+
+        for (j = 0; j < RQ_MAXQD; j++) {                /* drop all, but */
+            if ((uq->xf[j].state == XF_IO) ||           /* I/O in flight */
+                (uq->xf[j].state == XF_ABO))            /* keeps its buffer */
+                uq->xf[j].state = XF_ABO;
+            else if (uq->xf[j].state != XF_FREE) {
+                uq->xf[j].state = XF_FREE;
+                uq->nact--;
+                }
+            }
+        rq_xf_bind (uptr);
+        }
     uptr->rqxb = (uint16 *) realloc (uptr->rqxb, (RQ_MAXFR >> 1) * sizeof (uint16));
     if (uptr->rqxb == NULL)
         return SCPE_MEM;
@@ -3258,8 +3790,21 @@ if ((uptr->flags & UNIT_ONL) == 0) {
     return SCPE_OK;
     }
 if (uptr->cpkt) {
-    fprintf (st, "Unit %d current ", u);
-    rq_show_pkt (st, cp, uptr->cpkt);
+    RQUQ *uq = (RQUQ *) uptr->rqxf;
+    uint32 i;
+
+    if (RQ_XQ (cp) && uq) {                             /* queued xfers? */
+        for (i = 0; i < RQ_MAXQD; i++) {
+            if ((uq->xf[i].state == XF_FREE) || (uq->xf[i].state == XF_ABO))
+                continue;
+            fprintf (st, "Unit %d active ", u);
+            rq_show_pkt (st, cp, uq->xf[i].pkt);
+            }
+        }
+    else {
+        fprintf (st, "Unit %d current ", u);
+        rq_show_pkt (st, cp, uptr->cpkt);
+        }
     if ((pkt = uptr->pktq)) {
         do {
             fprintf (st, "Unit %d queued ", u);
@@ -3341,6 +3886,12 @@ fprintf (st, "RAUSER is a \"user specified\" disk; the user can specify the size
 fprintf (st, "disk in either MB (1000000 bytes) or logical block numbers (LBN's, 512 bytes\n");
 fprintf (st, "each), or binary MB (1024*1024 bytes).  The minimum size is 5MB; the maximum\n");
 fprintf (st, "size is 2GB without extended file support, 1TB with extended file support.\n\n");
+fprintf (st, "By default each drive works on one transfer command at a time, as the\n");
+fprintf (st, "original controllers did.  SET %s CMDQUEUE=n (n from 2 to 8) lets each drive\n", dptr->name);
+fprintf (st, "have up to n transfer commands in flight; they complete out of order and\n");
+fprintf (st, "waiting transfers are started in elevator order.  This helps operating systems\n");
+fprintf (st, "that keep several requests outstanding.  CMDQUEUE=1 restores serial operation.\n");
+fprintf (st, "The depth can only be changed while the drives are idle.\n\n");
 fprintf (st, "The %s controllers support the BOOT command.\n\n", dptr->name);
 fprint_show_help (st, dptr);
 fprint_reg_help (st, dptr);
@@ -1339,6 +1339,8 @@ ctlr->offset = 0;
 ctlr->txsize = 0;
 ctlr->p_state = 0;
 ctlr->ecode = 0;
+if (ctlr->dptr == &tdc_dev)                             /* TDC registers already */
+    return SCPE_OK;                                     /* span all controllers */
 /* fixup/connect registers to actual data */
 reg = find_reg ("ECODE", NULL, ctlr->dptr);
 if (reg)
@@ -1381,6 +1381,26 @@ static void doDMA ( int32   vh,
         pa = lp->tbuf1;
         pa |= (lp->tbuf2 & TB2_M_TBUFFAD) << 16;
         status = 0;
+        /* hand over as much as the line buffer takes, the line speed
+           still paces the data as it leaves the buffer */
+        if ((lp->tmln->conn) &&
+            (((lp->lnctrl >> LNCTRL_V_MAINT) & LNCTRL_M_MAINT) == 0) &&
+            !(lp->lnctrl & LNCTRL_TX_ABORT) && tmxr_txdone_ln (lp->tmln)) {
+            uint8   buf[256];
+            size_t  i, n, stored;
+
+            do {
+                n = (lp->tbuffct < sizeof (buf)) ? lp->tbuffct : sizeof (buf);
+                if ((n == 0) || Map_ReadB (pa, (int32)n, buf))
+                    break;      /* any DMA error is found below */
+                for (i = 0; i < n; i++)
+                    buf[i] &= bitmask[(lp->lpr >> LPR_V_CHAR_LGTH) & LPR_M_CHAR_LGTH];
+                tmxr_put_buffer_ln (lp->tmln, buf, n, &stored);
+                sent += (int32)stored;
+                pa = (pa + (uint32)stored) & ((1 << 22) - 1);
+                lp->tbuffct -= (uint16)stored;
+            } while (stored == n);
+        }
         while (tmxr_txdone_ln (lp->tmln) && (lp->tbuffct > 0)) {
             uint8   buf;
             if (lp->lnctrl & LNCTRL_TX_ABORT) {
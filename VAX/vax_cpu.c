@@ -235,6 +235,8 @@
 
 
 uint32 *M = NULL;                                       /* memory */
+static char *cpu_memfile = NULL;                        /* memory file name */
+static SHMEM *cpu_memshm = NULL;                        /* memory file mapping */
 int32 R[16];                                            /* registers */
 int32 STK[5];                                           /* stack pointers */
 int32 PSL;                                              /* PSL */
@@ -281,6 +283,49 @@ FILE *hst_log;                                          /* history log file */
 int32 hst_log_p;                                        /* history last log written pointer */
 int32 step_out_nest_level = 0;                          /* step to call return - nest level */
 
+/* Predecoded instruction cache
+
+   The cache is only built with VAX_PREDECODE defined, so that the
+   instruction stream fetch of other builds is unchanged.  It is direct
+   mapped on the physical PC.  An entry holds the istream values GET_ISTR
+   returned while the instruction was decoded, so a hit replays them
+   without going through the prefetch buffer.  The opcode and specifiers
+   are still decoded from those values on every execution; only the
+   instruction fetch is saved.  Entries are stamped with the generation
+   of their physical page; a write to a page holding entries bumps the
+   generation (see DIC_WRITE). */
+
+#if defined (VAX_PREDECODE)
+#define DIC_N_ENT       14                              /* log2 entries */
+#define DIC_ENTRIES     (1u << DIC_N_ENT)
+#define DIC_M_ENT       (DIC_ENTRIES - 1)
+#define DIC_NVAL        12                              /* max istream values */
+#define DIC_INVALID     0xFFFFFFFF
+#define DIC_PAGES       (MAXMEMSIZE_X >> VA_N_OFF)
+
+typedef struct {
+    uint32              pa;                             /* physical PC */
+    uint32              gen;                            /* page generation */
+    int32               val[DIC_NVAL];                  /* istream values */
+    } DICENT;
+
+typedef struct {
+    t_uint64            hits;                           /* replayed */
+    t_uint64            misses;                         /* decoded */
+    t_uint64            inval;                          /* pages written */
+    t_uint64            flush;                          /* whole cache flushes */
+    } DICSTATS;
+
+static DICENT *cpu_dic = NULL;                          /* cache, NULL if off */
+static uint16 *cpu_dic_gen = NULL;                      /* page generations */
+uint32 *cpu_dic_map = NULL;                             /* pages with entries */
+static DICSTATS cpu_dic_stats;
+static int32 *dic_rp = NULL;                            /* replay pointer */
+static int32 *dic_wp = NULL, *dic_wend = NULL;          /* record pointers */
+static uint32 dic_pa;                                   /* phys PC of entry */
+static int32 dic_pend = 0;                              /* replay/record active */
+#endif
+
 const uint32 byte_mask[33] = { 0x00000000,
  0x00000001, 0x00000003, 0x00000007, 0x0000000F,
  0x0000001F, 0x0000003F, 0x0000007F, 0x000000FF,
@@ -314,6 +359,16 @@ t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs);
 t_stat cpu_ex (t_value *vptr, t_addr exta, UNIT *uptr, int32 sw);
 t_stat cpu_dep (t_value val, t_addr exta, UNIT *uptr, int32 sw);
 t_stat cpu_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_set_memfile (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_memfile (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+#if defined (VAX_PREDECODE)
+t_stat cpu_set_predecode (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_predecode (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+static void cpu_dic_flush (void);
+static void cpu_dic_start (void);
+static void cpu_dic_end (void);
+static int32 get_istr_dic (int32 lnt, int32 acc);
+#endif
 t_stat cpu_set_hist (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_hist (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_show_virt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
@@ -427,6 +482,16 @@ MTAB cpu_mod[] = {
     { MTAB_XTD|MTAB_VDV, 0, "IDLE", "IDLE{=VMS|ULTRIX|ULTRIX-1.X|ULTRIXOLD|NETBSD|NETBSDOLD|OPENBSD|OPENBSDOLD|QUASIJARUS|32V|ELN|MDM}{:n}", &cpu_set_idle, &cpu_show_idle, NULL, "Display idle detection mode" },
     { MTAB_XTD|MTAB_VDV, 0, NULL, "NOIDLE", &sim_clr_idle, NULL, NULL,  "Disables idle detection" },
     MEM_MODIFIERS,   /* Model specific memory modifiers from vaxXXX_defs.h */
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR|MTAB_NMO|MTAB_NC, 1, "MEMFILE", "MEMFILE=filename",
+      &cpu_set_memfile, &cpu_show_memfile, NULL, "Keep memory in a file" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOMEMFILE",
+      &cpu_set_memfile, NULL, NULL, "Keep memory in process memory" },
+#if defined (VAX_PREDECODE)
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO, 1, "PREDECODE", "PREDECODE",
+      &cpu_set_predecode, &cpu_show_predecode, NULL, "Enable predecoded instruction cache" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOPREDECODE",
+      &cpu_set_predecode, NULL, NULL, "Disable predecoded instruction cache" },
+#endif
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP|MTAB_NC, 0, "HISTORY", "HISTORY",
       &cpu_set_hist, &cpu_show_hist, NULL, "Displays instruction history" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP, 0, "VIRTUAL", NULL,
@@ -449,6 +514,17 @@ DEBTAB cpu_deb[] = {
     { NULL, 0 }
     };
 
+BRKWATCH cpu_watch_vir;                                 /* virtual write breakpoint pages */
+BRKWATCH cpu_watch_phy;                                 /* physical write breakpoint pages */
+int32 cpu_brk_wr = 0;                                   /* write breakpoint pending */
+
+BRKTYPTAB cpu_breakpoints [] = {
+    BRKTYPE('E',"Execute Instruction at Virtual Address"),
+    BRKTYPE('W',"Write to Virtual Address"),
+    BRKTYPE('X',"Write to Physical Address"),
+    { 0 }
+    };
+
 DEVICE cpu_dev = {
     "CPU", &cpu_unit, cpu_reg, cpu_mod,
     1, 16, 32, 1, 16, 8,
@@ -456,7 +532,7 @@ DEVICE cpu_dev = {
     &cpu_boot, NULL, NULL,
     NULL, DEV_DYNM | DEV_DEBUG, 0,
     cpu_deb, &cpu_set_size, NULL, &cpu_help, NULL, NULL,
-    &cpu_description
+    &cpu_description, cpu_breakpoints
     };
 
 t_stat cpu_show_model (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
@@ -510,8 +586,16 @@ set_map_reg ();                                         /* set map reg */
 GET_CUR;                                                /* set access mask */
 SET_IRQL;                                               /* eval interrupts */
 FLUSH_ISTR;                                             /* clear prefetch */
+#if defined (VAX_PREDECODE)
+if (cpu_dic != NULL)                                    /* memory may have been */
+    cpu_dic_flush ();                                   /* changed from SCP */
+#endif
 
 abortval = setjmp (save_env);                           /* set abort hdlr */
+#if defined (VAX_PREDECODE)
+dic_rp = dic_wp = NULL;                                 /* no replay/record */
+dic_pend = 0;
+#endif
 if (abortval > 0) {                                     /* sim stop? */
     PSL = PSL | cc;                                     /* put PSL together */
     pcq_r->qptr = pcq_p;                                /* update pc q ptr */
@@ -716,12 +800,18 @@ for ( ;; ) {
         }                                               /* end PSL event */
 
     if (sim_brk_summ &&
-        sim_brk_test ((uint32) PC, SWMASK ('E'))) {     /* breakpoint? */
+        (cpu_brk_wr ||                                  /* write breakpoint or */
+         sim_brk_test ((uint32) PC, SWMASK ('E')))) {   /* breakpoint? */
+        cpu_brk_wr = 0;
         ABORT (STOP_IBKPT);                             /* stop simulation */
         }
 
     sim_interval = sim_interval - (1 + (extra_bytes>>5));/* count instr */
     extra_bytes = 0;                                    /* digest string count */
+#if defined (VAX_PREDECODE)
+    if ((cpu_dic != NULL) && ((PSL & PSL_FPD) == 0))    /* predecode cache? */
+        cpu_dic_start ();
+#endif
     GET_ISTR (opc, L_BYTE);                             /* get opcode */
     if (opc == 0xFD) {                                  /* 2 byte op? */
         GET_ISTR (opc, L_BYTE);                         /* get second byte */
@@ -1552,6 +1642,11 @@ for ( ;; ) {
             }                                           /* end for */
         }                                               /* end if not FPD */
 
+#if defined (VAX_PREDECODE)
+    if (dic_pend)                                       /* predecode pending? */
+        cpu_dic_end ();
+#endif
+
 /* Optionally record instruction history */
 
     if (hst_lnt) {
@@ -3219,6 +3314,94 @@ if ((bo + lnt) >= 4) {                                  /* retire ibufl? */
 return val;
 }
 
+#if defined (VAX_PREDECODE)
+/* Predecoded instruction lookup
+
+   cpu_dic_start finds the physical PC of the next instruction, from the
+   prefetch buffer if possible, and looks it up in the predecoded
+   instruction cache.  While dic_pend is set, GET_ISTR calls get_istr_dic,
+   which replays the values of a hit or records the get_istr values of a
+   miss into the entry.  cpu_dic_end runs after the specifiers are decoded.
+   After a replay, the prefetch buffer restarts at the next instruction.
+   Only instructions contained in one physical page are entered.
+*/
+
+static void cpu_dic_start (void)
+{
+int32 t, pa;
+DICENT *e;
+
+if ((ibcnt != 0) &&                                     /* ibufl phys known? */
+    ((VA_GETOFF (ppc) == 0) || (VA_GETOFF (ppc) >= ibcnt)))
+    pa = ppc - ibcnt + (PC & 03);
+else if ((ibcnt == 0) && (ppc >= 0) && (VA_GETOFF (ppc) != 0))
+    pa = ppc + (PC & 03);
+else {                                                  /* translate */
+    pa = Test (PC & ~03, RD, &t);
+    if (pa < 0)                                         /* let get_istr fault */
+        return;
+    ibcnt = 0;                                          /* restart prefetch */
+    ppc = pa;
+    pa = pa + (PC & 03);
+    }
+if (!ADDR_IS_MEM (pa))                                  /* ROM, etc */
+    return;
+dic_pa = (uint32) pa;
+dic_pend = 1;
+e = &cpu_dic[dic_pa & DIC_M_ENT];
+if ((e->pa == dic_pa) && (e->gen == cpu_dic_gen[dic_pa >> VA_N_OFF])) {
+    dic_rp = e->val;                                    /* hit, replay */
+    cpu_dic_stats.hits++;
+    return;
+    }
+e->pa = DIC_INVALID;                                    /* miss, record */
+dic_wp = e->val;
+dic_wend = e->val + DIC_NVAL;
+cpu_dic_stats.misses++;
+}
+
+static int32 get_istr_dic (int32 lnt, int32 acc)
+{
+int32 val;
+
+if (dic_rp != NULL) {                                   /* replay? */
+    PC = PC + lnt;
+    return *dic_rp++;
+    }
+val = get_istr (lnt, acc);
+if (dic_wp != NULL) {                                   /* record? */
+    if (dic_wp < dic_wend)
+        *dic_wp++ = val;
+    else dic_wp = NULL;                                 /* too long, abandon */
+    }
+return val;
+}
+
+static void cpu_dic_end (void)
+{
+uint32 npa = dic_pa + (PC - fault_PC);                  /* next instruction */
+
+dic_pend = 0;
+if (dic_rp != NULL) {                                   /* replayed? */
+    dic_rp = NULL;
+    if ((npa >> VA_N_OFF) == (dic_pa >> VA_N_OFF)) {
+        ibcnt = 0;
+        ppc = npa & ~03;
+        }
+    else FLUSH_ISTR;
+    }
+else if (dic_wp != NULL) {                              /* recorded? */
+    dic_wp = NULL;
+    if ((VA_GETOFF (dic_pa) + (uint32) (PC - fault_PC)) <= VA_PAGSIZE) {
+        DICENT *e = &cpu_dic[dic_pa & DIC_M_ENT];
+        e->pa = dic_pa;
+        e->gen = cpu_dic_gen[dic_pa >> VA_N_OFF];
+        cpu_dic_map[dic_pa >> (VA_N_OFF + 5)] |= 1u << ((dic_pa >> VA_N_OFF) & 0x1F);
+        }
+    }
+}
+#endif
+
 /* Read octaword specifier */
 
 int32 ReadOcta (int32 va, int32 *opnd, int32 j, int32 acc)
@@ -3305,6 +3488,25 @@ static const char *vax_clock_precalibrate_commands[] = {
     "PC 100",
     NULL};
 
+/* Write breakpoint test
+
+   Called from Write only for writes touching a watched page.  The first
+   plnt bytes are at physical address pa, any others at pa1 on the next
+   page.  The write itself completes; the stop is taken before the next
+   instruction, so the instruction is never left partially executed.
+*/
+
+void cpu_brk_write (uint32 va, uint32 pa, int32 plnt, uint32 pa1, int32 lnt)
+{
+int32 i;
+
+for (i = 0; i < lnt; i++) {
+    if (sim_brk_test (va + i, BPT_WRVIR) ||
+        sim_brk_test (((i < plnt)? pa + i: pa1 + (i - plnt)) & PAMASK, BPT_WRPHY))
+        cpu_brk_wr = 1;
+    }
+}
+
 /* Reset */
 
 t_stat cpu_reset (DEVICE *dptr)
@@ -3317,9 +3519,15 @@ SISR = 0;
 ASTLVL = 4;
 mapen = 0;
 FLUSH_ISTR;                             /* init I-stream */
+cpu_brk_wr = 0;
 if (M == NULL) {                        /* first time init? */
     vax_init();
     sim_brk_types = sim_brk_dflt = SWMASK ('E');
+    sim_brk_types |= BPT_WRVIR | BPT_WRPHY;
+    sim_brk_type_desc = cpu_breakpoints;
+    if ((sim_brk_watch_init (&cpu_watch_vir, BPT_WRVIR, 32, BPT_WVIR_PGSHIFT) != SCPE_OK) ||
+        (sim_brk_watch_init (&cpu_watch_phy, BPT_WRPHY, 30, BPT_WPHY_PGSHIFT) != SCPE_OK))
+        return SCPE_MEM;
     sim_vm_is_subroutine_call = cpu_is_pc_a_subroutine_call;
     sim_clock_precalibrate_commands = vax_clock_precalibrate_commands;
     sim_vm_initial_ips = SIM_INITIAL_IPS;
@@ -3427,13 +3635,55 @@ if (ADDR_IS_ROM (addr)) {
 return SCPE_NXM;
 }
 
-/* Memory allocation */
+/* Memory allocation
+
+   Memory is either allocated from the heap or mapped from a memory file.
+   Only non-zero longwords are copied to the new memory, so pages of a
+   large, mostly empty memory aren't touched until the simulator uses them.
+*/
+
+static t_stat cpu_alloc_mem (const char *file, uint32 size)
+{
+uint32 i, clim;
+uint32 *nM = NULL;
+SHMEM *nshm = NULL;
+t_stat r;
+
+if (file != NULL) {
+    if (cpu_memshm != NULL) {                           /* move mapped memory to the heap */
+        r = cpu_alloc_mem (NULL, (uint32)MEMSIZE);      /* so the file can be mapped again */
+        if (r != SCPE_OK)
+            return r;
+        }
+    r = sim_memmap_open (file, size, &nshm, (void **)&nM);
+    if (r != SCPE_OK)
+        return r;
+    }
+else {
+    nM = (uint32 *) calloc (size >> 2, sizeof (uint32));
+    if (nM == NULL)
+        return SCPE_MEM;
+    }
+clim = (uint32)((size < MEMSIZE)? size: MEMSIZE);
+for (i = 0; i < (clim >> 2); i++) {
+    if (M[i] != 0)
+        nM[i] = M[i];
+    }
+if (cpu_memshm != NULL)
+    sim_shmem_close (cpu_memshm);
+else
+    free (M);
+M = nM;
+cpu_memshm = nshm;
+MEMSIZE = size;
+return SCPE_OK;
+}
 
 t_stat cpu_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
 int32 mc = 0;
-uint32 i, clim, uval = (uint32)val;
-uint32 *nM = NULL;
+uint32 i, uval = (uint32)val;
+t_stat r;
 
 if ((val <= 0) || (val > MAXMEMSIZE_X))
     return SCPE_ARG;
@@ -3441,19 +3691,147 @@ for (i = val; i < MEMSIZE; i = i + 4)
     mc = mc | M[i >> 2];
 if ((mc != 0) && !get_yn ("Really truncate memory [N]?", FALSE))
     return SCPE_OK;
-nM = (uint32 *) calloc (uval >> 2, sizeof (uint32));
-if (nM == NULL)
-    return SCPE_MEM;
-clim = (uint32)((uval < MEMSIZE)? uval: MEMSIZE);
-for (i = 0; i < clim; i = i + 4)
-    nM[i >> 2] = M[i >> 2];
-free (M);
-M = nM;
-MEMSIZE = uval; 
+r = cpu_alloc_mem (cpu_memfile, uval);
+if (r != SCPE_OK) {
+    if (cpu_memshm == NULL) {                           /* file mapping lost? */
+        free (cpu_memfile);
+        cpu_memfile = NULL;
+        }
+    return r;
+    }
 reset_all (0);
 return SCPE_OK;
 }
 
+/* Memory file
+
+   SET CPU MEMFILE=name keeps memory in a shared mapping of a file, so the
+   host allocates pages on demand and other programs can inspect memory
+   while the simulator runs.  The file holds memory as host order
+   longwords.  Its previous contents are replaced by the current memory.
+*/
+
+t_stat cpu_set_memfile (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+char *nfile = NULL;
+t_stat r;
+
+if (val == 0) {                                         /* NOMEMFILE? */
+    if (cptr != NULL)
+        return SCPE_ARG;
+    if (cpu_memfile == NULL)
+        return SCPE_OK;
+    r = cpu_alloc_mem (NULL, (uint32)MEMSIZE);
+    if (r == SCPE_OK) {
+        free (cpu_memfile);
+        cpu_memfile = NULL;
+        }
+    return r;
+    }
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_ARG;
+nfile = (char *) malloc (1 + strlen (cptr));
+if (nfile == NULL)
+    return SCPE_MEM;
+strcpy (nfile, cptr);
+r = cpu_alloc_mem (nfile, (uint32)MEMSIZE);
+if (r != SCPE_OK) {
+    free (nfile);
+    if (cpu_memshm == NULL) {                           /* old file mapping lost? */
+        free (cpu_memfile);
+        cpu_memfile = NULL;
+        }
+    return r;
+    }
+free (cpu_memfile);
+cpu_memfile = nfile;
+return SCPE_OK;
+}
+
+t_stat cpu_show_memfile (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+if (cpu_memfile == NULL)
+    fprintf (st, "no memory file\n");
+else
+    fprintf (st, "memory file=%s\n", cpu_memfile);
+return SCPE_OK;
+}
+
+#if defined (VAX_PREDECODE)
+/* Predecoded instruction cache
+
+   SET CPU PREDECODE allocates the cache, NOPREDECODE releases it.
+   cpu_dic_inval is called by DIC_WRITE for a write to a page with cached
+   instructions; if the page generation wraps, the whole cache is flushed
+   so that no stale entry can match again.
+*/
+
+static void cpu_dic_flush (void)
+{
+uint32 i;
+
+for (i = 0; i < DIC_ENTRIES; i++)
+    cpu_dic[i].pa = DIC_INVALID;
+memset (cpu_dic_map, 0, (DIC_PAGES + 31) / 32 * sizeof (uint32));
+cpu_dic_stats.flush++;
+}
+
+void cpu_dic_inval (uint32 pa)
+{
+uint32 pg = pa >> VA_N_OFF;
+
+cpu_dic_map[pg >> 5] &= ~(1u << (pg & 0x1F));
+cpu_dic_stats.inval++;
+if (++cpu_dic_gen[pg] == 0)                             /* generation wrap? */
+    cpu_dic_flush ();
+}
+
+t_stat cpu_set_predecode (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+if (cptr != NULL)
+    return SCPE_ARG;
+if (val == 0) {                                         /* NOPREDECODE? */
+    free (cpu_dic);
+    free (cpu_dic_gen);
+    free (cpu_dic_map);
+    cpu_dic = NULL;
+    cpu_dic_gen = NULL;
+    cpu_dic_map = NULL;
+    return SCPE_OK;
+    }
+if (cpu_dic == NULL) {
+    cpu_dic = (DICENT *) malloc (DIC_ENTRIES * sizeof (DICENT));
+    cpu_dic_gen = (uint16 *) calloc (DIC_PAGES, sizeof (uint16));
+    cpu_dic_map = (uint32 *) calloc ((DIC_PAGES + 31) / 32, sizeof (uint32));
+    if ((cpu_dic == NULL) || (cpu_dic_gen == NULL) || (cpu_dic_map == NULL)) {
+        cpu_set_predecode (uptr, 0, NULL, desc);
+        return SCPE_MEM;
+        }
+    cpu_dic_flush ();
+    }
+memset (&cpu_dic_stats, 0, sizeof (cpu_dic_stats));
+return SCPE_OK;
+}
+
+t_stat cpu_show_predecode (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+t_uint64 refs = cpu_dic_stats.hits + cpu_dic_stats.misses;
+
+if (cpu_dic == NULL) {
+    fprintf (st, "predecode disabled\n");
+    return SCPE_OK;
+    }
+fprintf (st, "predecode, %d entries\n", DIC_ENTRIES);
+fprintf (st, "  hits:              %" LL_FMT "d\n", (LL_TYPE)cpu_dic_stats.hits);
+fprintf (st, "  misses:            %" LL_FMT "d\n", (LL_TYPE)cpu_dic_stats.misses);
+if (refs != 0)
+    fprintf (st, "  hit rate:          %.2f%%\n", (100.0 * cpu_dic_stats.hits) / refs);
+fprintf (st, "  page invalidates:  %" LL_FMT "d\n", (LL_TYPE)cpu_dic_stats.inval);
+fprintf (st, "  flushes:           %" LL_FMT "d\n", (LL_TYPE)cpu_dic_stats.flush);
+return SCPE_OK;
+}
+#endif
+
 /* Virtual address translation */
 
 t_stat cpu_show_virt (FILE *of, UNIT *uptr, int32 val, CONST void *desc)
@@ -3991,6 +4369,15 @@ fprintf (st, "with each history entry.\n");
 fprintf (st, "When writing history to a file (SET CPU HISTORY=n:file), 'n' specifies\n");
 fprintf (st, "the buffer flush frequency.  Warning: prodigious amounts of disk space\n");
 fprintf (st, "may be comsumed.  The maximum length for the history is %d entries.\n\n", HIST_MAX);
+#if defined (VAX_PREDECODE)
+fprintf (st, "The CPU can keep the instruction stream of recently decoded instructions in\n");
+fprintf (st, "a cache indexed by physical address, so instructions executed again skip\n");
+fprintf (st, "the instruction prefetch.  Writes to memory holding cached instructions\n");
+fprintf (st, "discard them.  The cache is disabled by default:\n\n");
+fprintf (st, "   sim> SET CPU PREDECODE               enable the cache, clear statistics\n");
+fprintf (st, "   sim> SET CPU NOPREDECODE             disable the cache\n");
+fprintf (st, "   sim> SHOW CPU PREDECODE              display cache statistics\n\n");
+#endif
 fprintf (st, "Different VAX systems implemented different VAX architecture instructions\n");
 fprintf (st, "in hardware with other instructions possibly emulated by software in the\n");
 fprintf (st, "system.  The instructions that a particular simulator implements can be\n");
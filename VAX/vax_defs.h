@@ -262,12 +262,12 @@ extern jmp_buf save_env;
 #define VA_M_VPN        ((1u << VA_N_VPN) - 1)          /* vpn mask */
 #define VA_S0           (1u << 31)                      /* S0 space */
 #define VA_P1           (1u << 30)                      /* P1 space */
-#define VA_N_TBI        12                              /* TB index size */
-#define VA_TBSIZE       (1u << VA_N_TBI)                /* TB size */
-#define VA_M_TBI        ((1u << VA_N_TBI) - 1)          /* TB index mask */
+#define VA_N_TBI        12                              /* default TB size */
+#define VA_TBSIZE       (1u << VA_N_TBI)
+#define VA_N_TBMAX      16                              /* max TB size */
+#define VA_TBMAXSIZE    (1u << VA_N_TBMAX)
 #define VA_GETOFF(x)    ((x) & VA_M_OFF)
 #define VA_GETVPN(x)    (((x) >> VA_V_VPN) & VA_M_VPN)
-#define VA_GETTBI(x)    ((x) & VA_M_TBI)
 
 /* PTE */
 
@@ -682,7 +682,11 @@ enum opcodes {
 #define PCQ_SIZE        64                              /* must be 2**n */
 #define PCQ_MASK        (PCQ_SIZE - 1)
 #define PCQ_ENTRY       pcq[pcq_p = (pcq_p - 1) & PCQ_MASK] = fault_PC
+#if defined (VAX_PREDECODE)
+#define GET_ISTR(d,l)   d = (dic_pend? get_istr_dic (l, acc): get_istr (l, acc))
+#else
 #define GET_ISTR(d,l)   d = get_istr (l, acc)
+#endif
 #define CHECK_FOR_IDLE_LOOP if (PC == fault_PC) {                           /* to self? */ \
                                 if (PSL_GETIPL (PSL) == 0x1F)               /* int locked out? */ \
                                     ABORT (STOP_LOOP);                      /* infinite loop */ \
@@ -588,6 +588,7 @@ if (ADDR_IS_MEM (ma)) {
         val = ((val & mask) << sc) | (t & ~(mask << sc));
         }
     M[ma >> 2] = val;
+    DIC_WRITE (ma);
     }
 else {
     cq_serr (ma);                                       /* error */
@@ -646,6 +647,7 @@ if (qba_map_addr (qa, &ma)) {                           /* in map? */
             M[ma >> 2] = (M[ma >> 2] & ~(BMASK << sc)) |
                 ((dat & BMASK) << sc);
             }
+        DIC_WRITE (ma);
         }                                               /* end if mem */
     else
         mem_err = 1;
@@ -758,13 +760,76 @@ return SCPE_OK;
    Map_ReadW    -       fetch word buffer from memory
    Map_WriteB   -       store byte buffer into memory
    Map_WriteW   -       store word buffer into memory
+
+   On little-endian hosts the Qbus byte order matches the layout of M, so
+   each run of Qbus pages that maps to contiguous memory is translated once
+   and moved with memcpy.  Big-endian hosts use the longword loops.
+*/
+
+/* Map a run of Qbus addresses that is contiguous in memory
+
+   Inputs:
+        qa      =       Qbus address
+        bc      =       byte count remaining
+        *ma     =       pointer to memory address
+   Outputs:
+        lnt     =       bytes mapped, 0 if the first page is invalid or NXM
+
+   Only the first page reports errors; a later page that fails to map ends
+   the run and is retried (and reported) by the caller.
 */
 
+static int32 qba_map_run (uint32 qa, int32 bc, uint32 *ma)
+{
+int32 lnt;
+uint32 nma;
+
+if (!qba_map_addr (qa, ma))                             /* inv or NXM? */
+    return 0;
+lnt = VA_PAGSIZE - VA_GETOFF (qa);                      /* rest of page */
+while ((lnt < bc) &&                                    /* extend run */
+    qba_map_addr_c (qa + lnt, &nma) &&
+    (nma == (*ma + lnt)) && ADDR_IS_MEM (nma))
+    lnt = lnt + VA_PAGSIZE;
+return (lnt < bc)? lnt: bc;
+}
+
+static int32 qba_dma_rd (uint32 ba, int32 bc, uint8 *buf)
+{
+int32 i, lnt;
+uint32 ma;
+
+for (i = 0; i < bc; i = i + lnt) {
+    if ((lnt = qba_map_run (ba + i, bc - i, &ma)) == 0)
+        return (bc - i);
+    memcpy (buf + i, ((uint8 *) M) + ma, lnt);
+    }
+return 0;
+}
+
+static int32 qba_dma_wr (uint32 ba, int32 bc, const uint8 *buf)
+{
+int32 i, lnt;
+uint32 ma, pa;
+
+for (i = 0; i < bc; i = i + lnt) {
+    if ((lnt = qba_map_run (ba + i, bc - i, &ma)) == 0)
+        return (bc - i);
+    memcpy (((uint8 *) M) + ma, buf + i, lnt);
+    for (pa = ma & ~VA_M_OFF; pa < (ma + lnt); pa = pa + VA_PAGSIZE) {
+        DIC_WRITE (pa);                                 /* flush predecode */
+        }
+    }
+return 0;
+}
+
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
 {
 int32 i;
 uint32 ma, dat;
 
+if (sim_end)                                            /* little endian? */
+    return qba_dma_rd (ba, bc, buf);
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i++, buf++) {              /* by bytes */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -799,6 +864,8 @@ uint32 ma,dat;
 
 ba = ba & ~01;
 bc = bc & ~01;
+if (sim_end)                                            /* little endian? */
+    return qba_dma_rd (ba, bc, (uint8 *) buf);
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i = i + 2, buf++) {        /* by words */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -829,6 +896,8 @@ int32 Map_WriteB (uint32 ba, int32 bc, const uint8 *buf)
 int32 i;
 uint32 ma, dat;
 
+if (sim_end)                                            /* little endian? */
+    return qba_dma_wr (ba, bc, buf);
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i++, buf++) {              /* by bytes */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -863,6 +932,8 @@ uint32 ma, dat;
 
 ba = ba & ~01;
 bc = bc & ~01;
+if (sim_end)                                            /* little endian? */
+    return qba_dma_wr (ba, bc, (const uint8 *) buf);
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i = i + 2, buf++) {        /* by words */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -47,6 +47,10 @@
         zap_tb_ent      -       clear TB entry
         chk_tb_ent      -       check TB entry
         set_map_reg     -       set up working map registers
+
+   The TBs are set associative; see vax_mmu.h.  The number of entries
+   and the associativity are set with SET TLB SIZE and SET TLB WAYS,
+   and SHOW TLB STATISTICS shows how well the TBs are working.
 */
 
 #include "vax_defs.h"
@@ -56,7 +60,12 @@
 int32 d_p0br, d_p0lr;                                   /* dynamic copies */
 int32 d_p1br, d_p1lr;                                   /* altered per ucode */
 int32 d_sbr, d_slr;
-TLBENT stlb[VA_TBSIZE], ptlb[VA_TBSIZE];
+TLBENT stlb[VA_TBMAXSIZE], ptlb[VA_TBMAXSIZE];
+uint32 tlb_set_mask = (VA_TBSIZE >> 1) - 1;             /* sets - 1 */
+int32 tlb_ways_shift = 1;                               /* log2 (ways) */
+int32 stlb_gen = 0;                                     /* system TB generation */
+int32 ptlb_gen = 0;                                     /* process TB generation */
+TLBSTATS tlb_stats;
 static const int32 cvtacc[16] = { 0, 0,
     TLB_ACCW (KERN)+TLB_ACCR (KERN),
     TLB_ACCR (KERN),
@@ -83,6 +92,13 @@ static const int32 cvtacc[16] = { 0, 0,
 t_stat tlb_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw);
 t_stat tlb_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw);
 t_stat tlb_reset (DEVICE *dptr);
+t_stat tlb_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat tlb_show_size (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat tlb_set_ways (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat tlb_show_ways (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat tlb_set_stats (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat tlb_show_stats (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat tlb_msize (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 const char *tlb_description (DEVICE *dptr);
 
 TLBENT fill (uint32 va, int32 lnt, int32 acc, int32 *stat);
@@ -98,6 +114,7 @@ void WriteU (uint32 pa, int32 val, int32 lnt);
    tlb_dev      pager device descriptor
    tlb_unit     pager units
    pager_reg    pager register list
+   tlb_mod      pager modifier list
 */
 
 UNIT tlb_unit[] = {
@@ -106,17 +123,61 @@ UNIT tlb_unit[] = {
     };
 
 REG tlb_reg[] = {
+    { HRDATAD (SGEN, stlb_gen, 32, "system TB generation"), REG_HRO },
+    { HRDATAD (PGEN, ptlb_gen, 32, "process TB generation"), REG_HRO },
     { NULL }
     };
 
+MTAB tlb_mod[] = {
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "SIZE", "SIZE=entries",
+      &tlb_set_size, &tlb_show_size, NULL, "Set the number of entries in each TB" },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "WAYS", "WAYS={1|2|4}",
+      &tlb_set_ways, &tlb_show_ways, NULL, "Set the TB associativity" },
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "STATISTICS", "STATISTICS",
+      &tlb_set_stats, &tlb_show_stats, NULL, "Display or reset TB statistics" },
+    { 0 }
+    };
+
 DEVICE tlb_dev = {
-    "TLB", tlb_unit, tlb_reg, NULL,
-    2, 16, VA_N_TBI * 2, 1, 16, 32,
+    "TLB", tlb_unit, tlb_reg, tlb_mod,
+    2, 16, VA_N_TBMAX + 1, 1, 16, 32,
     &tlb_ex, &tlb_dep, &tlb_reset,
-    NULL, NULL, NULL, NULL, 0, 0, NULL, NULL, NULL, NULL, NULL, NULL, 
+    NULL, NULL, NULL, NULL, DEV_DYNM, 0, NULL, &tlb_msize, NULL, NULL, NULL, NULL, 
     &tlb_description
     };
 
+/* Find a TB entry in a set, starting at way first; NULL if not present */
+
+static TLBENT *tlb_find (TLBENT *set, int32 first, int32 tag)
+{
+int32 w;
+
+for (w = first; w < (1 << tlb_ways_shift); w++) {
+    if (set[w].tag == tag)
+        return &set[w];
+    }
+return NULL;
+}
+
+/* Make an entry the most recently used one of its set.  An existing entry
+   for the same tag is replaced, otherwise the least recently used entry
+   is dropped. */
+
+static TLBENT tlb_insert (TLBENT *set, int32 tag, int32 pte)
+{
+int32 w;
+
+for (w = 0; w < (1 << tlb_ways_shift) - 1; w++) {
+    if (set[w].tag == tag)
+        break;
+    }
+for ( ; w > 0; w--)
+    set[w] = set[w - 1];
+set[0].tag = tag;
+set[0].pte = pte;
+return set[0];
+}
+
 
 /* TLB fill
 
@@ -141,9 +202,20 @@ DEVICE tlb_dev = {
 TLBENT fill (uint32 va, int32 lnt, int32 acc, int32 *stat)
 {
 int32 ptidx = (((uint32) va) >> 7) & ~03;
-int32 tlbpte, ptead, pte, tbi, vpn;
+int32 tlbpte, ptead, pte, vpn, tag;
+TLBENT *set, *xpte;
 static TLBENT zero_pte = { 0, 0 };
 
+vpn = VA_GETVPN (va);
+tag = TLB_TAG (va, vpn);
+set = ((va & VA_S0)? stlb: ptlb) + TLB_GETSET (vpn);
+xpte = tlb_find (set, 1, tag);                          /* in another way? */
+if ((xpte != NULL) && (xpte->pte & acc) &&
+    ((stat != NULL) || ((acc & TLB_WACC) == 0) || (xpte->pte & TLB_M))) {
+    tlb_stats.way_hits++;
+    return tlb_insert (set, tag, xpte->pte);            /* make it the first */
+    }
+tlb_stats.misses++;
 if (va & VA_S0) {                                       /* system space? */
     if (ptidx >= d_slr)                                 /* system */
         MM_ERR (PR_LNV);
@@ -163,9 +235,11 @@ else {
 #if !defined (VAX_620)
     if ((ptead & VA_S0) == 0)
         ABORT (STOP_PPTE);                              /* ppte must be sys */
-    vpn = VA_GETVPN (ptead);                            /* get vpn, tbi */
-    tbi = VA_GETTBI (vpn);
-    if (stlb[tbi].tag != vpn) {                         /* in sys tlb? */
+    vpn = VA_GETVPN (ptead);                            /* get vpn, set */
+    xpte = tlb_find (stlb + TLB_GETSET (vpn), 0, vpn | stlb_gen);
+    if (xpte != NULL)                                   /* in sys tlb? */
+        ptead = (xpte->pte & TLB_PFN) | VA_GETOFF (ptead);
+    else {
         ptidx = ((uint32) ptead) >> 7;                  /* xlate like sys */
         if (ptidx >= d_slr)
             MM_ERR (PR_PLNV);
@@ -176,11 +250,11 @@ else {
 #endif
         if ((pte & PTE_V) == 0)                         /* spte TNV? */
             MM_ERR (PR_PTNV);
-        stlb[tbi].tag = vpn;                            /* set stlb tag */
-        stlb[tbi].pte = cvtacc[PTE_GETACC (pte)] |
-            ((pte << VA_N_OFF) & TLB_PFN);              /* set stlb data */
+        tlbpte = tlb_insert (stlb + TLB_GETSET (vpn), vpn | stlb_gen,
+            cvtacc[PTE_GETACC (pte)] |
+            ((pte << VA_N_OFF) & TLB_PFN)).pte;         /* set stlb ent */
+        ptead = (tlbpte & TLB_PFN) | VA_GETOFF (ptead);
         }
-    ptead = (stlb[tbi].pte & TLB_PFN) | VA_GETOFF (ptead);
 #endif
     }
 pte = ReadL (ptead);                                    /* read pte */
@@ -195,16 +269,7 @@ if (acc & TLB_WACC) {                                   /* write? */
         WriteL (ptead, pte | PTE_M);
     tlbpte = tlbpte | TLB_M;                            /* set M */
     }
-vpn = VA_GETVPN (va);
-tbi = VA_GETTBI (vpn);
-if ((va & VA_S0) == 0) {                                /* process space? */
-    ptlb[tbi].tag = vpn;                                /* store tlb ent */
-    ptlb[tbi].pte = tlbpte;
-    return ptlb[tbi];
-    }
-stlb[tbi].tag = vpn;                                    /* system space */
-stlb[tbi].pte = tlbpte;                                 /* store tlb ent */
-return stlb[tbi];
+return tlb_insert (set, tag, tlbpte);                   /* store tlb ent */
 }
 
 /* Utility routines */
@@ -219,28 +284,48 @@ d_p1lr = (P1LR << 2) + 0x800000;                        /* VA<30> >> 7 */
 d_slr = (SLR << 2) + 0x1000000;                         /* VA<31> >> 7 */
 }
 
-/* Zap process (0) or whole (1) tb */
+/* Clear all entries of a TB */
 
-void zap_tb (int stb)
+static void tlb_clear (TLBENT *tlb)
 {
 size_t i;
 
-for (i = 0; i < VA_TBSIZE; i++) {
-    ptlb[i].tag = ptlb[i].pte = -1;
-    if (stb)
-        stlb[i].tag = stlb[i].pte = -1;
+for (i = 0; i < VA_TBMAXSIZE; i++)
+    tlb[i].tag = tlb[i].pte = -1;
+}
+
+/* Zap process (0) or whole (1) tb
+
+   Advancing the generation invalidates every entry at once.  When the
+   generation wraps, the entries with a matching generation have to be
+   cleared for real. */
+
+void zap_tb (int stb)
+{
+ptlb_gen = (ptlb_gen + TLB_GEN_INC) & TLB_M_GEN;
+if (ptlb_gen == 0)
+    tlb_clear (ptlb);
+if (stb) {
+    stlb_gen = (stlb_gen + TLB_GEN_INC) & TLB_M_GEN;
+    if (stlb_gen == 0)
+        tlb_clear (stlb);
+    tlb_stats.flush_all++;
     }
+else
+    tlb_stats.flush_proc++;
 }
 
 /* Zap single tb entry corresponding to va */
 
 void zap_tb_ent (uint32 va)
 {
-int32 tbi = VA_GETTBI (VA_GETVPN (va));
+int32 vpn = VA_GETVPN (va);
+TLBENT *xpte;
 
-if (va & VA_S0)
-    stlb[tbi].tag = stlb[tbi].pte = -1;
-else ptlb[tbi].tag = ptlb[tbi].pte = -1;
+xpte = tlb_find (((va & VA_S0)? stlb: ptlb) + TLB_GETSET (vpn), 0, TLB_TAG (va, vpn));
+if (xpte != NULL)
+    xpte->tag = xpte->pte = -1;
+tlb_stats.flush_ent++;
 }
 
 /* Check for tlb entry corresponding to va */
@@ -248,13 +333,8 @@ else ptlb[tbi].tag = ptlb[tbi].pte = -1;
 t_bool chk_tb_ent (uint32 va)
 {
 int32 vpn = VA_GETVPN (va);
-int32 tbi = VA_GETTBI (vpn);
-TLBENT xpte;
 
-xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];
-if (xpte.tag == vpn)
-    return TRUE;
-return FALSE;
+return (tlb_find (((va & VA_S0)? stlb: ptlb) + TLB_GETSET (vpn), 0, TLB_TAG (va, vpn)) != NULL);
 }
 
 /* TLB examine */
@@ -264,7 +344,7 @@ t_stat tlb_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw)
 int32 tlbn = uptr - tlb_unit;
 uint32 idx = (uint32) addr >> 1;
 
-if (idx >= VA_TBSIZE)
+if (idx >= (uint32) (uptr->capac >> 1))
     return SCPE_NXM;
 if (addr & 1)
     *vptr = ((uint32) (tlbn? stlb[idx].pte: ptlb[idx].pte));
@@ -279,7 +359,7 @@ t_stat tlb_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw)
 int32 tlbn = uptr - tlb_unit;
 uint32 idx = (uint32) addr >> 1;
 
-if (idx >= VA_TBSIZE)
+if (idx >= (uint32) (uptr->capac >> 1))
     return SCPE_NXM;
 if (addr & 1) {
     if (tlbn) stlb[idx].pte = (int32) val;
@@ -296,10 +376,101 @@ return SCPE_OK;
 
 t_stat tlb_reset (DEVICE *dptr)
 {
-size_t i;
+tlb_clear (stlb);
+tlb_clear (ptlb);
+stlb_gen = ptlb_gen = 0;
+return SCPE_OK;
+}
 
-for (i = 0; i < VA_TBSIZE; i++)
-    stlb[i].tag = ptlb[i].tag = stlb[i].pte = ptlb[i].pte = -1;
+/* Change the TB organization; both TBs are emptied */
+
+static t_stat tlb_config (uint32 entries, int32 ways_shift)
+{
+uint32 i;
+
+if ((entries < 16) || (entries > VA_TBMAXSIZE) ||
+    ((entries & (entries - 1)) != 0))                   /* power of 2? */
+    return SCPE_ARG;
+tlb_ways_shift = ways_shift;
+tlb_set_mask = (entries >> ways_shift) - 1;
+for (i = 0; i < 2; i++)
+    tlb_unit[i].capac = entries * 2;
+return tlb_reset (&tlb_dev);
+}
+
+t_stat tlb_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+t_stat r;
+uint32 entries;
+
+if (cptr == NULL)
+    return SCPE_ARG;
+entries = (uint32) get_uint (cptr, 10, VA_TBMAXSIZE, &r);
+if (r != SCPE_OK)
+    return r;
+return tlb_config (entries, tlb_ways_shift);
+}
+
+t_stat tlb_show_size (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+fprintf (st, "%d entries", (int)((tlb_set_mask + 1) << tlb_ways_shift));
+return SCPE_OK;
+}
+
+/* Called by RESTORE to match the saved TB size */
+
+t_stat tlb_msize (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+return tlb_config ((uint32) val / 2, tlb_ways_shift);
+}
+
+t_stat tlb_set_ways (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+t_stat r;
+uint32 ways;
+
+if (cptr == NULL)
+    return SCPE_ARG;
+ways = (uint32) get_uint (cptr, 10, 4, &r);
+if ((r != SCPE_OK) || (ways == 3) || (ways == 0))
+    return SCPE_ARG;
+return tlb_config ((tlb_set_mask + 1) << tlb_ways_shift, ways >> 1);
+}
+
+t_stat tlb_show_ways (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+fprintf (st, "%d-way", 1 << tlb_ways_shift);
+return SCPE_OK;
+}
+
+t_stat tlb_set_stats (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+if (cptr != NULL)
+    return SCPE_ARG;
+memset (&tlb_stats, 0, sizeof (tlb_stats));
+return SCPE_OK;
+}
+
+t_stat tlb_show_stats (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+#if defined (VAX_TLB_STATS)
+t_uint64 hits = tlb_stats.refs - tlb_stats.misses;
+#endif
+
+fprintf (st, "TB statistics (%d entries, %d-way):\n", (int)((tlb_set_mask + 1) << tlb_ways_shift), 1 << tlb_ways_shift);
+#if defined (VAX_TLB_STATS)
+fprintf (st, "  Lookups:               %" LL_FMT "d\n", (LL_TYPE) tlb_stats.refs);
+fprintf (st, "  Hits:                  %" LL_FMT "d", (LL_TYPE) hits);
+if (tlb_stats.refs != 0)
+    fprintf (st, " (%.2f%%)", (100.0 * (double) hits) / (double) tlb_stats.refs);
+fprintf (st, "\n");
+#endif
+fprintf (st, "  First way misses:      %" LL_FMT "d\n", (LL_TYPE) (tlb_stats.way_hits + tlb_stats.misses));
+fprintf (st, "  Hits past first way:   %" LL_FMT "d\n", (LL_TYPE) tlb_stats.way_hits);
+fprintf (st, "  Misses:                %" LL_FMT "d\n", (LL_TYPE) tlb_stats.misses);
+fprintf (st, "  Full flushes:          %" LL_FMT "d\n", (LL_TYPE) tlb_stats.flush_all);
+fprintf (st, "  Process flushes:       %" LL_FMT "d\n", (LL_TYPE) tlb_stats.flush_proc);
+fprintf (st, "  Single entry flushes:  %" LL_FMT "d\n", (LL_TYPE) tlb_stats.flush_ent);
 return SCPE_OK;
 }
 
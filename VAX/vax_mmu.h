@@ -56,13 +56,57 @@ typedef struct {
     int32       pte;                                    /* pte */
     } TLBENT;
 
+/* Translation buffer organization
+
+   The system and process TBs are set associative, with tlb_ways
+   (1, 2 or 4) entries per set.  Within a set, entries are kept in most
+   recently used order, so the inline lookups only probe the first
+   entry; fill searches the rest of the set before walking the page
+   tables.
+
+   An entry's tag is its VPN plus the generation of its TB.  A full
+   flush of a TB just advances the generation, so all its entries stop
+   matching.  The entries are only cleared when the generation wraps.
+   Invalid entries have tag = pte = -1 and never match.
+
+   The statistics are gathered by fill, off the inline paths.  Counting
+   every lookup costs the inline paths an increment, so it is only done
+   in builds with VAX_TLB_STATS defined.
+*/
+
+#define TLB_V_GEN       VA_N_VPN                        /* generation in tag */
+#define TLB_M_GEN       (0x1FFu << TLB_V_GEN)           /* keeps tag >= 0 */
+#define TLB_GEN_INC     (1u << TLB_V_GEN)
+#define TLB_GETSET(vpn) (((vpn) & tlb_set_mask) << tlb_ways_shift)
+#define TLB_TAG(va,vpn) ((vpn) | (((va) & VA_S0)? stlb_gen: ptlb_gen))
+
+typedef struct {
+    t_uint64    refs;                                   /* lookups (VAX_TLB_STATS only) */
+    t_uint64    way_hits;                               /* hits past 1st way */
+    t_uint64    misses;                                 /* page table walks */
+    t_uint64    flush_all;                              /* full flushes */
+    t_uint64    flush_proc;                             /* process flushes */
+    t_uint64    flush_ent;                              /* single entry flushes */
+    } TLBSTATS;
+
+extern uint32 tlb_set_mask;                             /* sets - 1 */
+extern int32 tlb_ways_shift;                            /* log2 (ways) */
+extern int32 stlb_gen, ptlb_gen;                        /* TB generations */
+extern TLBSTATS tlb_stats;
+
+#if defined (VAX_TLB_STATS)
+#define TLB_COUNT_REF   tlb_stats.refs++
+#else
+#define TLB_COUNT_REF
+#endif
+
 extern uint32 *M;
 extern UNIT cpu_unit;
 extern DEVICE cpu_dev;
 extern int32 mapen;                                     /* map enable */
 
 extern int32 mchk_va, mchk_ref;                         /* for mcheck */
-extern TLBENT stlb[VA_TBSIZE], ptlb[VA_TBSIZE];
+extern TLBENT stlb[VA_TBMAXSIZE], ptlb[VA_TBMAXSIZE];
 
 static const int32 insert[4] = {
     0x00000000, 0x000000FF, 0x0000FFFF, 0x00FFFFFF
@@ -87,6 +131,47 @@ static SIM_INLINE void WriteB (uint32 pa, int32 val);
 static SIM_INLINE void WriteW (uint32 pa, int32 val);
 static SIM_INLINE void WriteL (uint32 pa, int32 val);
 
+/* Write breakpoints
+
+   Virtual (W) and physical (X) write breakpoints are tracked in page
+   watch maps, so writes to pages without a breakpoint only pay for the
+   bit tests.  cpu_brk_write does the full test and requests a stop at
+   the end of the current instruction.  A write which crosses a page
+   puts its first plnt bytes at pa and the rest at pa1, the physical
+   address of the next page. */
+
+#define BPT_WRVIR       SWMASK ('W')
+#define BPT_WRPHY       SWMASK ('X')
+#define BPT_WVIR_PGSHIFT 16                             /* 64KB virtual watch pages */
+#define BPT_WPHY_PGSHIFT 12                             /* 4KB physical watch pages */
+#define BPT_WATCHED_WR(va,pa,plnt,pa1,lnt) \
+    (SIM_BRK_WATCHED (&cpu_watch_vir, va) || SIM_BRK_WATCHED (&cpu_watch_vir, (va) + (lnt) - 1) || \
+     SIM_BRK_WATCHED (&cpu_watch_phy, pa) || SIM_BRK_WATCHED (&cpu_watch_phy, (pa) + (plnt) - 1) || \
+     (((plnt) < (lnt)) && SIM_BRK_WATCHED (&cpu_watch_phy, pa1)))
+
+extern BRKWATCH cpu_watch_vir, cpu_watch_phy;
+extern void cpu_brk_write (uint32 va, uint32 pa, int32 plnt, uint32 pa1, int32 lnt);
+
+/* Predecoded instruction cache (VAX_PREDECODE builds only)
+
+   Physical pages holding cached instructions are marked in cpu_dic_map
+   (NULL when the cache is off).  A memory write to a marked page discards
+   the cached instructions of that page.  Writes never cross a longword,
+   so one test covers all bytes written. */
+
+#if defined (VAX_PREDECODE)
+#define DIC_WRITE(pa)   do {                                                    \
+                            if ((cpu_dic_map != NULL) &&                        \
+                                (cpu_dic_map[(pa) >> (VA_N_OFF + 5)] & (1u << (((pa) >> VA_N_OFF) & 0x1F)))) \
+                                cpu_dic_inval (pa);                             \
+                            } while (0)
+
+extern uint32 *cpu_dic_map;
+extern void cpu_dic_inval (uint32 pa);
+#else
+#define DIC_WRITE(pa)   do {} while (0)
+#endif
+
 /* Read and write virtual
 
    These routines logically fall into three phases:
@@ -126,9 +211,10 @@ mchk_va = va;
 if (mapen) {                                            /* mapping on? */
     vpn = VA_GETVPN (va);                               /* get vpn, offset */
     off = VA_GETOFF (va);
-    tbi = VA_GETTBI (vpn);
+    tbi = TLB_GETSET (vpn);
     xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
-    if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
+    TLB_COUNT_REF;
+    if (((xpte.pte & acc) == 0) || (xpte.tag != TLB_TAG (va, vpn)) ||
         ((acc & TLB_WACC) && ((xpte.pte & TLB_M) == 0)))
         xpte = fill (va, lnt, acc, NULL);               /* fill if needed */
     pa = (xpte.pte & TLB_PFN) | off;                    /* get phys addr */
@@ -146,9 +232,10 @@ if ((pa & (lnt - 1)) == 0) {                            /* aligned? */
     }
 if (mapen && ((uint32)(off + lnt) > VA_PAGSIZE)) {      /* cross page? */
     vpn = VA_GETVPN (va + lnt);                         /* vpn 2nd page */
-    tbi = VA_GETTBI (vpn);
+    tbi = TLB_GETSET (vpn);
     xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
-    if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
+    TLB_COUNT_REF;
+    if (((xpte.pte & acc) == 0) || (xpte.tag != TLB_TAG (va, vpn)) ||
         ((acc & TLB_WACC) && ((xpte.pte & TLB_M) == 0)))
         xpte = fill (va + lnt, lnt, acc, NULL);         /* fill if needed */
     pa1 = ((xpte.pte & TLB_PFN) | VA_GETOFF (va + 4)) & ~03;
@@ -185,16 +272,17 @@ else {
 static SIM_INLINE void Write (uint32 va, int32 val, int32 lnt, int32 acc)
 {
 int32 vpn, off, tbi, pa;
-int32 pa1, bo, sc;
+int32 pa1, plnt, bo, sc;
 TLBENT xpte;
 
 mchk_va = va;
 if (mapen) {
     vpn = VA_GETVPN (va);
     off = VA_GETOFF (va);
-    tbi = VA_GETTBI (vpn);
+    tbi = TLB_GETSET (vpn);
     xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
-    if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
+    TLB_COUNT_REF;
+    if (((xpte.pte & acc) == 0) || (xpte.tag != TLB_TAG (va, vpn)) ||
         ((xpte.pte & TLB_M) == 0))
         xpte = fill (va, lnt, acc, NULL);
     pa = (xpte.pte & TLB_PFN) | off;
@@ -204,6 +292,9 @@ else {
     off = 0;
     }
 if ((pa & (lnt - 1)) == 0) {                            /* aligned? */
+    if ((sim_brk_summ & (BPT_WRVIR | BPT_WRPHY)) &&     /* write breakpoints */
+        BPT_WATCHED_WR (va, pa, lnt, pa, lnt))          /* on this page? */
+        cpu_brk_write (va, pa, lnt, pa, lnt);
     if (lnt >= L_LONG)                                  /* long, quad? */
         WriteL (pa, val);
     else {
@@ -216,15 +307,22 @@ if ((pa & (lnt - 1)) == 0) {                            /* aligned? */
     }
 if (mapen && ((uint32)(off + lnt) > VA_PAGSIZE)) {
     vpn = VA_GETVPN (va + 4);
-    tbi = VA_GETTBI (vpn);
+    tbi = TLB_GETSET (vpn);
     xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
-    if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
+    TLB_COUNT_REF;
+    if (((xpte.pte & acc) == 0) || (xpte.tag != TLB_TAG (va, vpn)) ||
         ((xpte.pte & TLB_M) == 0))
         xpte = fill (va + lnt, lnt, acc, NULL);
     pa1 = ((xpte.pte & TLB_PFN) | VA_GETOFF (va + 4)) & ~03;
+    plnt = VA_PAGSIZE - off;                            /* bytes on 1st page */
     }
-else
+else {
     pa1 = ((pa + 4) & PAMASK) & ~03;
+    plnt = lnt;
+    }
+if ((sim_brk_summ & (BPT_WRVIR | BPT_WRPHY)) &&         /* write breakpoints */
+    BPT_WATCHED_WR (va, pa, plnt, pa1, lnt))            /* on these pages? */
+    cpu_brk_write (va, pa, plnt, pa1, lnt);
 bo = pa & 3;
 if (lnt >= L_LONG) {
     sc = bo << 3;
@@ -251,9 +349,11 @@ TLBENT xpte;
 if (mapen) {                                            /* mapping on? */
     vpn = VA_GETVPN (va);                               /* get vpn, off */
     off = VA_GETOFF (va);
-    tbi = VA_GETTBI (vpn);
+    tbi = TLB_GETSET (vpn);
     xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
-    if ((xpte.pte & acc) && (xpte.tag == vpn))          /* TB hit, acc ok? */ 
+    TLB_COUNT_REF;
+    if ((xpte.pte & acc) &&                             /* TB hit, acc ok? */
+        (xpte.tag == TLB_TAG (va, vpn)))
         return (xpte.pte & TLB_PFN) | off;
     xpte = fill (va, L_BYTE, acc, status);              /* fill TB */
     if (*status == PR_OK)
@@ -366,6 +466,7 @@ if (ADDR_IS_MEM (pa)) {
     int32 sc = (pa & 3) << 3;
     int32 mask = 0xFF << sc;
     M[id] = (M[id] & ~mask) | (val << sc);
+    DIC_WRITE (pa);
     }
 else {
     mchk_ref = REF_V;
@@ -383,6 +484,7 @@ if (ADDR_IS_MEM (pa)) {
     int32 id = pa >> 2;
     M[id] = (pa & 2)? (M[id] & 0xFFFF) | (val << 16):
         (M[id] & ~0xFFFF) | val;
+    DIC_WRITE (pa);
     }
 else {
     mchk_ref = REF_V;
@@ -396,8 +498,10 @@ return;
 
 static SIM_INLINE void WriteL (uint32 pa, int32 val)
 {
-if (ADDR_IS_MEM (pa))
+if (ADDR_IS_MEM (pa)) {
     M[pa >> 2] = val;
+    DIC_WRITE (pa);
+    }
 else {
     mchk_ref = REF_V;
     if (ADDR_IS_IO (pa))
@@ -410,8 +514,10 @@ return;
 
 static SIM_INLINE void WriteLP (uint32 pa, int32 val)
 {
-if (ADDR_IS_MEM (pa))
+if (ADDR_IS_MEM (pa)) {
     M[pa >> 2] = val;
+    DIC_WRITE (pa);
+    }
 else {
     mchk_va = pa;
     mchk_ref = REF_P;
@@ -439,6 +545,7 @@ if (ADDR_IS_MEM (pa)) {
     int32 bo = pa & 3;
     int32 sc = bo << 3;
     M[pa >> 2] = (M[pa >> 2] & ~(insert[lnt] << sc)) | ((val & insert[lnt]) << sc);
+    DIC_WRITE (pa);
     }
 else {
     mchk_ref = REF_V;
@@ -237,6 +237,12 @@
 #include <fcntl.h>
 #endif
 #include <setjmp.h>
+#if !defined(_WIN32) && !defined(VMS)                   /* fork() based background SAVE */
+#define SIM_SAVE_BACKGROUND 1
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
 
 #if defined(HAVE_DLOPEN)                                /* Dynamic Readline support */
 #include <dlfcn.h>
@@ -267,20 +273,12 @@
 #define SRBSIZ          1024                            /* save/restore buffer */
 #define SIM_BRK_INILNT  4096                            /* bpt tbl length */
 #define SIM_BRK_ALLTYP  0xFFFFFFFB
+#define SIM_EVQ_INILNT  64                              /* event heap initial length */
 #define UPDATE_SIM_TIME                                         \
     if (1) {                                                    \
-        int32 _x;                                               \
         AIO_LOCK;                                               \
-        if (sim_clock_queue == QUEUE_LIST_END)                  \
-            _x = noqueue_time;                                  \
-        else                                                    \
-            _x = sim_clock_queue->time;                         \
-        sim_time = sim_time + (_x - sim_interval);              \
-        sim_rtime = sim_rtime + ((uint32) (_x - sim_interval)); \
-        if (sim_clock_queue == QUEUE_LIST_END)                  \
-            noqueue_time = sim_interval;                        \
-        else                                                    \
-            sim_clock_queue->time = sim_interval;               \
+        sim_time = sim_time + (sim_interval_base - sim_interval);\
+        sim_interval_base = sim_interval;                       \
         AIO_UNLOCK;                                             \
         }                                                       \
     else                                                        \
@@ -490,6 +488,7 @@ t_stat show_all_mods (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flg, int32 *toks
 t_stat show_one_mod (FILE *st, DEVICE *dptr, UNIT *uptr, MTAB *mptr, CONST char *cptr, int32 flag);
 t_stat sim_save (FILE *sfile);
 t_stat sim_rest (FILE *rfile);
+static t_stat sim_save_bg_wait (void);
 
 /* Breakpoint package */
 
@@ -502,6 +501,7 @@ t_stat sim_brk_showall (FILE *st, int32 sw);
 CONST char *sim_brk_getact (char *buf, int32 size);
 BRKTAB *sim_brk_new (t_addr loc, uint32 btyp);
 char *sim_brk_clract (void);
+static void sim_brk_watch_update (void);
 
 FILE *stdnul;
 
@@ -566,6 +566,7 @@ t_stat sim_set_asynch (int32 flag, CONST char *cptr);
 static const char *_get_dbg_verb (uint32 dbits, DEVICE* dptr, UNIT *uptr);
 static t_stat sim_sanity_check_register_declarations (void);
 static t_stat _sim_debug_flush (void);
+static int _sim_evq_compare (const void *pa, const void *pb);
 
 /* Global data */
 
@@ -601,6 +602,13 @@ BRKTAB **sim_brk_tab = NULL;
 int32 sim_brk_ent = 0;
 int32 sim_brk_lnt = 0;
 int32 sim_brk_ins = 0;
+/* Breakpoint address filter: one bit per hashed address.  A clear bit means
+   no breakpoint can exist at any address hashing there, which lets the
+   per-instruction sim_brk_test call return after a single load and test. */
+#define SIM_BRK_MAP_BITS    (1u << 16)
+#define SIM_BRK_MAP_IDX(loc) ((uint32)((loc) ^ ((loc) >> 16)) & (SIM_BRK_MAP_BITS - 1))
+static uint32 sim_brk_map[SIM_BRK_MAP_BITS / 32];
+static BRKWATCH *sim_brk_watch_list = NULL;             /* registered page watch maps */
 int32 sim_quiet = 0;
 int32 sim_show_message = 1;                         /* the message display status of the currently open do file */
 int32 sim_step = 0;
@@ -614,9 +622,17 @@ char *sim_sub_instr = NULL;         /* Copy of pre-substitution buffer contents
 char *sim_sub_instr_buf = NULL;     /* Buffer address that substitutions were saved in */
 size_t sim_sub_instr_size = 0;      /* substitution buffer size */
 size_t *sim_sub_instr_off = NULL;   /* offsets in substitution buffer where original data started */
-static double sim_time;
-static uint32 sim_rtime;
-static int32 noqueue_time;
+static t_int64 sim_time;                                /* global time (instructions) */
+static int32 sim_interval_base;                         /* sim_interval when last loaded */
+typedef struct SIM_EVENT {
+    t_int64             due;                            /* absolute due time */
+    t_uint64            seq;                            /* activation sequence */
+    UNIT                *uptr;                          /* unit */
+    } SIM_EVENT;
+static SIM_EVENT *sim_evq = NULL;                       /* event heap */
+static int32 sim_evq_count = 0;                         /* event heap entries */
+static int32 sim_evq_size = 0;                          /* event heap allocated length */
+static t_uint64 sim_evq_seq = 0;                        /* activation sequence number */
 volatile t_bool stop_cpu = FALSE;
 volatile t_bool sigterm_received = FALSE;
 static unsigned int sim_stop_sleep_ms = 250;
@@ -749,7 +765,8 @@ const char *sim_savename = sim_name;      /* Simulator Name used in SAVE/RESTORE
 
 /* Tables and strings */
 
-const char save_vercur[] = "V4.0";
+const char save_vercur[] = "V4.1";
+const char save_ver41[] = "V4.1";
 const char save_ver40[] = "V4.0";
 const char save_ver35[] = "V3.5";
 const char save_ver32[] = "V3.2";
@@ -997,6 +1014,19 @@ static const char simh_help1[] =
       " to a file.  This includes the contents of main memory and all registers,\n"
       " and the I/O connections of devices:\n\n"
       "++SAVE <filename>\n\n"
+      "4Switches\n"
+      " Switches can influence the output and behavior of the SAVE command\n\n"
+      "++-I      Incremental save: only memory pages changed since the most\n"
+      "++++++++++++recent SAVE or RESTORE are written.  The new file refers to\n"
+      "++++++++++++that earlier file by its full path, and it must be kept\n"
+      "++++++++++++there unchanged to RESTORE the incremental save.  Changed\n"
+      "++++++++++++pages are found by comparing a hash of every page, so all\n"
+      "++++++++++++of memory is still read; only the writing is saved.\n"
+      "++-B      Background save: the file is written by a copy of the\n"
+      "++++++++++++simulator, so the simulator is only paused briefly.  The\n"
+      "++++++++++++pause time is reported.  A later SAVE, RESTORE or exit\n"
+      "++++++++++++waits for the file to be complete.  (Not available on\n"
+      "++++++++++++Windows or VMS hosts.)\n\n"
 #define HLP_RESTORE     "*Commands Saving_and_Restoring_State RESTORE"
       "3RESTORE\n"
       " The RESTORE command (abbreviation REST, alternately GET) restores a\n"
@@ -1006,11 +1036,15 @@ static const char simh_help1[] =
       " Switches can influence the output and behavior of the RESTORE command\n\n"
       "++-Q      Suppresses version warning messages\n"
       "++-D      Suppress detaching and attaching devices during a restore\n"
-      "++-F      Overrides the related file timestamp validation check\n"
+      "++-F      Overrides the related file timestamp validation check and\n"
+      "++++++++++++the check that an incremental save's base is unchanged\n"
       "\n"
       "4Notes:\n"
-      " 1) SAVE file format compresses zeroes to minimize file size.\n"
-      " 2) The simulator can't restore active incoming telnet sessions to\n"
+      " 1) SAVE file format elides zero pages and compresses the rest of memory\n"
+      " to minimize file size.\n"
+      " 2) RESTORE of an incremental save first restores the chain of saves it\n"
+      " is based on, then applies its own changes.\n"
+      " 3) The simulator can't restore active incoming telnet sessions to\n"
       " multiplexer devices, but the listening ports will be restored across a\n"
       " save/restore.\n"
        /***************** 80 character line width template *************************/
@@ -1443,6 +1477,31 @@ static const char simh_help1[] =
       "3Asynch\n"
       "+SET ASYNCH                  enable asynchronous I/O\n"
       "+SET NOASYNCH                disable asynchronous I/O\n"
+#define HLP_SET_DISK "*Commands SET Disks"
+      "3Disks\n"
+      "+SET DISKS CACHE{=size}      enable the disk block cache (default 64M)\n"
+      "+SET DISKS NOCACHE           disable the disk block cache\n"
+      "+SET DISKS WRITEBACK         hold written data in the cache\n"
+      "+SET DISKS WRITETHROUGH      write data to disk immediately (default)\n"
+      "+SET DISKS FLUSH             write cached data to disk now\n"
+      "+SET DISKS SPARSE            keep disk containers sparse (default)\n"
+      "+SET DISKS NOSPARSE          fully allocate disk containers\n"
+      "+SET DISKS MMAP              map read only disk containers (default)\n"
+      "+SET DISKS NOMMAP            read read only disk containers with stdio\n\n"
+      " The disk block cache keeps recently used data from all attached disks\n"
+      " in memory.  The size may be given in K, M (the default) or G bytes.\n"
+      " In write-back mode written data is held in the cache and is written\n"
+      " to the disk containers when the simulator stops, on SAVE, on detach\n"
+      " and when the simulated system issues a flush command.  SHOW CACHE\n"
+      " displays the cache statistics.  Several options may be combined:\n\n"
+      "++SET DISKS CACHE=256M,WRITEBACK\n\n"
+      " With sparse containers, newly created SIMH format containers take no\n"
+      " host storage until written, and runs of zero sectors written to SIMH\n"
+      " and RAW format container files are turned into holes in the file.\n"
+      " SHOW DISKS displays the logical and allocated size of attached disks.\n\n"
+      " SIMH and RAW format containers which are attached read only are mapped\n"
+      " into memory when the host supports it, so simulators sharing the same\n"
+      " disk image share the host's cached copy of it.\n"
 #define HLP_SET_ENVIRON "*Commands SET Environment"
       "3Environment\n"
       "4Explicitily Changing a Variable\n"
@@ -1572,6 +1631,8 @@ static const char simh_help2[] =
       "+sh{ow} on                   show on condition actions\n"
       "+sh{ow} do                   show do nesting state\n"
       "+sh{ow} runlimit             show execution limit states\n"
+      "+sh{ow} cache                show disk block cache statistics\n"
+      "+sh{ow} disks                show attached disk container space usage\n"
       "+h{elp} <dev> show           displays the device specific show commands\n"
       "++++++++                     available\n"
 #define HLP_SHOW_CONFIG         "*Commands SHOW"
@@ -1599,6 +1660,8 @@ static const char simh_help2[] =
 #define HLP_SHOW_ON             "*Commands SHOW"
 #define HLP_SHOW_DO             "*Commands SHOW"
 #define HLP_SHOW_RUNLIMIT       "*Commands SHOW"
+#define HLP_SHOW_CACHE          "*Commands SHOW"
+#define HLP_SHOW_DISK           "*Commands SHOW"
 #define HLP_SHOW_SEND           "*Commands SHOW"
 #define HLP_SHOW_EXPECT         "*Commands SHOW"
 #define HLP_HELP                "*Commands HELP"
@@ -2585,6 +2648,7 @@ static CTAB set_glob_tab[] = {
     { "PROMPT",     &set_prompt,                0, HLP_SET_PROMPT },
     { "RUNLIMIT",   &set_runlimit,              1, HLP_RUNLIMIT },
     { "NORUNLIMIT", &set_runlimit,              0, HLP_RUNLIMIT },
+    { "DISKS",      &sim_disk_set_cache,        1, HLP_SET_DISK },
     { NULL,         NULL,                       0 }
     };
 
@@ -2642,6 +2706,8 @@ static SHTAB show_glob_tab[] = {
     { "ON",             &show_on,                  -1, HLP_SHOW_ON },
     { "DO",             &show_do,                   0, HLP_SHOW_DO },
     { "RUNLIMIT",       &show_runlimit,             0, HLP_SHOW_RUNLIMIT },
+    { "CACHE",          &sim_disk_show_cache,       0, HLP_SHOW_CACHE },
+    { "DISKS",          &sim_disk_show_disk,        0, HLP_SHOW_DISK },
     { NULL,             NULL,                       0 }
     };
 
@@ -2771,8 +2837,8 @@ sim_finit ();                                           /* init fio package */
 setenv ("SIM_NAME", sim_name, 1);                       /* Publish simulator name */
 stop_cpu = FALSE;
 sim_interval = 0;
-sim_time = sim_rtime = 0;
-noqueue_time = 0;
+sim_time = 0;
+sim_interval_base = 0;
 sim_clock_queue = QUEUE_LIST_END;
 sim_is_running = FALSE;
 sim_log = NULL;
@@ -2902,6 +2968,7 @@ if (SCPE_BARE_STATUS(stat) != SCPE_EXIT)
 
 cleanup_and_exit:
 
+sim_save_bg_wait ();                                    /* finish background SAVE */
 detach_all (0, TRUE);                                   /* close files */
 sim_set_deboff (0, NULL);                               /* close debug */
 sim_set_logoff (0, NULL);                               /* close log */
@@ -6532,20 +6599,28 @@ t_stat show_queue (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST
 DEVICE *dptr;
 UNIT *uptr;
 MEMFILE buf;
+SIM_EVENT *evq;
+int32 i;
 
 memset (&buf, 0, sizeof (buf));
 if (cptr && (*cptr != 0))
     return SCPE_2MARG;
 if (sim_clock_queue == QUEUE_LIST_END)
-    fprintf (st, "%s event queue empty, time = %.0f, executing %s %s/sec\n",
-             sim_name, sim_time, sim_fmt_numeric (sim_timer_inst_per_sec ()), sim_vm_interval_units);
+    fprintf (st, "%s event queue empty, time = %" LL_FMT "d, executing %s %s/sec\n",
+             sim_name, (LL_TYPE)sim_time, sim_fmt_numeric (sim_timer_inst_per_sec ()), sim_vm_interval_units);
 else {
     const char *tim = "";
     double inst_per_sec = sim_timer_inst_per_sec ();
 
-    fprintf (st, "%s event queue status, time = %.0f, executing %s %s/sec\n",
-             sim_name, sim_time, sim_fmt_numeric (inst_per_sec), sim_vm_interval_units);
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
+    fprintf (st, "%s event queue status, time = %" LL_FMT "d, executing %s %s/sec\n",
+             sim_name, (LL_TYPE)sim_time, sim_fmt_numeric (inst_per_sec), sim_vm_interval_units);
+    evq = (SIM_EVENT *)malloc (sim_evq_count * sizeof (*evq));    /* list in dispatch order */
+    if (evq == NULL)
+        return SCPE_MEM;
+    memcpy (evq, sim_evq, sim_evq_count * sizeof (*evq));
+    qsort (evq, sim_evq_count, sizeof (*evq), _sim_evq_compare);
+    for (i = 0; i < sim_evq_count; i++) {
+        uptr = evq[i].uptr;
         if (uptr == &sim_step_unit)
             fprintf (st, "  Step timer");
         else
@@ -6562,14 +6637,15 @@ else {
         if (inst_per_sec != 0.0)
             tim = sim_fmt_secs(((_sim_activate_queue_time (uptr) - 1) / sim_timer_inst_per_sec ()) + (uptr->usecs_remaining / 1000000.0));
         if (uptr->usecs_remaining)
-            fprintf (st, " at %d plus %.0f usecs%s%s%s%s\n", _sim_activate_queue_time (uptr) - 1, uptr->usecs_remaining,
+            fprintf (st, " at %d (due %" LL_FMT "d) plus %.0f usecs%s%s%s%s\n", _sim_activate_queue_time (uptr) - 1, (LL_TYPE)evq[i].due, uptr->usecs_remaining,
                                             (*tim) ? " (" : "", tim, (*tim) ? " total)" : "",
                                             (uptr->flags & UNIT_IDLE) ? " (Idle capable)" : "");
         else
-            fprintf (st, " at %d%s%s%s%s\n", _sim_activate_queue_time (uptr) - 1, 
+            fprintf (st, " at %d (due %" LL_FMT "d)%s%s%s%s\n", _sim_activate_queue_time (uptr) - 1, (LL_TYPE)evq[i].due,
                                             (*tim) ? " (" : "", tim, (*tim) ? ")" : "",
                                             (uptr->flags & UNIT_IDLE) ? " (Idle capable)" : "");
         }
+    free (evq);
     }
 sim_show_clock_queues (st, dnotused, unotused, flag, cptr);
 #if defined (SIM_ASYNCH_IO)
@@ -8022,6 +8098,342 @@ return uptr->uname = strcpy ((char *)malloc (1 + strlen (uname)), uname);
 }
 
 
+/* Save file memory pages
+
+   Starting with the V4.1 save format, memory is saved in pages of SRBSIZ
+   values.  The values of a page are laid out little endian (as the older
+   formats wrote them) and each page is recorded as one of:
+
+        int32 -n                        n zero values
+        int32 n, uint32 0, data         n values, stored as is
+        int32 n, uint32 c, c bytes      n values, compressed into c bytes
+        int32 0, int32 n                n values unchanged from the base
+                                        (incremental saves only)
+
+   An incremental save (SAVE -I) names the save file it is based on (by
+   its full path, followed by a line with the base's size and modify time
+   which RESTORE checks) and only contains pages whose contents differ
+   from that save.  Changed pages
+   are found by comparing a hash of each page with the hash recorded when
+   the page was last saved or restored, so there is no dependence on the
+   simulator tracking its own memory writes.  RESTORE of an incremental
+   save first restores its base (recursively, down the chain of saves) and
+   then applies the changed pages.
+
+   The compressor is a simple byte oriented LZ77 variant, chosen for speed
+   rather than ratio.  The compressed stream is a sequence of:
+
+        0nnnnnnn                        n+1 literal bytes follow
+        1nnnnnnn lo hi                  copy n+4 bytes from offset hi:lo back
+*/
+
+typedef struct SAVE_PGHASH {
+    UNIT                *uptr;                          /* memory unit */
+    t_addr              high;                           /* capacity when hashed */
+    uint32              pages;                          /* page count */
+    t_bool              valid;                          /* hashes match last save/restore */
+    t_uint64            *hash;                          /* per page hashes */
+    } SAVE_PGHASH;
+
+static SAVE_PGHASH *sim_save_pghash = NULL;             /* page hash tables */
+static int32 sim_save_pghash_cnt = 0;
+static char *sim_save_base = NULL;                      /* full path of last saved or restored file */
+static char sim_save_base_id[64];                       /* its identity when saved or restored */
+
+#define SAVE_LZ_HBITS   12                              /* match finder table size */
+#define SAVE_LZ_MINMATCH 4
+#define SAVE_LZ_MAXMATCH (0x7F + SAVE_LZ_MINMATCH)
+#define SAVE_LZ_MAXLIT  0x80
+#define SAVE_LZ_MAXOFF  0xFFFF
+
+/* Compress len bytes from in to out.  Returns the compressed length, or 0
+   if the data doesn't compress to less than len bytes. */
+
+static size_t sim_save_compress (const uint8 *in, size_t len, uint8 *out)
+{
+uint32 htab[1 << SAVE_LZ_HBITS];
+size_t ip = 0, op = 0, lit = 0;
+
+memset (htab, 0xFF, sizeof (htab));
+while (ip + SAVE_LZ_MINMATCH <= len) {
+    uint32 seq = in[ip] | (in[ip+1] << 8) | (in[ip+2] << 16) | ((uint32)in[ip+3] << 24);
+    uint32 h = (seq * 2654435761u) >> (32 - SAVE_LZ_HBITS);
+    uint32 ref = htab[h];
+    size_t mlen = 0;
+
+    htab[h] = (uint32)ip;
+    if ((ref != 0xFFFFFFFF) && (ip - ref <= SAVE_LZ_MAXOFF) &&
+        (memcmp (in + ref, in + ip, SAVE_LZ_MINMATCH) == 0)) {
+        mlen = SAVE_LZ_MINMATCH;
+        while ((ip + mlen < len) && (mlen < SAVE_LZ_MAXMATCH) &&
+               (in[ref + mlen] == in[ip + mlen]))
+            ++mlen;
+        }
+    if (mlen == 0) {                                    /* literal */
+        ++ip;
+        if (++lit == SAVE_LZ_MAXLIT) {                  /* flush full literal run */
+            if (op + 1 + lit >= len)
+                return 0;
+            out[op++] = (uint8)(lit - 1);
+            memcpy (out + op, in + ip - lit, lit);
+            op += lit;
+            lit = 0;
+            }
+        continue;
+        }
+    if (lit) {                                          /* flush pending literals */
+        if (op + 1 + lit >= len)
+            return 0;
+        out[op++] = (uint8)(lit - 1);
+        memcpy (out + op, in + ip - lit, lit);
+        op += lit;
+        lit = 0;
+        }
+    if (op + 3 >= len)
+        return 0;
+    out[op++] = (uint8)(0x80 | (mlen - SAVE_LZ_MINMATCH));
+    out[op++] = (uint8)((ip - ref) & 0xFF);
+    out[op++] = (uint8)((ip - ref) >> 8);
+    ip += mlen;
+    }
+lit += len - ip;                                        /* trailing bytes */
+ip = len;
+while (lit) {
+    size_t n = (lit > SAVE_LZ_MAXLIT) ? SAVE_LZ_MAXLIT : lit;
+
+    if (op + 1 + n >= len)
+        return 0;
+    out[op++] = (uint8)(n - 1);
+    memcpy (out + op, in + ip - lit, n);
+    op += n;
+    lit -= n;
+    }
+return op;
+}
+
+/* Expand clen compressed bytes into exactly len bytes */
+
+static t_bool sim_save_expand (const uint8 *in, size_t clen, uint8 *out, size_t len)
+{
+size_t ip = 0, op = 0;
+
+while (ip < clen) {
+    uint8 c = in[ip++];
+
+    if (c & 0x80) {                                     /* match? */
+        size_t n = (c & 0x7F) + SAVE_LZ_MINMATCH;
+        size_t off;
+
+        if (ip + 2 > clen)
+            return FALSE;
+        off = in[ip] | (in[ip + 1] << 8);
+        ip += 2;
+        if ((off == 0) || (off > op) || (op + n > len))
+            return FALSE;
+        while (n--) {                                   /* may overlap */
+            out[op] = out[op - off];
+            ++op;
+            }
+        }
+    else {                                              /* literals */
+        size_t n = c + 1;
+
+        if ((ip + n > clen) || (op + n > len))
+            return FALSE;
+        memcpy (out + op, in + ip, n);
+        ip += n;
+        op += n;
+        }
+    }
+return (op == len);
+}
+
+static t_uint64 sim_save_page_hash (const uint8 *buf, size_t len)
+{
+t_uint64 h = 0xCBF29CE484222325ull;                     /* FNV-1a, 8 bytes at a time */
+t_uint64 w;
+
+for (; len >= sizeof (w); len -= sizeof (w), buf += sizeof (w)) {
+    memcpy (&w, buf, sizeof (w));
+    h = (h ^ w) * 0x100000001B3ull;
+    h ^= h >> 29;
+    }
+while (len--)
+    h = (h ^ *buf++) * 0x100000001B3ull;
+return h;
+}
+
+/* Find (or create) the page hash table for a memory unit.  A size change
+   invalidates the recorded hashes. */
+
+static SAVE_PGHASH *sim_save_hashes (UNIT *uptr, t_addr high, uint32 aincr)
+{
+SAVE_PGHASH *ph;
+uint32 pages = (uint32)(((high + aincr - 1) / aincr + SRBSIZ - 1) / SRBSIZ);
+int32 i;
+
+for (i = 0; i < sim_save_pghash_cnt; i++)
+    if (sim_save_pghash[i].uptr == uptr)
+        break;
+if (i == sim_save_pghash_cnt) {
+    ph = (SAVE_PGHASH *)realloc (sim_save_pghash, (i + 1) * sizeof (*ph));
+    if (ph == NULL)
+        return NULL;
+    sim_save_pghash = ph;
+    memset (&ph[i], 0, sizeof (*ph));
+    ph[i].uptr = uptr;
+    ++sim_save_pghash_cnt;
+    }
+ph = &sim_save_pghash[i];
+if ((ph->high != high) || (ph->hash == NULL)) {
+    free (ph->hash);
+    ph->hash = (t_uint64 *)calloc (pages ? pages : 1, sizeof (*ph->hash));
+    ph->high = high;
+    ph->pages = pages;
+    ph->valid = FALSE;
+    if (ph->hash == NULL)
+        return NULL;
+    }
+return ph;
+}
+
+/* Identify a save file by its size and modify time, so an incremental
+   save is only ever applied to the file it was based on */
+
+static t_bool sim_save_identity (const char *filename, char *ident, size_t ident_size)
+{
+struct stat statb;
+
+if (sim_stat (filename, &statb))
+    return FALSE;
+snprintf (ident, ident_size, "%" LL_FMT "d %" LL_FMT "d", (LL_TYPE)statb.st_size, (LL_TYPE)statb.st_mtime);
+return TRUE;
+}
+
+/* Is filename the file later incremental saves are based on? */
+
+static t_bool sim_save_is_base (const char *filename)
+{
+char *fullname;
+t_bool is_base;
+
+if (sim_save_base == NULL)
+    return FALSE;
+fullname = sim_filepath_parts (filename, "f");
+is_base = (fullname != NULL) && (strcmp (fullname, sim_save_base) == 0);
+free (fullname);
+return is_base;
+}
+
+/* Record the file later incremental saves are based on.  Forgetting it
+   (NULL) also invalidates the page hashes. */
+
+static void sim_save_set_base (const char *filename)
+{
+int32 i;
+
+free (sim_save_base);
+sim_save_base = NULL;
+if (filename != NULL) {
+    sim_save_base = sim_filepath_parts (filename, "f");
+    if ((sim_save_base != NULL) &&
+        (!sim_save_identity (sim_save_base, sim_save_base_id, sizeof (sim_save_base_id)))) {
+        free (sim_save_base);
+        sim_save_base = NULL;
+        }
+    }
+if (sim_save_base == NULL) {
+    for (i = 0; i < sim_save_pghash_cnt; i++)
+        sim_save_pghash[i].valid = FALSE;
+    }
+}
+
+/* Background SAVE support
+
+   SAVE -B forks the simulator.  The child inherits a copy-on-write image of
+   the stopped simulator and writes the save file from it, while the parent
+   returns to the command level at once.  The simulator is only paused for
+   the duration of the fork.  The child's exit status reports the result,
+   which is collected by the next SAVE or RESTORE, or at exit.
+
+   Only the thread calling fork exists in the child, so a lock any other
+   thread (asynchronous I/O, multiplexer polling, Ethernet reading) held
+   at the time of the fork stays locked there.  The child therefore only
+   runs sim_save and then _exit.  sim_save reads registers and memory and
+   writes its own file without taking any of those locks, and must be
+   kept that way; anything it calls which may lock belongs in save_cmd
+   before the fork.
+*/
+
+#if defined(SIM_SAVE_BACKGROUND)
+static pid_t sim_save_bg_pid = 0;                       /* running child */
+static char *sim_save_bg_file = NULL;                   /* file it is writing */
+static double sim_save_bg_start;                        /* when it started */
+#endif
+
+static t_stat sim_save_bg_wait (void)
+{
+#if defined(SIM_SAVE_BACKGROUND)
+int status;
+t_stat r = SCPE_OK;
+
+if (sim_save_bg_pid == 0)
+    return SCPE_OK;
+while ((waitpid (sim_save_bg_pid, &status, 0) < 0) && (errno == EINTR))
+    ;
+if (WIFEXITED (status) && (WEXITSTATUS (status) == 0))
+    sim_messagef (SCPE_OK, "Background SAVE of %s completed after %.3f seconds\n", sim_save_bg_file, sim_timenow_double () - sim_save_bg_start);
+else
+    r = sim_messagef (SCPE_IOERR, "Background SAVE of %s failed\n", sim_save_bg_file);
+sim_save_bg_pid = 0;
+free (sim_save_bg_file);
+sim_save_bg_file = NULL;
+return r;
+#else
+return SCPE_OK;
+#endif
+}
+
+/* Start a background save to an already open file */
+
+static t_stat sim_save_background (FILE *sfile, const char *filename)
+{
+#if defined(SIM_SAVE_BACKGROUND)
+pid_t pid;
+double start, pause;
+
+if (sim_memmap_in_use ()) {                             /* shared mappings aren't copied on write */
+    fclose (sfile);
+    return sim_messagef (SCPE_NOFNC, "Background SAVE can't snapshot memory kept in a memory file\n");
+    }
+fflush (NULL);                                          /* don't let the child repeat buffered output */
+start = sim_timenow_double ();
+pid = fork ();
+if (pid == 0) {                                         /* child? */
+    t_stat r = sim_save (sfile);
+
+    if (fclose (sfile) != 0)
+        r = SCPE_IOERR;
+    _exit ((r == SCPE_OK) ? 0 : 1);                     /* skip exit handlers */
+    }
+pause = sim_timenow_double () - start;
+fclose (sfile);
+if (pid < 0)
+    return sim_messagef (SCPE_IOERR, "Can't start background SAVE: %s\n", strerror (errno));
+sim_save_bg_pid = pid;
+sim_save_bg_start = start;
+sim_save_bg_file = (char *)malloc (1 + strlen (filename));
+if (sim_save_bg_file != NULL)
+    strcpy (sim_save_bg_file, filename);
+if (sim_save_is_base (filename))
+    sim_save_set_base (NULL);                           /* base is being rewritten */
+return sim_messagef (SCPE_OK, "Background SAVE of %s started, simulator paused %.3f ms\n", filename, 1000.0 * pause);
+#else
+fclose (sfile);
+return sim_messagef (SCPE_NOFNC, "Background SAVE is not available on this host\n");
+#endif
+}
+
 /* Save command
 
    sa[ve] filename              save state to specified file
@@ -8039,25 +8451,48 @@ if (*cptr == 0)                                         /* must be more */
 gbuf[sizeof(gbuf)-1] = '\0';
 strlcpy (gbuf, cptr, sizeof(gbuf));
 sim_trim_endspc (gbuf);
+r = sim_save_bg_wait ();                                /* finish any background save */
+if (r != SCPE_OK)
+    return r;
+if (sim_switches & SWMASK ('I')) {                      /* incremental? */
+    char ident[sizeof (sim_save_base_id)];
+
+    if (sim_save_base == NULL)
+        return sim_messagef (SCPE_NOFNC, "No prior SAVE or RESTORE to base an incremental save on\n");
+    if (sim_save_is_base (gbuf))
+        return sim_messagef (SCPE_ARG, "An incremental save can't replace its base: %s\n", gbuf);
+    if ((!sim_save_identity (sim_save_base, ident, sizeof (ident))) ||
+        (strcmp (ident, sim_save_base_id) != 0))
+        return sim_messagef (SCPE_INCOMP, "Incremental save base %s has changed since it was saved or restored\n", sim_save_base);
+    }
 if ((sfile = sim_fopen (gbuf, "r+b")) == NULL) {    /* try existing file */
     if ((sfile = sim_fopen (gbuf, "wb")) == NULL)   /* create new empty file */
         return SCPE_OPENERR;
     }
+sim_memmap_sync ();                                     /* bring memory files up to date */
+sim_disk_flush (NULL);                                  /* and cached disk data */
+if (sim_switches & SWMASK ('B'))                        /* background? */
+    return sim_save_background (sfile, gbuf);
 r = sim_save (sfile);
 fclose (sfile);
+sim_save_set_base ((r == SCPE_OK) ? gbuf : NULL);       /* next incremental base */
 return r;
 }
 
 t_stat sim_save (FILE *sfile)
 {
 void *mbuf;
-int32 l, t;
-uint32 i, j, device_count;
+uint8 *cbuf;
+int32 l, t, skip;
+uint32 i, j, device_count, rtime, pg, clen;
 t_addr k, high;
 t_value val;
 t_stat r;
 t_bool zeroflg;
+t_bool incremental = ((sim_switches & SWMASK ('I')) != 0) && (sim_save_base != NULL);
 size_t sz;
+t_uint64 hash;
+SAVE_PGHASH *ph;
 DEVICE *dptr;
 UNIT *uptr;
 REG *rptr;
@@ -8070,8 +8505,9 @@ fprintf (sfile, "%s\n%s\n%s\n%s\n%s\n%.0f\n",
     save_vercur,                                        /* [V2.5] save format */
     sim_savename,                                       /* sim name */
     sim_si64, sim_sa64, eth_capabilities(),             /* [V3.5] options */
-    sim_time);                                          /* [V3.2] sim time */
-WRITE_I (sim_rtime);                                    /* [V2.6] sim rel time */
+    (double)sim_time);                                  /* [V3.2] sim time */
+rtime = (uint32)sim_time;
+WRITE_I (rtime);                                        /* [V2.6] sim rel time */
 #if defined(SIM_GIT_COMMIT_ID)
 #define S_xstr(a) S_str(a)
 #define S_str(a) #a
@@ -8081,6 +8517,9 @@ fprintf (sfile, "git commit id: %8.8s\n", S_xstr(SIM_GIT_COMMIT_ID));
 #else
 fprintf (sfile, "git commit id: unknown\n");
 #endif
+fprintf (sfile, "%s\n", incremental ? sim_save_base : "");/* [V4.1] incremental base */
+if (incremental)
+    fprintf (sfile, "%s\n", sim_save_base_id);         /* [V4.1] base size and mtime */
 
 for (device_count = 0; sim_devices[device_count]; device_count++);/* count devices */
 for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru devices */
@@ -8132,32 +8571,64 @@ for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru d
              ((high = uptr->capac) != 0)) {             /* memory-like unit? */
             WRITE_I (high);                             /* [V2.5] write size */
             sz = SZ_D (dptr);
-            if ((mbuf = calloc (SRBSIZ, sz)) == NULL) {
-                fclose (sfile);
+            mbuf = calloc (SRBSIZ, sz);
+            cbuf = (uint8 *)malloc (SRBSIZ * sz);
+            ph = sim_save_hashes (uptr, high, dptr->aincr);
+            if ((mbuf == NULL) || (cbuf == NULL) || (ph == NULL)) {
+                free (mbuf);
+                free (cbuf);
                 return SCPE_MEM;
                 }
-            for (k = 0; k < high; ) {                   /* loop thru mem */
+            for (k = 0, pg = 0, skip = 0; k < high; pg++) {/* loop thru mem pages */
                 zeroflg = TRUE;
                 for (l = 0; (l < SRBSIZ) && (k < high); l++,
                      k = k + (dptr->aincr)) {           /* check for 0 block */
                     r = dptr->examine (&val, k, uptr, SIM_SW_REST);
                     if (r != SCPE_OK) {
                         free (mbuf);
+                        free (cbuf);
                         return r;
                         }
                     if (val) zeroflg = FALSE;
                     SZ_STORE (sz, val, mbuf, l);
                     }                                   /* end for l */
+                if (!sim_end)                           /* file data is little endian */
+                    sim_buf_swap_data (mbuf, sz, l);
+                hash = sim_save_page_hash ((uint8 *)mbuf, l * sz);
+                if (incremental && ph->valid &&         /* unchanged since base? */
+                    (ph->hash[pg] == hash)) {
+                    skip += l;                          /* just count it */
+                    continue;
+                    }
+                ph->hash[pg] = hash;
+                if (skip) {                             /* end of unchanged run? */
+                    t = 0;
+                    WRITE_I (t);
+                    WRITE_I (skip);                     /* unchanged count */
+                    skip = 0;
+                    }
                 if (zeroflg) {                          /* all zero's? */
                     l = -l;                             /* invert block count */
                     WRITE_I (l);                        /* write only count */
                     }
                 else {
+                    clen = (uint32)sim_save_compress ((uint8 *)mbuf, l * sz, cbuf);
                     WRITE_I (l);                        /* block count */
-                    sim_fwrite (mbuf, sz, l, sfile);
+                    WRITE_I (clen);                     /* [V4.1] compressed size */
+                    if (clen)
+                        sim_fwrite (cbuf, 1, clen, sfile);
+                    else
+                        sim_fwrite (mbuf, 1, l * sz, sfile);
                     }
                 }                                       /* end for k */
+            if (skip) {                                 /* trailing unchanged run */
+                t = 0;
+                WRITE_I (t);
+                WRITE_I (skip);
+                }
+            ph->valid = TRUE;
             free (mbuf);                                /* dealloc buffer */
+            free (cbuf);
             }                                           /* end if mem */
         else {                                          /* no memory */
             high = 0;                                   /* write 0 */
@@ -8206,10 +8677,12 @@ if (*cptr == 0)                                         /* must be more */
 gbuf[sizeof(gbuf)-1] = '\0';
 strlcpy (gbuf, cptr, sizeof(gbuf));
 sim_trim_endspc (gbuf);
+sim_save_bg_wait ();                                    /* file may still be being written */
 if ((rfile = sim_fopen (gbuf, "rb")) == NULL)
     return SCPE_OPENERR;
 r = sim_rest (rfile);
 fclose (rfile);
+sim_save_set_base ((r == SCPE_OK) ? gbuf : NULL);       /* next incremental base */
 return r;
 }
 
@@ -8221,13 +8694,16 @@ UNIT **attunits = NULL;
 int32 *attswitches = NULL;
 int32 attcnt = 0;
 void *mbuf;
+uint8 *cbuf;
 int32 j, blkcnt, limit, unitno, time, flg;
-uint32 us, depth;
+uint32 us, depth, rtime, pg, clen;
+double gtime;
 t_addr k, high, old_capac;
 t_value val, mask;
 t_stat r;
 size_t sz;
-t_bool v40, v35, v32;
+t_bool v41, v40, v35, v32;
+SAVE_PGHASH *ph;
 DEVICE *dptr;
 UNIT *uptr;
 REG *rptr;
@@ -8252,8 +8728,10 @@ if (fstat (fileno (rfile), &rstat)) {
     goto Cleanup_Return;
     }
 READ_S (buf);                                           /* [V2.5+] read version */
-v40 = v35 = v32 = FALSE;
-if (strcmp (buf, save_ver40) == 0)                      /* version 4.0? */
+v41 = v40 = v35 = v32 = FALSE;
+if (strcmp (buf, save_ver41) == 0)                      /* version 4.1? */
+    v41 = v40 = v35 = v32 = TRUE;
+else if (strcmp (buf, save_ver40) == 0)                 /* version 4.0? */
     v40 = v35 = v32 = TRUE;
 else if (strcmp (buf, save_ver35) == 0)                 /* version 3.5? */
     v35 = v32 = TRUE;
@@ -8263,7 +8741,7 @@ else if (strcmp (buf, save_ver30) != 0) {               /* version 3.0? */
     sim_printf ("Invalid file version: %s\n", buf);
     return SCPE_INCOMP;
     }
-if ((strcmp (buf, save_ver40) != 0) && (!sim_quiet) && (!suppress_warning)) {
+if ((strcmp (buf, save_vercur) != 0) && (!sim_quiet) && (!suppress_warning)) {
     sim_printf ("warning - attempting to restore a saved simulator image in %s image format.\n", buf);
     warned = TRUE;
     }
@@ -8287,10 +8765,11 @@ if (v35) {                                              /* [V3.5+] options */
     }
 if (v32) {                                              /* [V3.2+] time as string */
     READ_S (buf);
-    sscanf (buf, "%lf", &sim_time);
+    sscanf (buf, "%lf", &gtime);
     }
-else READ_I (sim_time);                                 /* sim time */
-READ_I (sim_rtime);                                     /* [V2.6+] sim rel time */
+else READ_I (gtime);                                    /* sim time */
+sim_time = (t_int64)gtime;
+READ_I (rtime);                                         /* [V2.6+] sim rel time (implied by sim time) */
 if (v40) {
     READ_S (buf);                                       /* read git commit id */
 #if defined(SIM_GIT_COMMIT_ID)
@@ -8305,6 +8784,39 @@ if (v40) {
 #undef S_xstr
 #endif
     }
+if (v41) {
+    READ_S (buf);                                       /* [V4.1] incremental base */
+    if (buf[0] != '\0') {                               /* restore base first */
+        char ident[64], bident[64];
+        FILE *bfile;
+
+        READ_S (ident);                                 /* [V4.1] base size and mtime */
+        if (!sim_save_identity (buf, bident, sizeof (bident))) {
+            sim_printf ("Can't open incremental save base: %s\n", buf);
+            r = SCPE_OPENERR;
+            goto Cleanup_Return;
+            }
+        if ((strcmp (ident, bident) != 0) && (!force_restore)) {
+            sim_printf ("Incremental save base %s has changed since this save was made\n", buf);
+            r = SCPE_INCOMP;
+            goto Cleanup_Return;
+            }
+        bfile = sim_fopen (buf, "rb");
+        if (bfile == NULL) {
+            sim_printf ("Can't open incremental save base: %s\n", buf);
+            r = SCPE_OPENERR;
+            goto Cleanup_Return;
+            }
+        sim_switches = SWMASK ('D') | SWMASK ('Q') |    /* base only provides state */
+                       (force_restore ? SWMASK ('F') : 0);
+        r = sim_rest (bfile);                           /* this file then overrides */
+        fclose (bfile);
+        if (r != SCPE_OK) {
+            sim_printf ("Error restoring incremental save base: %s\n", buf);
+            goto Cleanup_Return;
+            }
+        }
+    }
 if (!dont_detach_attach)
     detach_all (0, 0);                                  /* Detach everything to start from a consistent state */
 else {
@@ -8437,36 +8949,71 @@ for ( ;; ) {                                            /* device loop */
                 sim_printf ("\n");
                 }
             sz = SZ_D (dptr);                           /* allocate buffer */
-            if ((mbuf = calloc (SRBSIZ, sz)) == NULL) {
+            mbuf = calloc (SRBSIZ, sz);
+            cbuf = (uint8 *)malloc (SRBSIZ * sz);
+            ph = sim_save_hashes (uptr, high, dptr->aincr);
+            if ((mbuf == NULL) || (cbuf == NULL) || (ph == NULL)) {
+                free (mbuf);
+                free (cbuf);
                 r = SCPE_MEM;
                 goto Cleanup_Return;
                 }
             for (k = 0; k < high; ) {                   /* loop thru mem */
-                if (sim_fread (&blkcnt, sizeof (blkcnt), 1, rfile) == 0) {/* block count */
-                    free (mbuf);
-                    r = SCPE_IOERR;
-                    goto Cleanup_Return;
+                pg = (uint32)((k / dptr->aincr) / SRBSIZ);
+                limit = 0;
+                if ((sim_fread (&blkcnt, sizeof (blkcnt), 1, rfile) == 0) ||/* block count */
+                    (blkcnt > SRBSIZ) || (blkcnt < -SRBSIZ))
+                    blkcnt = 0;
+                else if (v41 && (blkcnt == 0)) {        /* [V4.1] unchanged from base? */
+                    if ((sim_fread (&limit, sizeof (limit), 1, rfile) == 0) ||
+                        (!ph->valid))                   /* base must have supplied it */
+                        limit = 0;
+                    k = k + limit * dptr->aincr;        /* skip */
+                    if (limit > 0)
+                        continue;
                     }
-                if (blkcnt < 0)                         /* compressed? */
+                else if (blkcnt < 0) {                  /* zero block? */
                     limit = -blkcnt;
-                else limit = (int32)sim_fread (mbuf, sz, blkcnt, rfile);
-                if (limit <= 0) {                       /* invalid or err? */
+                    memset (mbuf, 0, limit * sz);
+                    }
+                else if (v41) {                         /* [V4.1] page data */
+                    if ((sim_fread (&clen, sizeof (clen), 1, rfile) != 0) &&
+                        (clen <= SRBSIZ * sz)) {
+                        if (clen == 0)                  /* stored? */
+                            limit = (int32)(sim_fread (mbuf, 1, blkcnt * sz, rfile) / sz);
+                        else if ((sim_fread (cbuf, 1, clen, rfile) == clen) &&
+                                 sim_save_expand (cbuf, clen, (uint8 *)mbuf, blkcnt * sz))
+                            limit = blkcnt;
+                        }
+                    }
+                else {                                  /* file order for hashing */
+                    limit = (int32)sim_fread (mbuf, sz, blkcnt, rfile);
+                    if ((limit > 0) && (!sim_end))
+                        sim_buf_swap_data (mbuf, sz, limit);
+                    }
+                if ((limit <= 0) || (limit < blkcnt)) { /* invalid or err? */
                     free (mbuf);
+                    free (cbuf);
                     r = SCPE_IOERR;
                     goto Cleanup_Return;
                     }
+                if (pg < ph->pages)                     /* remember page contents */
+                    ph->hash[pg] = sim_save_page_hash ((uint8 *)mbuf, limit * sz);
+                if (!sim_end)                           /* file data is little endian */
+                    sim_buf_swap_data (mbuf, sz, limit);
                 for (j = 0; j < limit; j++, k = k + (dptr->aincr)) {
-                    if (blkcnt < 0)                     /* compressed? */
-                        val = 0;
-                    else SZ_LOAD (sz, val, mbuf, j);    /* saved value */
+                    SZ_LOAD (sz, val, mbuf, j);         /* saved value */
                     r = dptr->deposit (val, k, uptr, SIM_SW_REST);
                     if (r != SCPE_OK) {
                         free (mbuf);
+                        free (cbuf);
                         goto Cleanup_Return;
                         }
                     }                                   /* end for j */
                 }                                       /* end for k */
+            ph->valid = TRUE;
             free (mbuf);                                /* dealloc buffer */
+            free (cbuf);
             }                                           /* end if high */
         }                                               /* end unit loop */
     for ( ;; ) {                                        /* register loop */
@@ -8902,8 +9449,8 @@ t_stat r;
 /* reset queue */
 while (sim_clock_queue != QUEUE_LIST_END)
     sim_cancel (sim_clock_queue);
-sim_time = sim_rtime = 0;
-noqueue_time = sim_interval = 0;
+sim_time = 0;
+sim_interval_base = sim_interval = 0;
 r = reset_all (0);
 if ((r == SCPE_OK) && (flag == RU_RUN)) {
     if ((run_cmd_did_reset) && (0 == (sim_switches & SWMASK ('Q')))) {
@@ -9319,6 +9866,10 @@ return SCPE_OK;
         idx     =       index
    Outputs:
         return  =       register value
+
+   A single register whose variable is narrower than 32 bits is accessed
+   at the variable's width (here and in put_rval), so it never touches
+   its neighbors.
 */
 
 t_value get_rval (REG *rptr, uint32 idx)
@@ -9326,8 +9877,13 @@ t_value get_rval (REG *rptr, uint32 idx)
 size_t sz;
 t_value val;
 uint32 *ptr;
+t_bool fit = ((rptr->depth > 1) || (rptr->flags & REG_FIT));
 
 sz = SZ_R (rptr);
+if ((!fit) && (rptr->obj_size != 0) && (rptr->obj_size < sizeof (uint32))) {
+    fit = TRUE;                                         /* byte or word variable */
+    sz = rptr->obj_size;
+    }
 if ((rptr->depth > 1) && (rptr->flags & REG_CIRC)) {
     idx = idx + rptr->qptr;
     if (idx >= rptr->depth) idx = idx - rptr->depth;
@@ -9352,11 +9908,9 @@ else if ((rptr->depth > 1) && (rptr->flags & REG_STRUCT)) {
     val = *ptr;
 #endif
     }
-else if (((rptr->depth > 1) || (rptr->flags & REG_FIT)) &&
-    (sz == sizeof (uint8)))
+else if (fit && (sz == sizeof (uint8)))
     val = *(((uint8 *) rptr->loc) + idx);
-else if (((rptr->depth > 1) || (rptr->flags & REG_FIT)) &&
-    (sz == sizeof (uint16)))
+else if (fit && (sz == sizeof (uint16)))
     val = *(((uint16 *) rptr->loc) + idx);
 #if defined (USE_INT64)
 else if (sz <= sizeof (uint32))
@@ -9439,6 +9993,7 @@ size_t sz;
 t_value mask;
 uint32 *ptr;
 t_value prev_val;
+t_bool fit = ((rptr->depth > 1) || (rptr->flags & REG_FIT));
 
 if ((!(sim_switches & SWMASK ('Z'))) && 
     (rptr->flags & REG_DEPOSIT) && sim_vm_reg_update)
@@ -9452,6 +10007,10 @@ if ((!(sim_switches & SWMASK ('Z'))) &&
 if (pc_chk && (rptr == sim_PC))
     sim_brk_npc (0);
 sz = SZ_R (rptr);
+if ((!fit) && (rptr->obj_size != 0) && (rptr->obj_size < sizeof (uint32))) {
+    fit = TRUE;                                         /* byte or word variable */
+    sz = rptr->obj_size;
+    }
 mask = width_mask[rptr->width];
 if ((rptr->depth > 1) && (rptr->flags & REG_CIRC)) {
     idx = idx + rptr->qptr;
@@ -9488,11 +10047,9 @@ else if ((rptr->depth > 1) && (rptr->flags & REG_STRUCT)) {
         (((uint32) val) << rptr->offset);
 #endif
     }
-else if (((rptr->depth > 1) || (rptr->flags & REG_FIT)) &&
-    (sz == sizeof (uint8)))
+else if (fit && (sz == sizeof (uint8)))
     PUT_RVAL (uint8, rptr, idx, (uint32) val, (uint32) mask);
-else if (((rptr->depth > 1) || (rptr->flags & REG_FIT)) &&
-    (sz == sizeof (uint16)))
+else if (fit && (sz == sizeof (uint16)))
     PUT_RVAL (uint16, rptr, idx, (uint32) val, (uint32) mask);
 #if defined (USE_INT64)
 else if (sz <= sizeof (uint32))
@@ -11382,8 +11939,19 @@ return buf;
    and to see if further events need to be processed, or sim_interval
    reset to count the next one.
 
-   The event queue is maintained in clock order; entry timeouts are
-   RELATIVE to the time in the previous entry.
+   Global time is a 64 bit count of simulator units (sim_time), and
+   sim_interval only counts down to the first entry; it is reloaded
+   from that entry's due time whenever the head of the queue changes.
+
+   The event queue is a binary heap ordered by the ABSOLUTE time at
+   which each entry is due.  Entries which are due at the same time
+   are ordered by an activation sequence number, so they are dispatched
+   in the order in which they were activated.  sim_clock_queue always
+   refers to the earliest pending entry (QUEUE_LIST_END when the queue
+   is empty), and a unit's next pointer is non-NULL while it is queued.
+   Each queued unit records its heap slot (evq_slot), so finding a 
+   unit's entry to cancel it or to report its activation time doesn't
+   require a search.
 
    sim_process_event - process event
 
@@ -11394,11 +11962,116 @@ return buf;
                         or 0 (SCPE_OK) if no exceptions
 */
 
+/* Event heap helpers */
+
+static t_bool _sim_evq_before (const SIM_EVENT *a, const SIM_EVENT *b)
+{
+return ((a->due < b->due) || ((a->due == b->due) && (a->seq < b->seq)));
+}
+
+static int _sim_evq_compare (const void *pa, const void *pb)
+{
+const SIM_EVENT *a = (const SIM_EVENT *)pa;
+const SIM_EVENT *b = (const SIM_EVENT *)pb;
+
+if (_sim_evq_before (a, b))
+    return -1;
+return _sim_evq_before (b, a) ? 1 : 0;
+}
+
+static void _sim_evq_up (int32 i)
+{
+SIM_EVENT ev = sim_evq[i];
+
+while (i > 0) {
+    int32 parent = (i - 1) / 2;
+
+    if (!_sim_evq_before (&ev, &sim_evq[parent]))
+        break;
+    sim_evq[i] = sim_evq[parent];
+    sim_evq[i].uptr->evq_slot = i + 1;
+    i = parent;
+    }
+sim_evq[i] = ev;
+ev.uptr->evq_slot = i + 1;
+}
+
+static void _sim_evq_down (int32 i)
+{
+SIM_EVENT ev = sim_evq[i];
+
+while (1) {
+    int32 child = 2 * i + 1;
+
+    if (child >= sim_evq_count)
+        break;
+    if (((child + 1) < sim_evq_count) &&
+        _sim_evq_before (&sim_evq[child + 1], &sim_evq[child]))
+        ++child;
+    if (!_sim_evq_before (&sim_evq[child], &ev))
+        break;
+    sim_evq[i] = sim_evq[child];
+    sim_evq[i].uptr->evq_slot = i + 1;
+    i = child;
+    }
+sim_evq[i] = ev;
+ev.uptr->evq_slot = i + 1;
+}
+
+static void _sim_evq_remove (int32 i)
+{
+sim_evq[i].uptr->evq_slot = 0;
+if (i != --sim_evq_count) {
+    sim_evq[i] = sim_evq[sim_evq_count];
+    if ((i > 0) && _sim_evq_before (&sim_evq[i], &sim_evq[(i - 1) / 2]))
+        _sim_evq_up (i);
+    else
+        _sim_evq_down (i);
+    }
+}
+
+static int32 _sim_evq_find (UNIT *uptr)
+{
+int32 i = (int32)uptr->evq_slot - 1;
+
+if ((i < 0) || (i >= sim_evq_count) || (sim_evq[i].uptr != uptr))
+    return -1;
+return i;
+}
+
+/* Reload sim_interval from the head of the queue.  The caller must
+   have accounted for any elapsed time (UPDATE_SIM_TIME) beforehand. */
+
+static void _sim_evq_reload (void)
+{
+if (sim_evq_count == 0) {
+    sim_clock_queue = QUEUE_LIST_END;
+    sim_interval = sim_interval_base = NOQUEUE_WAIT;
+    }
+else {
+    sim_clock_queue = sim_evq[0].uptr;
+    sim_interval = sim_interval_base = (int32)(sim_evq[0].due - sim_time);
+    }
+}
+
+/* Queue time for a unit as seen by the event queue.  Time which has 
+   elapsed beyond the due time of the first entry has not yet been
+   dispatched, so times are relative to that entry in that case. */
+
+static t_int64 _sim_evq_base_time (void)
+{
+t_int64 now = sim_time + (sim_interval_base - sim_interval);
+
+if ((sim_evq_count > 0) && (sim_evq[0].due < now))
+    return sim_evq[0].due;
+return now;
+}
+
 t_stat sim_process_event (void)
 {
 UNIT *uptr;
 t_stat reason, bare_reason;
-int32 sim_interval_catchup;
+t_int64 now, limit;
 
 if (stop_cpu) {                                         /* stop CPU? */
     stop_cpu = 0;
@@ -11411,42 +12084,33 @@ if (sim_interval > 0) {
     return SCPE_OK;
     }
 if (sim_clock_queue == QUEUE_LIST_END) {                /* queue empty? */
-    sim_interval = noqueue_time = NOQUEUE_WAIT;         /* flag queue empty */
+    sim_interval = sim_interval_base = NOQUEUE_WAIT;    /* flag queue empty */
     sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Queue Empty New Interval = %d\n", sim_interval);
     return SCPE_OK;
     }
 sim_processing_event = TRUE;
 /* If sim_interval is negative, we've missed the opportunity to  */
 /* dispatch one or more events when they were scheduled to fire. */
-/* To accomodate this, we backup time to when the first event    */
-/* was supposed to fire and advance it from there until things   */
-/* have caught up.                                               */
+/* To accomodate this, each overdue event is dispatched with     */
+/* time backed up to when it was supposed to fire and time is    */
+/* then advanced from there until things have caught up.  As     */
+/* with the delta list this replaced, the instruction which      */
+/* overran the interval doesn't count towards catching up.       */
+now = limit = sim_time;
 if (sim_interval < 0) {
-    sim_interval_catchup = sim_interval;
-    sim_interval = 0;
-    UPDATE_SIM_TIME;                          /* update sim time */
-    sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "Processing event for %s with sim_interval = %d, event time = %.0f\n", 
-        sim_uname (sim_clock_queue), sim_interval_catchup, sim_gtime ());
-    if (sim_clock_queue->next != QUEUE_LIST_END)
-        sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "- Next event for %s after = %d\n", 
-            sim_uname (sim_clock_queue->next), sim_clock_queue->next->time);
-    sim_time -= sim_clock_queue->time;
-    sim_rtime -= sim_clock_queue->time;
+    limit -= 1;
+    sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "Processing event for %s with sim_interval = %d, event time = %" LL_FMT "d\n", 
+        sim_uname (sim_clock_queue), sim_interval, (LL_TYPE)sim_evq[0].due);
+    if (sim_evq_count > 1)
+        sim_debug (SIM_DBG_EVENT_NEG, &sim_scp_dev, "- %d events pending\n", sim_evq_count - 1);
     }
-else
-    sim_interval_catchup = 0;
 do {
-    uptr = sim_clock_queue;                             /* get first */
-    sim_clock_queue = uptr->next;                       /* remove first */
+    uptr = sim_evq[0].uptr;                             /* get first */
+    sim_time = sim_evq[0].due;                          /* time it was due */
+    _sim_evq_remove (0);                                /* remove first */
     uptr->next = NULL;                                  /* hygiene */
     uptr->time = 0;
-    if (sim_clock_queue != QUEUE_LIST_END) {
-        if (sim_interval_catchup < 0)
-            sim_interval = -sim_interval_catchup;
-        sim_interval += sim_interval_catchup + sim_clock_queue->time;
-        }
-    else
-        sim_interval = noqueue_time = NOQUEUE_WAIT;
+    _sim_evq_reload ();
     AIO_EVENT_BEGIN(uptr);
     if (uptr->usecs_remaining) {
         sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Requeueing %s after %.0f usecs\n", sim_uname (uptr), uptr->usecs_remaining);
@@ -11460,13 +12124,6 @@ do {
             reason = SCPE_OK;
         }
     AIO_EVENT_COMPLETE(uptr, reason);
-    if (sim_interval_catchup < -1) {
-        sim_interval_catchup += sim_clock_queue->time;
-        sim_time += sim_clock_queue->time;
-        sim_rtime += sim_clock_queue->time;
-        }
-    else
-        sim_interval_catchup = 0;
     bare_reason = SCPE_BARE_STATUS (reason);
     if ((bare_reason != SCPE_OK)      && /* Provide context for unexpected errors */
         (bare_reason >= SCPE_BASE)    &&
@@ -11478,15 +12135,17 @@ do {
         (bare_reason != SCPE_RUNTIME) && 
         (bare_reason != SCPE_EXIT))
         sim_messagef (reason, "\nUnexpected internal error while processing event for %s which returned %d - %s\n", sim_uname (uptr), reason, sim_error_text (reason));
+    UPDATE_SIM_TIME;                                    /* account for forced advance */
     } while ((reason == SCPE_OK) && 
-             ((sim_interval + sim_interval_catchup) <= 0) && 
-             (sim_clock_queue != QUEUE_LIST_END) &&
+             (sim_evq_count > 0) &&
+             (sim_evq[0].due <= limit) &&
              (!stop_cpu));
 
-if (sim_clock_queue == QUEUE_LIST_END) {                /* queue empty? */
-    sim_interval = noqueue_time = NOQUEUE_WAIT;         /* flag queue empty */
+if (sim_time < now)                                     /* caught up? */
+    sim_time = now;
+_sim_evq_reload ();
+if (sim_clock_queue == QUEUE_LIST_END)                  /* queue empty? */
     sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Processing Queue Complete New Interval = %d\n", sim_interval);
-    }
 else
     sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Processing Queue Complete New Interval = %d(%s)\n", sim_interval, sim_uname(sim_clock_queue));
 
@@ -11516,36 +12175,31 @@ return _sim_activate (uptr, event_time);
 
 t_stat _sim_activate (UNIT *uptr, int32 event_time)
 {
-UNIT *cptr, *prvptr;
-int32 accum;
+SIM_EVENT *ev;
 
 AIO_ACTIVATE (_sim_activate, uptr, event_time);
 if (sim_is_active (uptr))                               /* already active? */
     return SCPE_OK;
+if (sim_evq_count == sim_evq_size) {                    /* heap full? */
+    int32 size = sim_evq_size ? 2 * sim_evq_size : SIM_EVQ_INILNT;
+    SIM_EVENT *evq = (SIM_EVENT *)realloc (sim_evq, size * sizeof (*evq));
+
+    if (evq == NULL)
+        return SCPE_MEM;
+    sim_evq = evq;
+    sim_evq_size = size;
+    }
 UPDATE_SIM_TIME;                                        /* update sim time */
 
 sim_debug (SIM_DBG_ACTIVATE, &sim_scp_dev, "Activating %s delay=%d\n", sim_uname (uptr), event_time);
 
-prvptr = NULL;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (event_time < (accum + cptr->time))
-        break;
-    accum = accum + cptr->time;
-    prvptr = cptr;
-    }
-if (prvptr == NULL) {                                   /* insert at head */
-    cptr = uptr->next = sim_clock_queue;
-    sim_clock_queue = uptr;
-    }
-else {
-    cptr = uptr->next = prvptr->next;                   /* insert at prvptr */
-    prvptr->next = uptr;
-    }
-uptr->time = event_time - accum;
-if (cptr != QUEUE_LIST_END)
-    cptr->time = cptr->time - uptr->time;
-sim_interval = sim_clock_queue->time;
+ev = &sim_evq[sim_evq_count++];
+ev->due = sim_time + event_time;
+ev->seq = sim_evq_seq++;
+ev->uptr = uptr;
+uptr->next = QUEUE_LIST_END;                            /* mark as queued */
+_sim_evq_up (sim_evq_count - 1);
+_sim_evq_reload ();
 return SCPE_OK;
 }
 
@@ -11644,7 +12298,7 @@ return sim_timer_activate_after (uptr, usec_delay);
 
 t_stat sim_cancel (UNIT *uptr)
 {
-UNIT *cptr, *nptr;
+int32 i;
 
 AIO_VALIDATE(uptr);
 if ((uptr->cancel) && uptr->cancel (uptr))
@@ -11659,30 +12313,15 @@ if (!sim_is_active (uptr))
     return SCPE_OK;
 UPDATE_SIM_TIME;                                        /* update sim time */
 sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Canceling Event for %s\n", sim_uname(uptr));
-nptr = QUEUE_LIST_END;
-
-if (sim_clock_queue == uptr) {
-    nptr = sim_clock_queue = uptr->next;
+i = _sim_evq_find (uptr);
+if (i >= 0) {
+    _sim_evq_remove (i);
     uptr->next = NULL;                                  /* hygiene */
     }
-else {
-    for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-        if (cptr->next == uptr) {
-            nptr = cptr->next = uptr->next;
-            uptr->next = NULL;                          /* hygiene */
-            break;                                      /* end queue scan */
-            }
-        }
-    }
-if (nptr != QUEUE_LIST_END)
-    nptr->time += (uptr->next) ? 0 : uptr->time;
 if (!uptr->next)
     uptr->time = 0;
 uptr->usecs_remaining = 0;
-if (sim_clock_queue != QUEUE_LIST_END)
-    sim_interval = sim_clock_queue->time;
-else
-    sim_interval = noqueue_time = NOQUEUE_WAIT;
+_sim_evq_reload ();
 if (uptr->next) {
     sim_printf ("Cancel failed for %s\n", sim_uname(uptr));
     if (sim_deb)
@@ -11717,21 +12356,11 @@ return (((uptr->next) || AIO_IS_ACTIVE(uptr) || ((uptr->dynflags & UNIT_TMR_UNIT
 
 int32 _sim_activate_queue_time (UNIT *uptr)
 {
-UNIT *cptr;
-int32 accum;
+int32 i = _sim_evq_find (uptr);
 
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return accum + 1;
-    }
-return 0;
+if (i < 0)
+    return 0;
+return (int32)(sim_evq[i].due - _sim_evq_base_time ()) + 1;
 }
 
 int32 _sim_activate_time (UNIT *uptr)
@@ -11756,7 +12385,6 @@ return _sim_activate_time (uptr);
 
 double sim_activate_time_usecs (UNIT *uptr)
 {
-UNIT *cptr;
 int32 accum;
 double result;
 
@@ -11764,20 +12392,32 @@ AIO_VALIDATE(uptr);
 result = sim_timer_activate_time_usecs (uptr);
 if (result >= 0)
     return result;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return 1.0 + uptr->usecs_remaining + ((1000000.0 * accum) / sim_timer_inst_per_sec ());
-    }
+accum = _sim_activate_queue_time (uptr);
+if (accum)
+    return uptr->usecs_remaining + ((1000000.0 * (accum - 1)) / sim_timer_inst_per_sec ()) + 1.0;
 return 0.0;
 }
 
+/* sim_atime - return absolute activation time
+
+   Inputs:
+        uptr    =       pointer to unit
+   Outputs:
+        result =        global time at which the unit's event is due,
+                        -1 if the unit isn't on the event queue
+*/
+
+double sim_atime (UNIT *uptr)
+{
+int32 i;
+
+AIO_VALIDATE(uptr);
+i = _sim_evq_find (uptr);
+if (i < 0)
+    return -1.0;
+return (double)sim_evq[i].due;
+}
+
 /* sim_gtime - return global time
    sim_grtime - return global time with rollover
 
@@ -11791,13 +12431,13 @@ double sim_gtime (void)
 if (AIO_MAIN_THREAD) {
     UPDATE_SIM_TIME;
     }
-return sim_time;
+return (double)sim_time;
 }
 
 uint32 sim_grtime (void)
 {
 UPDATE_SIM_TIME;
-return sim_rtime;
+return (uint32)sim_time;
 }
 
 /* sim_qcount - return queue entry count
@@ -11809,13 +12449,7 @@ return sim_rtime;
 
 int32 sim_qcount (void)
 {
-int32 cnt;
-UNIT *uptr;
-
-cnt = 0;
-for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next)
-    cnt++;
-return cnt;
+return sim_evq_count;
 }
 
 /* Breakpoint package.  This module replaces the VM-implemented one
@@ -11846,6 +12480,8 @@ return cnt;
         sim_brk_show            show breakpoint
         sim_brk_showall         show all breakpoints
         sim_brk_test            test for breakpoint
+        sim_brk_watch_init      register a page watch map
+        sim_brk_watch_done      unregister a page watch map
         sim_brk_npc             PC has been changed
         sim_brk_getact          get next action
         sim_brk_clract          clear pending actions
@@ -11874,12 +12510,84 @@ sim_brk_tab = (BRKTAB **) realloc (sim_brk_tab, sim_brk_lnt*sizeof (BRKTAB*));
 if (sim_brk_tab == NULL)
     return SCPE_MEM;
 memset (sim_brk_tab, 0, sim_brk_lnt*sizeof (BRKTAB*));
+memset (sim_brk_map, 0, sizeof (sim_brk_map));
 sim_brk_ent = sim_brk_ins = 0;
+sim_brk_watch_update ();
 sim_brk_clract ();
 sim_brk_npc (0);
 return SCPE_OK;
 }
 
+/* Page watch maps
+
+   sim_brk_watch_init registers (or re-registers) a map covering an address
+   space of awidth bits in pages of 2**shift addresses, tracking breakpoints
+   of the types in btyp.  The maps are kept in step with the breakpoint
+   table by sim_brk_new (which adds bits) and sim_brk_clr (which rebuilds
+   them, since a page may still hold other breakpoints).
+*/
+
+static void sim_brk_watch_mark (t_addr loc, uint32 btyp)
+{
+BRKWATCH *wp;
+
+for (wp = sim_brk_watch_list; wp != NULL; wp = wp->next)
+    if (btyp & wp->typ)
+        wp->map[SIM_BRK_WPAGE (wp, loc) >> 5] |= (1u << (SIM_BRK_WPAGE (wp, loc) & 31));
+}
+
+static void sim_brk_watch_update (void)
+{
+BRKWATCH *wp;
+int32 i;
+
+for (wp = sim_brk_watch_list; wp != NULL; wp = wp->next)
+    memset (wp->map, 0, ((wp->mask >> 5) + 1) * sizeof (*wp->map));
+for (i = 0; i < sim_brk_ent; i++) {
+    BRKTAB *bp;
+
+    for (bp = sim_brk_tab[i]; bp != NULL; bp = bp->next)
+        sim_brk_watch_mark (bp->addr, bp->typ);
+    }
+}
+
+t_stat sim_brk_watch_init (BRKWATCH *wp, uint32 btyp, uint32 awidth, uint32 shift)
+{
+uint32 pages = (awidth > shift) ? (awidth - shift) : 0;
+uint32 *map;
+
+if (pages > 30)                                         /* limit map size */
+    return SCPE_ARG;
+pages = 1u << pages;
+map = (uint32 *) calloc ((pages + 31) >> 5, sizeof (*map));
+if (map == NULL)
+    return SCPE_MEM;
+sim_brk_watch_done (wp);                                /* drop any prior registration */
+wp->typ = btyp;
+wp->shift = shift;
+wp->mask = pages - 1;
+wp->map = map;
+wp->next = sim_brk_watch_list;
+sim_brk_watch_list = wp;
+sim_brk_watch_update ();
+return SCPE_OK;
+}
+
+void sim_brk_watch_done (BRKWATCH *wp)
+{
+BRKWATCH **wpp;
+
+for (wpp = &sim_brk_watch_list; *wpp != NULL; wpp = &(*wpp)->next) {
+    if (*wpp == wp) {
+        *wpp = wp->next;
+        break;
+        }
+    }
+free (wp->map);
+wp->map = NULL;
+wp->next = NULL;
+}
+
 /* Search for a breakpoint in the sorted breakpoint table */
 
 BRKTAB *sim_brk_fnd (t_addr loc)
@@ -11962,6 +12670,9 @@ bp->addr = loc;
 bp->typ = btyp;
 bp->cnt = 0;
 bp->act = NULL;
+i = SIM_BRK_MAP_IDX (loc);                              /* mark address in filter */
+sim_brk_map[i >> 5] |= (1u << (i & 31));
+sim_brk_watch_mark (loc, btyp);                         /* and in page watch maps */
 for (i = 0; i < SIM_BKPT_N_SPC; i++)
     bp->time_fired[i] = -1.0;
 return bp;
@@ -12044,13 +12755,18 @@ if (sim_brk_tab[sim_brk_ins] == NULL) {                 /* erased entry */
         sim_brk_tab[i] = sim_brk_tab[i+1];
     }
 sim_brk_summ = 0;                                       /* recalc summary */
+memset (sim_brk_map, 0, sizeof (sim_brk_map));          /* and address filter */
 for (i = 0; i < sim_brk_ent; i++) {
+    uint32 idx = SIM_BRK_MAP_IDX (sim_brk_tab[i]->addr);
+
+    sim_brk_map[idx >> 5] |= (1u << (idx & 31));
     bp = sim_brk_tab[i];
     while (bp) {
         sim_brk_summ |= (bp->typ & ~BRK_TYP_TEMP);
         bp = bp->next;
         }
     }
+sim_brk_watch_update ();                                /* rebuild page watch maps */
 return SCPE_OK;
 }
 
@@ -12188,8 +12904,11 @@ return SCPE_OK;
 uint32 sim_brk_test (t_addr loc, uint32 btyp)
 {
 BRKTAB *bp;
-uint32 spc = (btyp >> SIM_BKPT_V_SPC) & (SIM_BKPT_N_SPC - 1);
+uint32 spc, idx = SIM_BRK_MAP_IDX (loc);
 
+if (!(sim_brk_map[idx >> 5] & (1u << (idx & 31))))      /* no breakpoint possible here? */
+    return 0;
+spc = (btyp >> SIM_BKPT_V_SPC) & (SIM_BKPT_N_SPC - 1);
 if (sim_brk_summ & BRK_TYP_DYN_ALL)
     btyp |= BRK_TYP_DYN_ALL;
 
@@ -15650,8 +16369,8 @@ sim_scp_dev.dctrl = 0xFFFFFFFF;
 /* reset queue */
 while (sim_clock_queue != QUEUE_LIST_END)
     sim_cancel (sim_clock_queue);
-sim_time = sim_rtime = 0;
-noqueue_time = sim_interval = 0;
+sim_time = 0;
+sim_interval_base = sim_interval = 0;
 
 /* queue test unit events */
 for (i = 0; i < dptr->numunits; i++) {
@@ -15732,6 +16451,205 @@ sim_set_deb_switches (start_deb_switches);
 return r;
 }
 
+/* Event queue performance with many pending events */
+
+#define SCP_BENCH_UNITS 10000
+
+static double bench_last_time;
+static int32 bench_last_seq;
+static int32 bench_dispatched;
+static int32 bench_errors;
+
+static t_stat sim_scp_bench_svc (UNIT *uptr)
+{
+double now = sim_gtime ();
+
+if ((now != (double)uptr->u3) ||                        /* fired at the wrong time? */
+    (now < bench_last_time) ||                          /* or out of order? */
+    ((now == bench_last_time) && (uptr->u4 < bench_last_seq)))
+    ++bench_errors;
+bench_last_time = now;
+bench_last_seq = uptr->u4;
+++bench_dispatched;
+return SCPE_OK;
+}
+
+static t_stat test_scp_event_performance (void)
+{
+UNIT *units = (UNIT *)calloc (SCP_BENCH_UNITS, sizeof (*units));
+uint32 i, seed = 1;
+int32 seq = 0;
+double start, t_activate, t_cancel, t_time, t_dispatch;
+t_stat r = SCPE_OK;
+
+if (units == NULL)
+    return SCPE_MEM;
+/* reset queue */
+while (sim_clock_queue != QUEUE_LIST_END)
+    sim_cancel (sim_clock_queue);
+sim_time = 0;
+sim_interval_base = sim_interval = 0;
+bench_last_time = 0.0;
+bench_last_seq = bench_dispatched = bench_errors = 0;
+
+for (i = 0; i < SCP_BENCH_UNITS; i++)
+    units[i].action = sim_scp_bench_svc;
+start = sim_timenow_double ();
+for (i = 0; i < SCP_BENCH_UNITS; i++) {
+    seed = seed * 1103515245 + 12345;
+    units[i].u3 = 1 + ((seed >> 16) % (SCP_BENCH_UNITS / 4));  /* plenty of equal times */
+    units[i].u4 = seq++;
+    sim_activate (&units[i], units[i].u3);
+    }
+t_activate = sim_timenow_double () - start;
+start = sim_timenow_double ();
+for (i = 0; i < SCP_BENCH_UNITS; i += 2)
+    sim_cancel (&units[i]);
+t_cancel = sim_timenow_double () - start;
+for (i = 0; i < SCP_BENCH_UNITS; i += 2) {
+    units[i].u4 = seq++;
+    sim_activate (&units[i], units[i].u3);
+    }
+if (sim_qcount () != SCP_BENCH_UNITS)
+    r = sim_messagef (SCPE_IERR, "unexpected event queue count %d - expected %d\n", sim_qcount (), SCP_BENCH_UNITS);
+start = sim_timenow_double ();
+for (i = 0; (r == SCPE_OK) && (i < SCP_BENCH_UNITS); i++) {
+    int32 t = sim_activate_time (&units[i]);
+
+    if (t != units[i].u3 + 1)
+        r = sim_messagef (SCPE_IERR, "sim_activate_time() unexpected result for unit %d: %d - expected %d\n", i, t, units[i].u3 + 1);
+    else if (sim_atime (&units[i]) != (double)units[i].u3)
+        r = sim_messagef (SCPE_IERR, "sim_atime() unexpected result for unit %d: %.0f - expected %d\n", i, sim_atime (&units[i]), units[i].u3);
+    }
+t_time = sim_timenow_double () - start;
+start = sim_timenow_double ();
+while ((r == SCPE_OK) && (sim_clock_queue != QUEUE_LIST_END)) {
+    sim_interval = 0;                                   /* advance to the next event */
+    r = sim_process_event ();
+    }
+t_dispatch = sim_timenow_double () - start;
+if ((r == SCPE_OK) && ((bench_dispatched != SCP_BENCH_UNITS) || (bench_errors != 0)))
+    r = sim_messagef (SCPE_IERR, "event dispatch: %d of %d events dispatched, %d out of order\n", bench_dispatched, SCP_BENCH_UNITS, bench_errors);
+if (r == SCPE_OK)
+    sim_printf ("Event queue with %d units: activate %.0f ns, cancel %.0f ns, activate_time %.0f ns, dispatch %.0f ns per event\n", SCP_BENCH_UNITS, 
+                (1.0e9 * t_activate) / SCP_BENCH_UNITS, (1.0e9 * t_cancel) / (SCP_BENCH_UNITS / 2), 
+                (1.0e9 * t_time) / SCP_BENCH_UNITS, (1.0e9 * t_dispatch) / SCP_BENCH_UNITS);
+while (sim_clock_queue != QUEUE_LIST_END)
+    sim_cancel (sim_clock_queue);
+sim_time = 0;
+sim_interval_base = sim_interval = 0;
+free (units);
+return r;
+}
+
+/* Breakpoint test overhead.  Time the instruction fetch breakpoint check
+   (as done by the CPU simulators: sim_brk_summ && sim_brk_test()) for a
+   stream of addresses without breakpoints, with differently sized
+   breakpoint tables loaded.  Also verify that set breakpoints are found. */
+
+#define SCP_BRK_BENCH_TESTS 2000000
+
+static t_stat test_scp_breakpoint_performance (void)
+{
+static const int32 counts[] = {0, 10, 1000};
+uint32 saved_types = sim_brk_types;
+uint32 saved_dflt = sim_brk_dflt;
+BRKWATCH watch;
+int32 c, i, hits;
+t_stat r = SCPE_OK;
+
+if (sim_brk_ent != 0) {
+    sim_printf ("Skipping breakpoint performance test - breakpoints are set\n");
+    return SCPE_OK;
+    }
+sim_brk_types = sim_brk_dflt = SWMASK ('E');
+memset (&watch, 0, sizeof (watch));
+r = sim_brk_watch_init (&watch, SWMASK ('E'), 24, 8);   /* 64K pages of 256 */
+if (r == SCPE_OK)
+    r = sim_brk_set (0x1234, SWMASK ('E'), 0, NULL);
+if ((r == SCPE_OK) && 
+    (!SIM_BRK_WATCHED (&watch, 0x1200) || !SIM_BRK_WATCHED (&watch, 0x12FF) ||
+      SIM_BRK_WATCHED (&watch, 0x11FF) ||  SIM_BRK_WATCHED (&watch, 0x1300)))
+    r = sim_messagef (SCPE_IERR, "breakpoint watch map: page not marked correctly\n");
+if (r == SCPE_OK) {
+    sim_brk_clr (0x1234, 0);
+    if (SIM_BRK_WATCHED (&watch, 0x1234))
+        r = sim_messagef (SCPE_IERR, "breakpoint watch map: page not cleared\n");
+    }
+sim_brk_watch_done (&watch);
+for (c = 0; (r == SCPE_OK) && (c < (int32)(sizeof (counts) / sizeof (counts[0]))); c++) {
+    double start, elapsed;
+
+    for (i = 0; (r == SCPE_OK) && (i < counts[c]); i++)     /* spread over memory */
+        r = sim_brk_set ((t_addr)(0x100000 + i * 0x1236), SWMASK ('E'), 0, NULL);
+    if (r != SCPE_OK)
+        break;
+    hits = 0;
+    start = sim_timenow_double ();
+    for (i = 0; i < SCP_BRK_BENCH_TESTS; i++) {
+        t_addr pc = (t_addr)(0x40000000 + ((i << 1) & 0xFFFFF));
+
+        if (sim_brk_summ && sim_brk_test (pc, SWMASK ('E')))
+            ++hits;
+        }
+    elapsed = sim_timenow_double () - start;
+    for (i = 0; i < counts[c]; i++)
+        if (!sim_brk_test ((t_addr)(0x100000 + i * 0x1236), SWMASK ('E')))
+            break;
+    if ((hits != 0) || (i != counts[c]))
+        r = sim_messagef (SCPE_IERR, "breakpoint test: %d false matches, %d of %d breakpoints found\n", hits, i, counts[c]);
+    else
+        sim_printf ("Breakpoint test with %d breakpoints: %.1f ns per instruction\n", counts[c], (1.0e9 * elapsed) / SCP_BRK_BENCH_TESTS);
+    sim_brk_clrall (0);
+    }
+sim_brk_clrall (0);
+sim_brk_clract ();
+sim_brk_types = saved_types;
+sim_brk_dflt = saved_dflt;
+return r;
+}
+
+static t_stat test_scp_save_compression (void)
+{
+static const size_t sizes[] = {0, 3, 4, 100, 8192};
+uint8 *in = (uint8 *)malloc (8192);
+uint8 *cmp = (uint8 *)malloc (8192);
+uint8 *out = (uint8 *)malloc (8192);
+size_t s, i, clen;
+t_stat r = SCPE_OK;
+
+if ((in == NULL) || (cmp == NULL) || (out == NULL)) {
+    free (in);
+    free (cmp);
+    free (out);
+    return SCPE_MEM;
+    }
+for (s = 0; (r == SCPE_OK) && (s < sizeof (sizes) / sizeof (sizes[0])); s++) {
+    int pattern;
+
+    for (pattern = 0; (r == SCPE_OK) && (pattern < 3); pattern++) {
+        for (i = 0; i < sizes[s]; i++)                  /* repeating, text-like, noise */
+            in[i] = (uint8)((pattern == 0) ? (i & 7) : 
+                            (pattern == 1) ? ("MOVL R0,R1\r\n"[i % 12] + (i / 997)) :
+                                             ((i * 2654435761u) >> 13));
+        clen = sim_save_compress (in, sizes[s], cmp);
+        if (clen == 0)                                  /* incompressible is fine */
+            continue;
+        memset (out, 0xA5, sizes[s]);
+        if ((clen >= sizes[s]) || 
+            !sim_save_expand (cmp, clen, out, sizes[s]) ||
+            (memcmp (in, out, sizes[s]) != 0))
+            r = sim_messagef (SCPE_IERR, "SAVE compression round trip failed for %d bytes of pattern %d\n", (int)sizes[s], pattern);
+        else if ((sizes[s] > 1) && sim_save_expand (cmp, clen - 1, out, sizes[s]))
+            r = sim_messagef (SCPE_IERR, "SAVE expansion accepted truncated data\n");
+        }
+    }
+free (in);
+free (cmp);
+free (out);
+return r;
+}
+
 /*
  * Compiled in unit tests for the various device oriented library 
  * modules: sim_card, sim_disk, sim_tape, sim_ether, sim_tmxr, etc.
@@ -15747,7 +16665,7 @@ char gbuf[CBUFSIZE];
 
 GET_SWITCHES (cptr);                        /* get switches */
 saved_switches |= sim_switches;
-if (sim_time != 0.0)
+if (sim_time != 0)
     return sim_messagef (SCPE_UNK, "Library tests can not be performed after instructions have been executed.\n");
 sim_switches = 0;
 detach_all (0, 0);                          /* Assure that all units are unattached */
@@ -15769,6 +16687,12 @@ if (sim_switches & SWMASK ('D')) {
     }
 if (test_scp_event_sequencing () != SCPE_OK)
     return sim_messagef (SCPE_IERR, "SCP event sequencing test failed\n");
+if (test_scp_event_performance () != SCPE_OK)
+    return sim_messagef (SCPE_IERR, "SCP event queue performance test failed\n");
+if (test_scp_breakpoint_performance () != SCPE_OK)
+    return sim_messagef (SCPE_IERR, "SCP breakpoint performance test failed\n");
+if (test_scp_save_compression () != SCPE_OK)
+    return sim_messagef (SCPE_IERR, "SCP SAVE compression test failed\n");
 for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
     t_stat tstat = SCPE_OK;
     t_bool was_disabled = ((dptr->flags & DEV_DIS) != 0);
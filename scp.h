@@ -148,6 +148,7 @@ int32 sim_activate_time (UNIT *uptr);
 int32 _sim_activate_queue_time (UNIT *uptr);
 int32 _sim_activate_time (UNIT *uptr);
 double sim_activate_time_usecs (UNIT *uptr);
+double sim_atime (UNIT *uptr);
 t_stat sim_run_boot_prep (int32 flag);
 double sim_gtime (void);
 uint32 sim_grtime (void);
@@ -218,6 +219,8 @@ t_stat get_aval (t_addr addr, DEVICE *dptr, UNIT *uptr);
 t_value get_rval (REG *rptr, uint32 idx);
 BRKTAB *sim_brk_fnd (t_addr loc);
 uint32 sim_brk_test (t_addr bloc, uint32 btyp);
+t_stat sim_brk_watch_init (BRKWATCH *wp, uint32 btyp, uint32 awidth, uint32 shift);
+void sim_brk_watch_done (BRKWATCH *wp);
 void sim_brk_clrspc (uint32 spc, uint32 btyp);
 void sim_brk_npc (uint32 cnt);
 void sim_brk_setact (const char *action);
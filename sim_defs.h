@@ -472,6 +472,7 @@ typedef struct MTAB MTAB;
 typedef struct SCHTAB SCHTAB;
 typedef struct BRKTAB BRKTAB;
 typedef struct BRKTYPTAB BRKTYPTAB;
+typedef struct BRKWATCH BRKWATCH;
 typedef struct EXPTAB EXPTAB;
 typedef struct EXPECT EXPECT;
 typedef struct SEND SEND;
@@ -605,6 +606,7 @@ struct UNIT {
     char                *uname;                         /* Unit name */
     DEVICE              *dptr;                          /* DEVICE linkage (backpointer) */
     uint32              dctrl;                          /* debug control */
+    uint32              evq_slot;                       /* event queue slot + 1 (0 if not queued) */
 #ifdef SIM_ASYNCH_IO
     void                (*a_check_completion)(UNIT *);
     t_bool              (*a_is_active)(UNIT *);
@@ -812,6 +814,24 @@ struct BRKTYPTAB {
     };
 #define BRKTYPE(typ,descrip) {SWMASK(typ), descrip}
 
+/* Breakpoint watch map
+
+   A simulator registers one of these per address space (virtual, physical)
+   with sim_brk_watch_init.  SCP keeps one bit per page set for every page
+   holding a breakpoint of the mapped types, so a memory access routine can
+   skip sim_brk_test for all unwatched pages with a single bit test.
+   Addresses beyond the mapped width alias (harmlessly) into the map. */
+
+struct BRKWATCH {
+    uint32              typ;                            /* breakpoint types mapped */
+    uint32              shift;                          /* log2 page size */
+    uint32              mask;                           /* page number mask */
+    uint32              *map;                           /* page bitmap */
+    BRKWATCH            *next;                          /* next registered map */
+    };
+#define SIM_BRK_WPAGE(wp,a)    (((uint32)((a) >> (wp)->shift)) & (wp)->mask)
+#define SIM_BRK_WATCHED(wp,a)  ((wp)->map[SIM_BRK_WPAGE (wp, a) >> 5] & (1u << (SIM_BRK_WPAGE (wp, a) & 31)))
+
 /* Expect rule */
 
 struct EXPTAB {
@@ -52,6 +52,10 @@ Public routines:
    sim_disk_set_async        enable asynchronous operation
    sim_disk_clr_async        disable asynchronous operation
    sim_disk_data_trace       debug support
+   sim_disk_flush            write cached data to the container
+   sim_disk_set_cache        configure the disk block cache
+   sim_disk_show_cache       show disk block cache statistics
+   sim_disk_show_disk        show attached disk container space usage
    sim_disk_test             unit test routine
 
 Internal routines:
@@ -85,6 +89,9 @@ Internal routines:
 #if defined SIM_ASYNCH_IO
 #include <pthread.h>
 #endif
+#if defined (__linux) || defined (__linux__)
+#include <fcntl.h>                                      /* fallocate () */
+#endif
 
 /* Newly created SIMH (and possibly RAW) disk containers       */
 /* will have this data as the last 512 bytes of the container  */
@@ -157,6 +164,13 @@ struct disk_context {
     uint32              is_cdrom;           /* Host system CDROM Device */
     uint32              media_removed;      /* Media not available flag */
     uint32              auto_format;        /* Format determined dynamically */
+    uint32              cache_spl;          /* Sectors per block cache line (0 = not cached) */
+    uint32              no_holes;           /* Container can't have holes punched in it */
+    struct disk_snapshot
+                        *snap;              /* Snapshot overlay (NULL if none) */
+    SHMEM               *map;               /* Read only container mapping (NULL if none) */
+    const uint8         *map_base;          /* Mapped container contents */
+    t_offset            map_size;           /* Mapped container size */
     struct simh_disk_footer
                         *footer;
 #if defined _WIN32
@@ -171,6 +185,29 @@ struct disk_context {
     pthread_cond_t      io_cond;
     pthread_cond_t      io_done;
     pthread_cond_t      startup_cond;
+    struct disk_req     *io_pend;           /* requests waiting for the I/O thread */
+    struct disk_req     *io_pend_tail;
+    struct disk_req     *io_cmpl;           /* completed, awaiting callback dispatch */
+    struct disk_req     *io_cmpl_tail;
+    struct disk_req     *io_free;           /* spare request blocks */
+    uint32              io_count;           /* requests submitted and not dispatched */
+    uint32              io_busy;            /* I/O thread is working on a request */
+#endif
+    };
+
+#if defined SIM_ASYNCH_IO
+/* Asynchronous request block
+
+   Each unit has a FIFO of pending requests which its I/O thread works
+   through in order, so any number of requests may be outstanding on a
+   unit.  Finished requests move to a completion list; the unit is only
+   activated when that list goes from empty to non-empty, and a single
+   dispatch then delivers every completion that has accumulated.
+   Callbacks for a unit are made in the order the requests were issued.
+*/
+
+struct disk_req {
+    struct disk_req     *next;
     int                 io_dop;
     uint8               *buf;
     t_seccnt            *rsects;
@@ -178,8 +215,8 @@ struct disk_context {
     t_lba               lba;
     DISK_PCALLBACK      callback;
     t_stat              io_status;
-#endif
     };
+#endif
 
 #define disk_ctx up8                        /* Field in Unit structure which points to the disk_context */
 
@@ -190,27 +227,8 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;   \
 if ((!callback) || !ctx->asynch_io)
 
 #define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback)   \
-    if (ctx->asynch_io) {                                       \
-        struct disk_context *ctx =                              \
-                      (struct disk_context *)uptr->disk_ctx;    \
-                                                                \
-        pthread_mutex_lock (&ctx->io_lock);                     \
-                                                                \
-        sim_debug_unit (ctx->dbit, uptr,                        \
-      "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d)\n",\
-                op, (int)(uptr - ctx->dptr->units), _lba, _sects);\
-                                                                \
-        if (ctx->callback)                                      \
-            abort(); /* horrible mistake, stop */               \
-        ctx->io_dop = op;                                       \
-        ctx->lba = _lba;                                        \
-        ctx->buf = _buf;                                        \
-        ctx->sects = _sects;                                    \
-        ctx->rsects = _rsects;                                  \
-        ctx->callback = _callback;                              \
-        pthread_cond_signal (&ctx->io_cond);                    \
-        pthread_mutex_unlock (&ctx->io_lock);                   \
-        }                                                       \
+    if (ctx->asynch_io)                                         \
+        _disk_queue (uptr, op, _lba, _buf, _rsects, _sects, _callback);\
     else                                                        \
         if (_callback)                                          \
             (_callback) (uptr, r);
@@ -221,6 +239,40 @@ if ((!callback) || !ctx->asynch_io)
 #define DOP_WSEC  2             /* sim_disk_wrsect_a */
 #define DOP_IAVL  3             /* sim_disk_isavailable_a */
 
+/* Queue a request for the unit's I/O thread */
+
+static void _disk_queue (UNIT *uptr, int op, t_lba lba, uint8 *buf, t_seccnt *rsects, t_seccnt sects, DISK_PCALLBACK callback)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_req *req;
+
+pthread_mutex_lock (&ctx->io_lock);
+sim_debug_unit (ctx->dbit, uptr, "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d, queued=%d)\n",
+                op, (int)(uptr - ctx->dptr->units), lba, sects, ctx->io_count);
+if ((req = ctx->io_free))
+    ctx->io_free = req->next;
+else
+    req = (struct disk_req *)malloc (sizeof (*req));
+if (req == NULL)
+    abort ();                                           /* can't continue, stop */
+req->next = NULL;
+req->io_dop = op;
+req->lba = lba;
+req->buf = buf;
+req->sects = sects;
+req->rsects = rsects;
+req->callback = callback;
+req->io_status = SCPE_OK;
+if (ctx->io_pend)
+    ctx->io_pend_tail->next = req;
+else
+    ctx->io_pend = req;
+ctx->io_pend_tail = req;
+++ctx->io_count;
+pthread_cond_signal (&ctx->io_cond);
+pthread_mutex_unlock (&ctx->io_lock);
+}
+
 static void *
 _disk_io(void *arg)
 {
@@ -236,26 +288,38 @@ sim_debug_unit (ctx->dbit, uptr, "_disk_io(unit=%d) starting\n", (int)(uptr - ct
 
 pthread_mutex_lock (&ctx->io_lock);
 pthread_cond_signal (&ctx->startup_cond);   /* Signal we're ready to go */
-while (ctx->asynch_io) {
-    pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
-    if (ctx->io_dop == DOP_DONE)
-        break;
+while (ctx->asynch_io || ctx->io_pend) {            /* drain queue before exit */
+    struct disk_req *req = ctx->io_pend;
+
+    if (req == NULL) {
+        pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
+        continue;
+        }
+    ctx->io_pend = req->next;
+    ctx->io_busy = 1;
     pthread_mutex_unlock (&ctx->io_lock);
-    switch (ctx->io_dop) {
+    switch (req->io_dop) {
         case DOP_RSEC:
-            ctx->io_status = sim_disk_rdsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+            req->io_status = sim_disk_rdsect (uptr, req->lba, req->buf, req->rsects, req->sects);
             break;
         case DOP_WSEC:
-            ctx->io_status = sim_disk_wrsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+            req->io_status = sim_disk_wrsect (uptr, req->lba, req->buf, req->rsects, req->sects);
             break;
         case DOP_IAVL:
-            ctx->io_status = sim_disk_isavailable (uptr);
+            req->io_status = sim_disk_isavailable (uptr);
             break;
         }
     pthread_mutex_lock (&ctx->io_lock);
-    ctx->io_dop = DOP_DONE;
+    ctx->io_busy = 0;
+    req->next = NULL;
+    if (ctx->io_cmpl)                               /* dispatch already pending? */
+        ctx->io_cmpl_tail->next = req;
+    else {
+        ctx->io_cmpl = req;
+        sim_activate (uptr, ctx->asynch_io_latency);
+        }
+    ctx->io_cmpl_tail = req;
     pthread_cond_signal (&ctx->io_done);
-    sim_activate (uptr, ctx->asynch_io_latency);
     }
 pthread_mutex_unlock (&ctx->io_lock);
 
@@ -270,24 +334,40 @@ return NULL;
    routine is to put the unit in proper condition to digest what may have
    occurred in the asynchrconous thread.
   
-   Since disk processing only handles a single I/O at a time to a
-   particular disk device (due to using stdio for the SimH Disk format
-   and stdio doesn't have an atomic seek+(read|write) operation),
-   we have the opportunity to possibly detect improper attempts to
-   issue multiple concurrent I/O requests. */
+   Disk processing only handles a single I/O at a time to a particular
+   disk device (due to using stdio for the SimH Disk format and stdio
+   doesn't have an atomic seek+(read|write) operation), so requests are
+   performed in order by the unit's I/O thread.  Every request which has
+   completed since the last dispatch is delivered here, in issue order. */
 static void _disk_completion_dispatch (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-DISK_PCALLBACK callback = ctx->callback;
+struct disk_req *req, *done;
 
-sim_debug_unit (ctx->dbit, uptr, "_disk_completion_dispatch(unit=%d, dop=%d, callback=%p)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop, (void *)(ctx->callback));
+if (ctx == NULL)                                        /* detached meanwhile? */
+    return;
+if (ctx->asynch_io)
+    pthread_mutex_lock (&ctx->io_lock);
+done = ctx->io_cmpl;                                    /* take whole batch */
+ctx->io_cmpl = NULL;
+if (ctx->asynch_io)
+    pthread_mutex_unlock (&ctx->io_lock);
 
-if (ctx->io_dop != DOP_DONE)
-    abort();                                            /* horribly wrong, stop */
+while ((req = done)) {
+    DISK_PCALLBACK callback = req->callback;
+    t_stat status = req->io_status;
 
-if (ctx->callback && ctx->io_dop == DOP_DONE) {
-    ctx->callback = NULL;
-    callback (uptr, ctx->io_status);
+    sim_debug_unit (ctx->dbit, uptr, "_disk_completion_dispatch(unit=%d, dop=%d, callback=%p)\n", (int)(uptr - ctx->dptr->units), req->io_dop, (void *)callback);
+    done = req->next;
+    if (ctx->asynch_io)
+        pthread_mutex_lock (&ctx->io_lock);
+    req->next = ctx->io_free;                           /* recycle block */
+    ctx->io_free = req;
+    --ctx->io_count;
+    if (ctx->asynch_io)
+        pthread_mutex_unlock (&ctx->io_lock);
+    if (callback)
+        callback (uptr, status);
     }
 }
 
@@ -296,8 +376,8 @@ static t_bool _disk_is_active (UNIT *uptr)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug_unit (ctx->dbit, uptr, "_disk_is_active(unit=%d, dop=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop);
-    return (ctx->io_dop != DOP_DONE);
+    sim_debug_unit (ctx->dbit, uptr, "_disk_is_active(unit=%d, outstanding=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_count);
+    return (ctx->io_count != 0);
     }
 return FALSE;
 }
@@ -307,16 +387,34 @@ static t_bool _disk_cancel (UNIT *uptr)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug_unit (ctx->dbit, uptr, "_disk_cancel(unit=%d, dop=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop);
+    sim_debug_unit (ctx->dbit, uptr, "_disk_cancel(unit=%d, outstanding=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_count);
     if (ctx->asynch_io) {
         pthread_mutex_lock (&ctx->io_lock);
-        while (ctx->io_dop != DOP_DONE)
+        while (ctx->io_pend || ctx->io_busy)
             pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
         pthread_mutex_unlock (&ctx->io_lock);
         }
     }
 return FALSE;
 }
+
+/* Release request blocks when the unit is detached (the I/O thread has
+   exited); completions not yet dispatched are discarded */
+
+static void _disk_free_reqs (struct disk_context *ctx)
+{
+struct disk_req *req;
+
+while ((req = ctx->io_cmpl)) {
+    ctx->io_cmpl = req->next;
+    free (req);
+    }
+while ((req = ctx->io_free)) {
+    ctx->io_free = req->next;
+    free (req);
+    }
+ctx->io_count = 0;
+}
 #else
 #define AIO_CALLSETUP
 #define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback)   \
@@ -600,6 +698,84 @@ return SCPE_OK;
 #endif
 }
 
+/* Memory mapped read only containers
+
+   SIMH and RAW format containers attached read only (including the base
+   of a snapshot overlay) are mapped into memory when the host supports
+   it (SET DISKS MMAP, the default) and reads are then just a copy from
+   the mapping.  Every simulator attaching the same container shares the
+   host's page cache copy of it, so mapped units don't use the disk block
+   cache either.  Removable media isn't mapped since it may change.
+ */
+
+static t_bool disk_mmap = TRUE;
+
+static void _sim_disk_map (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset size;
+const void *addr;
+
+if (!disk_mmap || !(uptr->flags & UNIT_RO) || ctx->removable)
+    return;
+switch (DK_GET_FMT (uptr)) {                            /* case on format */
+    case DKUF_F_STD:                                    /* SIMH format */
+        size = sim_fsize_ex (uptr->fileref);
+        break;
+    case DKUF_F_RAW:                                    /* Raw Physical Disk Access */
+        size = sim_os_disk_size_raw (uptr->fileref);
+        break;
+    default:
+        return;
+    }
+if ((size == (t_offset)-1) ||
+    (sim_memmap_open_ro (uptr->filename, size, &ctx->map, &addr) != SCPE_OK))
+    return;
+ctx->map_base = (const uint8 *)addr;
+ctx->map_size = size;
+sim_debug_unit (ctx->dbit, uptr, "_sim_disk_map(unit=%d) %u MB mapped\n", (int)(uptr - ctx->dptr->units), (uint32)(size >> 20));
+}
+
+static void _sim_disk_unmap (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+sim_shmem_close (ctx->map);
+ctx->map = NULL;
+ctx->map_base = NULL;
+ctx->map_size = 0;
+}
+
+/* Read sectors from a mapped container.  Data beyond the end of the
+   container reads as zeros and is counted as read for RAW containers
+   but not for SIMH containers, just as it is without the mapping. */
+
+static t_stat _sim_disk_rdsect_map (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset da = ((t_offset)lba) * ctx->sector_size;
+size_t tbc = ((size_t)sects) * ctx->sector_size;
+size_t avail = 0;
+
+if (da < ctx->map_size) {
+    avail = ((ctx->map_size - da) < (t_offset)tbc) ? (size_t)(ctx->map_size - da) : tbc;
+    avail -= avail % ctx->xfer_element_size;
+    sim_buf_copy_swapped (buf, ctx->map_base + da, ctx->xfer_element_size, avail / ctx->xfer_element_size);
+    }
+memset (buf + avail, 0, tbc - avail);
+if (sectsread) {
+    if (DK_GET_FMT (uptr) != DKUF_F_RAW)                /* SIMH: partial sector counts, as fread */
+        *sectsread = (t_seccnt)((avail + ctx->sector_size - 1) / ctx->sector_size);
+    else if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||
+             ((0 == (da & (ctx->storage_sector_size - 1))) &&
+              (0 == (tbc & (ctx->storage_sector_size - 1)))))
+        *sectsread = sects;                             /* RAW sector I/O zero fills past EOF */
+    else                                                /* RAW partial I/O: whole sectors present */
+        *sectsread = (t_seccnt)(avail / ctx->sector_size);
+    }
+return SCPE_OK;
+}
+
 /* Read Sectors */
 
 static t_stat _sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
@@ -641,7 +817,7 @@ while (tbc) {
 return SCPE_OK;
 }
 
-t_stat sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+static t_stat _sim_disk_rdsect_fmt (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
 {
 t_stat r;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
@@ -658,6 +834,9 @@ if ((sects == 1) &&                                     /* Single sector reads *
     return SCPE_OK;                                     /* return success */
     }
 
+if (ctx->map_base)                                      /* memory mapped container? */
+    return _sim_disk_rdsect_map (uptr, lba, buf, sectsread, sects);
+
 if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
     ((0 == ((lba*ctx->sector_size) & (ctx->storage_sector_size - 1))) &&
      (0 == ((sects*ctx->sector_size) & (ctx->storage_sector_size - 1)))) ||
@@ -699,145 +878,1228 @@ else { /* Unaligned and/or partial sector transfers in RAW mode */
         if (*sectsread > sects)
             *sectsread = sects;
         }
-    free (tbuf);
+    free (tbuf);
+    return r;
+    }
+}
+
+/* Write Sectors */
+
+static t_stat _sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+t_offset da;
+uint32 err, tbc;
+size_t i;
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+sim_debug_unit (ctx->dbit, uptr, "_sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
+
+da = ((t_offset)lba) * ctx->sector_size;
+tbc = sects * ctx->sector_size;
+if (sectswritten)
+    *sectswritten = 0;
+err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
+if (err)
+    return SCPE_IOERR;
+i = sim_fwrite (buf, ctx->xfer_element_size, tbc/ctx->xfer_element_size, uptr->fileref);
+if (sectswritten)
+    *sectswritten += (t_seccnt)((i * ctx->xfer_element_size + ctx->sector_size - 1)/ctx->sector_size);
+err = ferror (uptr->fileref);
+if (err)
+    return SCPE_IOERR;
+return SCPE_OK;
+}
+
+/* Sparse containers
+
+   When enabled (SET DISKS SPARSE, the default) SIMH and RAW format
+   containers which are host files are kept sparse: runs of all zero
+   sectors being written are turned into holes in the container file
+   instead of being written, and newly created containers are only
+   extended to their full size rather than being filled with zeros.
+   Hosts which can't punch holes just write the zeros.
+ */
+
+#define DISK_HOLE_MIN   4096                            /* smallest zero run worth punching */
+
+static t_bool disk_sparse = TRUE;
+static t_uint64 disk_hole_sects;                        /* zero sectors not written */
+
+typedef t_stat (*DISK_WRSECT)(UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
+
+static t_bool _sim_disk_is_zero (const uint8 *buf, size_t len)
+{
+/* memcmp of the buffer against itself shifted by one byte is typically
+   vectorized by the C library */
+return (buf[0] == 0) && (0 == memcmp (buf, buf + 1, len - 1));
+}
+
+/* Make the container byte range a hole, which reads back as zeros.
+   Any part of the range beyond the current end of the container file is
+   added by extending the file. */
+
+static t_stat _sim_disk_punch (UNIT *uptr, t_offset addr, t_offset bytes)
+{
+#if (defined (__linux) || defined (__linux__)) && defined (FALLOC_FL_PUNCH_HOLE) && defined (FALLOC_FL_KEEP_SIZE)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct stat statb;
+int fd;
+
+if (ctx->no_holes)
+    return SCPE_NOFNC;
+if (DK_GET_FMT (uptr) == DKUF_F_STD) {
+    fflush (uptr->fileref);                             /* push out (and drop) buffered data */
+    fd = fileno (uptr->fileref);
+    }
+else
+    fd = (int)((long)uptr->fileref);
+if (fstat (fd, &statb) || !S_ISREG (statb.st_mode)) {   /* Physical disks aren't touched */
+    ctx->no_holes = TRUE;
+    return SCPE_NOFNC;
+    }
+if ((addr < (t_offset)statb.st_size) &&
+    fallocate (fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, (off_t)addr,
+               (off_t)(((addr + bytes) < (t_offset)statb.st_size) ? bytes : (statb.st_size - addr)))) {
+    if ((errno == EOPNOTSUPP) || (errno == ENOSYS))
+        ctx->no_holes = TRUE;
+    return SCPE_NOFNC;
+    }
+if (((addr + bytes) > (t_offset)statb.st_size) &&       /* extending the file? */
+    ftruncate (fd, (off_t)(addr + bytes)))
+    return SCPE_NOFNC;
+return SCPE_OK;
+#else
+return SCPE_NOFNC;
+#endif
+}
+
+/* Write sectors, punching holes for runs of zero sectors (at least
+   DISK_HOLE_MIN bytes long) and writing everything else with wrsect */
+
+static t_stat _sim_disk_wrsect_sparse (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects, DISK_WRSECT wrsect)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 ss = ctx->sector_size;
+t_seccnt s = 0, start = 0, z, written;
+t_stat r = SCPE_OK;
+
+if (!disk_sparse || ctx->no_holes || (sects * ss < DISK_HOLE_MIN))
+    return wrsect (uptr, lba, buf, sectswritten, sects);
+if (sectswritten)
+    *sectswritten = 0;
+while (s < sects) {
+    for (z = s; (z < sects) && _sim_disk_is_zero (buf + z * ss, ss); ++z)
+        ;
+    if (((z - s) * ss < DISK_HOLE_MIN) ||
+        (_sim_disk_punch (uptr, (t_offset)(lba + s) * ss, (t_offset)(z - s) * ss) != SCPE_OK)) {
+        s = z + 1;                                      /* write it with the data around it */
+        continue;
+        }
+    if (s > start) {                                    /* data before the hole */
+        written = 0;
+        r = wrsect (uptr, lba + start, buf + start * ss, &written, s - start);
+        if (sectswritten)
+            *sectswritten += written;
+        if (r != SCPE_OK)
+            return r;
+        }
+    if (sectswritten)
+        *sectswritten += z - s;
+    disk_hole_sects += z - s;
+    s = start = z;
+    }
+if (start < sects) {
+    written = 0;
+    r = wrsect (uptr, lba + start, buf + start * ss, &written, sects - start);
+    if (sectswritten)
+        *sectswritten += written;
+    }
+return r;
+}
+
+static t_stat _sim_disk_wrsect_fmt (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 f = DK_GET_FMT (uptr);
+t_stat r;
+uint8 *tbuf = NULL;
+
+sim_debug_unit (ctx->dbit, uptr, "sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
+
+if (uptr->dynflags & UNIT_DISK_CHK) {
+    DEVICE *dptr = find_dev_from_unit (uptr);
+    uint32 capac_factor = ((dptr->dwidth / dptr->aincr) >= 32) ? 8 : ((dptr->dwidth / dptr->aincr) == 16) ? 2 : 1; /* capacity units (quadword: 8, word: 2, byte: 1) */
+    t_lba total_sectors = (t_lba)((uptr->capac*capac_factor)/(ctx->sector_size/((dptr->flags & DEV_SECTORS) ? 512 : 1)));
+    t_lba sect;
+
+    for (sect = 0; sect < sects; sect++) {
+        t_lba offset;
+        t_bool sect_error = FALSE;
+
+        for (offset = 0; offset < ctx->sector_size; offset += sizeof(uint32)) {
+            if (*((uint32 *)&buf[sect*ctx->sector_size + offset]) != (uint32)(lba + sect)) {
+                sect_error = TRUE;
+                break;
+                }
+            }
+        if (sect_error) {
+            uint32 save_dctrl = dptr->dctrl;
+            FILE *save_sim_deb = sim_deb;
+
+            sim_printf ("\n%s: Write Address Verification Error on lbn %d(0x%X) of %d(0x%X).\n", sim_uname (uptr), (int)(lba+sect), (int)(lba+sect), (int)total_sectors, (int)total_sectors);
+            dptr->dctrl = 0xFFFFFFFF;
+            sim_deb = save_sim_deb ? save_sim_deb : stdout;
+            sim_disk_data_trace (uptr, buf+sect*ctx->sector_size, lba+sect, ctx->sector_size,    "Found", TRUE, 1);
+            dptr->dctrl = save_dctrl;
+            sim_deb = save_sim_deb;
+            }
+        }
+    }
+switch (f) {                                            /* case on format */
+    case DKUF_F_STD:                                    /* SIMH format */
+        return _sim_disk_wrsect_sparse (uptr, lba, buf, sectswritten, sects, &_sim_disk_wrsect);
+    case DKUF_F_VHD:                                    /* VHD format */
+        if (!sim_end && (ctx->xfer_element_size != sizeof (char))) {
+            tbuf = (uint8*) malloc (sects * ctx->sector_size);
+            if (NULL == tbuf)
+                return SCPE_MEM;
+            sim_buf_copy_swapped (tbuf, buf, ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size);
+            buf = tbuf;
+            }
+        r = sim_vhd_disk_wrsect  (uptr, lba, buf, sectswritten, sects);
+        free (tbuf);
+        return r;
+    case DKUF_F_RAW:                                    /* Raw Physical Disk Access */
+        break;                                          /* handle below */
+    default:
+        return SCPE_NOFNC;
+    }
+if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
+    ((0 == ((lba*ctx->sector_size) & (ctx->storage_sector_size - 1))) &&
+     (0 == ((sects*ctx->sector_size) & (ctx->storage_sector_size - 1))))) {
+
+    if (!sim_end && (ctx->xfer_element_size != sizeof (char))) {
+        tbuf = (uint8*) malloc (sects * ctx->sector_size);
+        if (NULL == tbuf)
+            return SCPE_MEM;
+        sim_buf_copy_swapped (tbuf, buf, ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size);
+        buf = tbuf;
+        }
+
+    r = _sim_disk_wrsect_sparse (uptr, lba, buf, sectswritten, sects, &sim_os_disk_wrsect);
+    }
+else { /* Unaligned and/or partial sector transfers in RAW mode */
+    size_t tbufsize = sects * ctx->sector_size + 2 * ctx->storage_sector_size;
+    t_offset ssaddr = (lba * (t_offset)ctx->sector_size) & ~(t_offset)(ctx->storage_sector_size -1);
+    t_offset sladdr = ((lba + sects) * (t_offset)ctx->sector_size) & ~(t_offset)(ctx->storage_sector_size -1);
+    uint32 soffset = (uint32)((lba * (t_offset)ctx->sector_size) - ssaddr);
+    uint32 byteswritten;
+
+    tbuf = (uint8*) malloc (tbufsize);
+    if (sectswritten)
+        *sectswritten = 0;
+    if (tbuf == NULL)
+        return SCPE_MEM;
+    /* Partial Sector writes require a read-modify-write sequence for the partial sectors */
+    if (soffset) 
+        sim_os_disk_read (uptr, ssaddr, tbuf, NULL, ctx->storage_sector_size);
+    sim_os_disk_read (uptr, sladdr, tbuf + (size_t)(sladdr - ssaddr), NULL, ctx->storage_sector_size);
+    sim_buf_copy_swapped (tbuf + soffset,
+                          buf, ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size);
+    r = sim_os_disk_write (uptr, ssaddr, tbuf, &byteswritten, (soffset + (sects * ctx->sector_size) + ctx->storage_sector_size - 1) & ~(ctx->storage_sector_size - 1));
+    if (sectswritten) {
+        *sectswritten = byteswritten / ctx->sector_size;
+        if (*sectswritten > sects)
+            *sectswritten = sects;
+        }
+    }
+free (tbuf);
+return r;
+}
+
+/* Snapshot overlays
+
+   ATTACH -S creates a copy on write overlay for a SIMH or RAW format
+   base container.  The base is only ever opened read only, so a single
+   golden image can be shared by any number of simulators, while
+   everything written to the unit lands in the overlay file.  An overlay
+   is a 512 byte header, an index holding a slot number for each chunk
+   of the disk (0 meaning the chunk is still only in the base) and then
+   the data of the chunks which have been written, in slot order.  The
+   index is read with one request when the overlay is attached and is
+   kept in memory, so attaching doesn't depend on the size of the base.
+   A chunk is copied up from the base the first time part of it is
+   written.  Its index entry is written, and the overlay flushed, right
+   after its data, so a simulator which dies without detaching loses no
+   chunks.  The base's full path is recorded when the overlay is
+   created.  ATTACH -M folds an overlay back into its base.
+ */
+
+#define DISK_SNAP_CHUNK     65536                   /* overlay chunk size (bytes) */
+
+struct simh_snap_header {
+    uint8       Signature[8];           /* must be 'SIMHSNAP' */
+    uint32      Version;                /* Initially 1 */
+    uint32      SectorSize;
+    uint32      ChunkSectors;           /* sectors in each chunk */
+    uint32      ChunkCount;             /* index entries (0 until first attached) */
+    uint32      BaseModifyTime[2];      /* base container mtime when created (high, low) */
+    uint8       CreatingSimulator[64];  /* name of simulator */
+    uint8       BasePath[256];          /* base container full path */
+    uint8       Reserved[156];          /* Currently unused */
+    uint32      Checksum;               /* CRC32 of the prior 508 bytes */
+    };
+
+struct disk_snapshot {
+    FILE        *file;                  /* overlay container */
+    uint32      chunk_sects;            /* sectors in each chunk */
+    uint32      chunks;                 /* index entries */
+    uint32      used;                   /* highest allocated slot */
+    uint32      *index;                 /* chunk -> overlay slot (0 = base) */
+    uint32      dirty_lo;               /* index entries to write back */
+    uint32      dirty_hi;               /*   (none when dirty_lo >= dirty_hi) */
+    t_lba       sectors;                /* unit size when attached */
+    t_offset    data_offset;            /* container offset of slot 1 */
+    uint8       *cbuf;                  /* chunk copy up buffer */
+    char        base[256];              /* base container name */
+    };
+
+/* Set while a snapshot's base is attached: the base is opened read only,
+   but is sized like a writable container since the unit is writable */
+
+static t_bool disk_snap_base;
+
+static t_offset _sim_disk_snap_data_offset (uint32 chunks)
+{
+return (sizeof (struct simh_snap_header) + ((t_offset)chunks) * sizeof (uint32) + 4095) & ~(t_offset)4095;
+}
+
+/* Write back changed index entries (which are stored little endian) */
+
+static t_stat _sim_disk_snap_flush (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_snapshot *snap = ctx->snap;
+t_stat r = SCPE_OK;
+
+if (snap->dirty_lo < snap->dirty_hi) {
+    if ((sim_fseeko (snap->file, sizeof (struct simh_snap_header) + ((t_offset)snap->dirty_lo) * sizeof (uint32), SEEK_SET) != 0) ||
+        ((snap->dirty_hi - snap->dirty_lo) != sim_fwrite (&snap->index[snap->dirty_lo], sizeof (uint32), snap->dirty_hi - snap->dirty_lo, snap->file)))
+        r = SCPE_IOERR;
+    else {
+        snap->dirty_lo = snap->chunks;
+        snap->dirty_hi = 0;
+        }
+    }
+if (fflush (snap->file) == EOF)
+    r = SCPE_IOERR;
+return r;
+}
+
+static t_stat _sim_disk_snap_close (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_snapshot *snap = ctx->snap;
+t_stat r = _sim_disk_snap_flush (uptr);
+
+if (fclose (snap->file) == EOF)
+    r = SCPE_IOERR;
+free (snap->index);
+free (snap->cbuf);
+free (snap);
+ctx->snap = NULL;
+return r;
+}
+
+static t_stat _sim_disk_snap_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_snapshot *snap = ctx->snap;
+uint32 ss = ctx->sector_size;
+t_seccnt n, got;
+t_lba chunk;
+size_t i;
+t_stat r;
+
+sim_debug_unit (ctx->dbit, uptr, "_sim_disk_snap_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
+
+if (sectsread)
+    *sectsread = 0;
+while (sects) {
+    chunk = lba / snap->chunk_sects;
+    n = snap->chunk_sects - (lba % snap->chunk_sects);
+    if ((chunk < snap->chunks) && (snap->index[chunk] != 0)) {  /* chunk is in the overlay? */
+        if (n > sects)
+            n = sects;
+        if (sim_fseeko (snap->file, snap->data_offset + ((t_offset)(snap->index[chunk] - 1)) * snap->chunk_sects * ss + ((t_offset)(lba % snap->chunk_sects)) * ss, SEEK_SET))
+            return SCPE_IOERR;
+        i = ctx->xfer_element_size * sim_fread (buf, ctx->xfer_element_size, (n * ss) / ctx->xfer_element_size, snap->file);
+        if (ferror (snap->file))
+            return SCPE_IOERR;
+        if (i < n * ss)
+            memset (buf + i, 0, n * ss - i);
+        }
+    else {                                              /* read it and any following base chunks from the base */
+        while ((n < sects) && ((++chunk >= snap->chunks) || (snap->index[chunk] == 0)))
+            n += snap->chunk_sects;
+        if (n > sects)
+            n = sects;
+        got = 0;
+        r = _sim_disk_rdsect_fmt (uptr, lba, buf, &got, n);
+        if (r != SCPE_OK)
+            return r;
+        if (got < n)                                    /* beyond the end of the base */
+            memset (buf + got * ss, 0, (n - got) * ss);
+        }
+    if (sectsread)
+        *sectsread += n;
+    lba += n;
+    buf += n * ss;
+    sects -= n;
+    }
+return SCPE_OK;
+}
+
+static t_stat _sim_disk_snap_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_snapshot *snap = ctx->snap;
+uint32 ss = ctx->sector_size;
+t_seccnt n, got;
+t_lba chunk;
+t_stat r;
+
+sim_debug_unit (ctx->dbit, uptr, "_sim_disk_snap_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
+
+if (sectswritten)
+    *sectswritten = 0;
+while (sects) {
+    uint32 offset = lba % snap->chunk_sects;
+    uint8 *wbuf = buf;
+    t_seccnt wsects;
+    uint32 slot;
+
+    chunk = lba / snap->chunk_sects;
+    if (chunk >= snap->chunks)                          /* beyond the overlay's index? */
+        return SCPE_IOERR;
+    n = snap->chunk_sects - offset;
+    if (n > sects)
+        n = sects;
+    wsects = n;
+    slot = snap->index[chunk];
+    if (slot == 0) {                                    /* first write to this chunk? */
+        if (n < snap->chunk_sects) {                    /* copy up the rest of it from the base */
+            t_lba start = chunk * snap->chunk_sects;
+            t_seccnt want = (start + snap->chunk_sects <= snap->sectors) ? snap->chunk_sects : snap->sectors - start;
+
+            got = 0;
+            r = _sim_disk_rdsect_fmt (uptr, start, snap->cbuf, &got, want);
+            if (r != SCPE_OK)
+                return r;
+            memset (snap->cbuf + got * ss, 0, (snap->chunk_sects - got) * ss);
+            memcpy (snap->cbuf + offset * ss, buf, n * ss);
+            wbuf = snap->cbuf;
+            wsects = snap->chunk_sects;
+            offset = 0;
+            }
+        slot = snap->used + 1;                          /* claimed once its data is written */
+        }
+    if ((sim_fseeko (snap->file, snap->data_offset + ((t_offset)(slot - 1)) * snap->chunk_sects * ss + ((t_offset)offset) * ss, SEEK_SET)) ||
+        (((wsects * ss) / ctx->xfer_element_size) != sim_fwrite (wbuf, ctx->xfer_element_size, (wsects * ss) / ctx->xfer_element_size, snap->file)))
+        return SCPE_IOERR;
+    if (snap->index[chunk] == 0) {                      /* record the newly written chunk */
+        snap->index[chunk] = snap->used = slot;
+        if (snap->dirty_lo > chunk)
+            snap->dirty_lo = chunk;
+        if (snap->dirty_hi <= chunk)
+            snap->dirty_hi = chunk + 1;
+        if ((r = _sim_disk_snap_flush (uptr)) != SCPE_OK)
+            return r;
+        }
+    if (sectswritten)
+        *sectswritten += n;
+    lba += n;
+    buf += n * ss;
+    sects -= n;
+    }
+return SCPE_OK;
+}
+
+/* Sector I/O below the block cache, through any snapshot overlay */
+
+static t_stat _sim_disk_rdsect_direct (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if (ctx->snap)
+    return _sim_disk_snap_rdsect (uptr, lba, buf, sectsread, sects);
+return _sim_disk_rdsect_fmt (uptr, lba, buf, sectsread, sects);
+}
+
+static t_stat _sim_disk_wrsect_direct (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if (ctx->snap)
+    return _sim_disk_snap_wrsect (uptr, lba, buf, sectswritten, sects);
+return _sim_disk_wrsect_fmt (uptr, lba, buf, sectswritten, sects);
+}
+
+/* Disk block cache
+
+   An optional cache of recently used disk data (SET DISKS CACHE=size)
+   which is shared by all attached disk units.  Data is held in lines of
+   whole sectors (up to 4KB) in simulator byte order, so a hit is just a
+   copy.  Lines are found through a hash table keyed by unit and starting
+   sector and are recycled in least recently used order.
+
+   In write-through mode every write goes to the container and updates
+   any cached copy of the data.  In write-back mode a write which covers
+   a whole line, or lands in a line which is already cached, only updates
+   the cache.  A unit's dirty lines are written to its container when the
+   simulator stops, on SAVE, when the unit is reset or detached and when
+   the simulated device asks for it (sim_disk_flush).
+
+   With asynchronous I/O each unit's container is only touched by that
+   unit's I/O thread, so when room is needed a thread only evicts clean
+   lines or dirty lines of its own unit.  If no line can be evicted the
+   data simply isn't cached.  Cache structures are protected by a single
+   lock which is never held across container I/O.
+*/
+
+#define DISK_CACHE_LINE     4096                    /* largest line (bytes) */
+#define CACHE_MIN(a, b)     (((a) < (b)) ? (a) : (b))
+
+struct disk_cache_line {
+    struct disk_cache_line  *hnext;                 /* hash chain */
+    struct disk_cache_line  *newer;                 /* LRU list */
+    struct disk_cache_line  *older;
+    UNIT                    *uptr;                  /* owning unit */
+    t_lba                   lba;                    /* first sector */
+    t_seccnt                sects;                  /* sectors in line */
+    t_bool                  dirty;                  /* not yet written back */
+    uint32                  gen;                    /* bumped on each write */
+    uint8                   *data;
+    };
+
+static struct disk_cache {
+    size_t                  limit;                  /* size (bytes), 0 = disabled */
+    size_t                  used;                   /* bytes in lines */
+    t_bool                  writeback;              /* write-back mode */
+    uint32                  hash_size;              /* hash buckets (power of 2) */
+    struct disk_cache_line  **hash;
+    struct disk_cache_line  *mru;                   /* most recently used */
+    struct disk_cache_line  *lru;                   /* least recently used */
+    uint32                  lines;                  /* lines in use */
+    uint32                  dirty;                  /* dirty lines */
+    t_uint64                rd_sects;               /* sectors read */
+    t_uint64                rd_hits;                /* sectors read from cache */
+    t_uint64                wr_sects;               /* sectors written */
+    t_uint64                wr_held;                /* sectors written into cache only */
+    t_uint64                writebacks;             /* dirty lines written back */
+    t_uint64                evictions;              /* lines recycled */
+    } disk_cache;
+
+#if defined (SIM_ASYNCH_IO)
+static pthread_mutex_t disk_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define CACHE_LOCK      pthread_mutex_lock (&disk_cache_lock)
+#define CACHE_UNLOCK    pthread_mutex_unlock (&disk_cache_lock)
+#else
+#define CACHE_LOCK
+#define CACHE_UNLOCK
+#endif
+
+/* Sectors addressable on the unit (as checked by sim_disk_rdsect) */
+
+static t_lba _disk_cache_total (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+return (t_lba)((uptr->capac*ctx->capac_factor)/(ctx->sector_size/((ctx->dptr->flags & DEV_SECTORS) ? ctx->sector_size : 1)));
+}
+
+static uint32 _disk_cache_hash (UNIT *uptr, t_lba lba)
+{
+return (uint32)((lba ^ ((uint32)((size_t)uptr >> 4) * 0x9E3779B1)) & (disk_cache.hash_size - 1));
+}
+
+static struct disk_cache_line *_disk_cache_find (UNIT *uptr, t_lba lba)
+{
+struct disk_cache_line *l;
+
+for (l = disk_cache.hash[_disk_cache_hash (uptr, lba)]; l; l = l->hnext)
+    if ((l->lba == lba) && (l->uptr == uptr))
+        return l;
+return NULL;
+}
+
+/* Make a line the most recently used */
+
+static void _disk_cache_touch (struct disk_cache_line *l)
+{
+if (l == disk_cache.mru)
+    return;
+if (l->older)                                           /* unlink */
+    l->older->newer = l->newer;
+else
+    disk_cache.lru = l->newer;
+if (l->newer)
+    l->newer->older = l->older;
+l->newer = NULL;                                        /* insert at head */
+l->older = disk_cache.mru;
+if (disk_cache.mru)
+    disk_cache.mru->newer = l;
+disk_cache.mru = l;
+if (disk_cache.lru == NULL)
+    disk_cache.lru = l;
+}
+
+/* Remove a line from the cache (the caller frees it) */
+
+static void _disk_cache_unlink (struct disk_cache_line *l)
+{
+struct disk_cache_line **h = &disk_cache.hash[_disk_cache_hash (l->uptr, l->lba)];
+struct disk_context *ctx = (struct disk_context *)l->uptr->disk_ctx;
+
+while (*h != l)
+    h = &(*h)->hnext;
+*h = l->hnext;
+if (l->older)
+    l->older->newer = l->newer;
+else
+    disk_cache.lru = l->newer;
+if (l->newer)
+    l->newer->older = l->older;
+else
+    disk_cache.mru = l->older;
+disk_cache.used -= l->sects * ctx->sector_size;
+--disk_cache.lines;
+if (l->dirty)
+    --disk_cache.dirty;
+}
+
+/* Allocate a line for unit data, recycling old lines as needed.  Dirty
+   lines of the unit which are evicted are returned on the victims list
+   and must be written back before the unit's container is accessed
+   again. */
+
+static struct disk_cache_line *_disk_cache_alloc (UNIT *uptr, t_lba lba, t_seccnt sects, struct disk_cache_line **victims)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+size_t bytes = sects * ctx->sector_size;
+struct disk_cache_line *l, *v;
+uint32 h;
+
+if ((disk_cache.limit == 0) || (bytes > disk_cache.limit))
+    return NULL;
+for (v = disk_cache.lru; v && (disk_cache.used + bytes > disk_cache.limit); ) {
+    l = v;
+    v = v->newer;
+    if (l->dirty && (l->uptr != uptr))                  /* another unit's data? */
+        continue;                                       /* only its own thread can write it */
+    _disk_cache_unlink (l);
+    ++disk_cache.evictions;
+    if (l->dirty) {
+        l->hnext = *victims;
+        *victims = l;
+        }
+    else
+        free (l);
+    }
+if (disk_cache.used + bytes > disk_cache.limit)
+    return NULL;
+l = (struct disk_cache_line *)malloc (sizeof (*l) + bytes);
+if (l == NULL)
+    return NULL;
+l->data = (uint8 *)(l + 1);
+l->uptr = uptr;
+l->lba = lba;
+l->sects = sects;
+l->dirty = FALSE;
+l->gen = 0;
+h = _disk_cache_hash (uptr, lba);
+l->hnext = disk_cache.hash[h];
+disk_cache.hash[h] = l;
+l->newer = l->older = NULL;
+if (disk_cache.lru == NULL)
+    disk_cache.lru = l;
+else {
+    l->older = disk_cache.mru;
+    disk_cache.mru->newer = l;
+    }
+disk_cache.mru = l;
+disk_cache.used += bytes;
+++disk_cache.lines;
+return l;
+}
+
+static void _disk_cache_set_dirty (struct disk_cache_line *l)
+{
+++l->gen;
+if (!l->dirty) {
+    l->dirty = TRUE;
+    ++disk_cache.dirty;
+    }
+}
+
+/* Write back (and release) lines evicted by _disk_cache_alloc */
+
+static t_stat _disk_cache_write_victims (UNIT *uptr, struct disk_cache_line *victims)
+{
+struct disk_cache_line *l;
+t_stat r = SCPE_OK, r2;
+
+while ((l = victims)) {
+    victims = l->hnext;
+    r2 = _sim_disk_wrsect_direct (uptr, l->lba, l->data, NULL, l->sects);
+    if (r == SCPE_OK)
+        r = r2;
+    CACHE_LOCK;
+    ++disk_cache.writebacks;
+    CACHE_UNLOCK;
+    free (l);
+    }
+return r;
+}
+
+static int _disk_cache_lba_cmp (const void *pa, const void *pb)
+{
+t_lba a = *(const t_lba *)pa;
+t_lba b = *(const t_lba *)pb;
+
+return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/* Write back a unit's dirty lines (in disk order) and optionally drop
+   everything cached for it.  The unit's I/O thread must be idle.  Each
+   line is copied out under the lock and written without it, and is only
+   marked clean if it wasn't written to while the lock was dropped. */
+
+static t_stat _disk_cache_flush (UNIT *uptr, t_bool purge)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache_line *l, *older;
+uint8 data[DISK_CACHE_LINE];
+t_lba *dirty;
+t_seccnt sects;
+uint32 i, n = 0, gen;
+t_stat r = SCPE_OK, r2;
+
+CACHE_LOCK;
+if (disk_cache.lines == 0) {
+    CACHE_UNLOCK;
+    return SCPE_OK;
+    }
+dirty = (t_lba *)malloc ((disk_cache.dirty + 1) * sizeof (*dirty));
+if (dirty == NULL) {
+    CACHE_UNLOCK;
+    return SCPE_MEM;
+    }
+for (l = disk_cache.lru; l; l = l->newer)
+    if (l->dirty && (l->uptr == uptr))
+        dirty[n++] = l->lba;
+CACHE_UNLOCK;
+if (n > 1)
+    qsort (dirty, n, sizeof (*dirty), _disk_cache_lba_cmp);
+for (i = 0; i < n; i++) {
+    CACHE_LOCK;
+    l = _disk_cache_find (uptr, dirty[i]);
+    if ((l == NULL) || !l->dirty) {                     /* already written back */
+        CACHE_UNLOCK;
+        continue;
+        }
+    sects = l->sects;
+    gen = l->gen;
+    memcpy (data, l->data, sects * ctx->sector_size);
+    CACHE_UNLOCK;
+    r2 = _sim_disk_wrsect_direct (uptr, dirty[i], data, NULL, sects);
+    CACHE_LOCK;
+    if (r2 == SCPE_OK) {
+        ++disk_cache.writebacks;
+        l = _disk_cache_find (uptr, dirty[i]);
+        if (l && l->dirty && (l->gen == gen)) {         /* not rewritten? */
+            l->dirty = FALSE;
+            --disk_cache.dirty;
+            }
+        }
+    else
+        r = r2;
+    CACHE_UNLOCK;
+    }
+free (dirty);
+if (purge) {
+    CACHE_LOCK;
+    for (l = disk_cache.mru; l; l = older) {
+        older = l->older;
+        if (l->uptr == uptr) {
+            _disk_cache_unlink (l);
+            free (l);
+            }
+        }
+    CACHE_UNLOCK;
+    }
+if (r != SCPE_OK)
+    sim_printf ("%s: disk cache write back failed: %s\n", sim_uname (uptr), sim_error_text (r));
+return r;
+}
+
+static t_bool _disk_cache_enabled (UNIT *uptr, t_lba lba, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+return (disk_cache.limit != 0) && ctx->cache_spl &&
+       (lba < _disk_cache_total (uptr)) && (sects <= _disk_cache_total (uptr) - lba);
+}
+
+static t_stat _disk_cache_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 ss = ctx->sector_size;
+t_seccnt spl = ctx->cache_spl;
+t_lba total = _disk_cache_total (uptr);
+t_seccnt done = 0, sread = 0;
+t_stat r = SCPE_OK;
+
+while (done < sects) {
+    t_lba cur = lba + done;
+    t_lba first = cur - (cur % spl);
+    t_lba end, ln;
+    t_seccnt n, got, avail;
+    struct disk_cache_line *l, *victims = NULL;
+    uint8 *tbuf;
+
+    CACHE_LOCK;
+    if ((l = _disk_cache_find (uptr, first))) {         /* hit? */
+        n = CACHE_MIN (first + spl - cur, sects - done);
+        memcpy (buf + done * ss, l->data + (cur - first) * ss, n * ss);
+        _disk_cache_touch (l);
+        disk_cache.rd_sects += n;
+        disk_cache.rd_hits += n;
+        CACHE_UNLOCK;
+        done += n;
+        sread += n;
+        continue;
+        }
+    for (end = first + spl;                             /* extend over uncached lines */
+         (end < lba + sects) && !_disk_cache_find (uptr, end);
+         end += spl) ;
+    CACHE_UNLOCK;
+    if (end > total)
+        end = total;
+    n = CACHE_MIN (end - cur, sects - done);
+    tbuf = (uint8 *)malloc ((end - first) * ss);
+    if (tbuf == NULL)
+        return SCPE_MEM;
+    got = 0;
+    r = _sim_disk_rdsect_direct (uptr, first, tbuf, &got, end - first);
+    avail = (got > cur - first) ? got - (cur - first) : 0;
+    memcpy (buf + done * ss, tbuf + (cur - first) * ss, n * ss);
+    CACHE_LOCK;
+    disk_cache.rd_sects += n;
+    if (r == SCPE_OK)                                   /* cache lines read in full */
+        for (ln = first; ln + spl <= first + got; ln += spl)
+            if ((l = _disk_cache_alloc (uptr, ln, spl, &victims)))
+                memcpy (l->data, tbuf + (ln - first) * ss, spl * ss);
+    CACHE_UNLOCK;
+    free (tbuf);
+    if (victims) {
+        t_stat r2 = _disk_cache_write_victims (uptr, victims);
+
+        if (r == SCPE_OK)
+            r = r2;
+        }
+    done += n;
+    sread += CACHE_MIN (avail, n);
+    if (r != SCPE_OK)
+        break;
+    }
+if (sectsread)
+    *sectsread = sread;
+return r;
+}
+
+static t_stat _disk_cache_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 ss = ctx->sector_size;
+t_seccnt spl = ctx->cache_spl;
+t_seccnt done = 0, swritten = 0;
+t_lba dlba = 0;                                         /* pending direct write */
+t_seccnt dsects = 0;
+t_stat r = SCPE_OK;
+
+if (!disk_cache.writeback) {                            /* write through */
+    r = _sim_disk_wrsect_direct (uptr, lba, buf, &swritten, sects);
+    CACHE_LOCK;
+    disk_cache.wr_sects += sects;
+    for (done = 0; done < sects; ) {
+        t_lba cur = lba + done;
+        t_lba first = cur - (cur % spl);
+        t_seccnt n = CACHE_MIN (first + spl - cur, sects - done);
+        struct disk_cache_line *l = _disk_cache_find (uptr, first);
+
+        if (l) {
+            if (r == SCPE_OK) {
+                memcpy (l->data + (cur - first) * ss, buf + done * ss, n * ss);
+                ++l->gen;
+                }
+            else {                                      /* container state unknown */
+                _disk_cache_unlink (l);
+                free (l);
+                }
+            }
+        done += n;
+        }
+    CACHE_UNLOCK;
+    if (sectswritten)
+        *sectswritten = swritten;
+    return r;
+    }
+while ((done < sects) || dsects) {
+    t_lba cur = lba + done;
+    t_lba first = cur - (cur % spl);
+    t_seccnt n = CACHE_MIN (first + spl - cur, sects - done);
+    struct disk_cache_line *l = NULL, *victims = NULL;
+
+    CACHE_LOCK;
+    if (done < sects) {
+        l = _disk_cache_find (uptr, first);
+        if ((l == NULL) && (n == spl))                  /* whole line? */
+            l = _disk_cache_alloc (uptr, first, spl, &victims);
+        if (l) {
+            memcpy (l->data + (cur - first) * ss, buf + done * ss, n * ss);
+            _disk_cache_set_dirty (l);
+            _disk_cache_touch (l);
+            disk_cache.wr_held += n;
+            }
+        disk_cache.wr_sects += n;
+        }
+    CACHE_UNLOCK;
+    if (dsects && (l || (done == sects))) {             /* write out uncached run */
+        t_seccnt w = 0;
+
+        r = _sim_disk_wrsect_direct (uptr, dlba, buf + (dlba - lba) * ss, &w, dsects);
+        swritten += w;
+        dsects = 0;
+        }
+    if (victims) {
+        t_stat r2 = _disk_cache_write_victims (uptr, victims);
+
+        if (r == SCPE_OK)
+            r = r2;
+        }
+    if (r != SCPE_OK)
+        break;
+    if (done == sects)
+        break;
+    if (l)
+        swritten += n;
+    else {
+        if (dsects == 0)
+            dlba = cur;
+        dsects += n;
+        }
+    done += n;
+    }
+if (sectswritten)
+    *sectswritten = swritten;
+return r;
+}
+
+t_stat sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+if (_disk_cache_enabled (uptr, lba, sects))
+    return _disk_cache_rdsect (uptr, lba, buf, sectsread, sects);
+return _sim_disk_rdsect_direct (uptr, lba, buf, sectsread, sects);
+}
+
+t_stat sim_disk_rdsect_a (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects, DISK_PCALLBACK callback)
+{
+t_stat r = SCPE_OK;
+AIO_CALLSETUP
+    r = sim_disk_rdsect (uptr, lba, buf, sectsread, sects);
+AIO_CALL(DOP_RSEC, lba, buf, sectsread, sects, callback);
+return r;
+}
+
+t_stat sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+if (_disk_cache_enabled (uptr, lba, sects))
+    return _disk_cache_wrsect (uptr, lba, buf, sectswritten, sects);
+return _sim_disk_wrsect_direct (uptr, lba, buf, sectswritten, sects);
+}
+
+/* Flush host buffered data for a unit's container */
+
+static void _sim_disk_fflush (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if (ctx->snap)
+    _sim_disk_snap_flush (uptr);
+switch (DK_GET_FMT (uptr)) {                            /* case on format */
+    case DKUF_F_STD:                                    /* Simh */
+        fflush (uptr->fileref);
+        break;
+    case DKUF_F_VHD:                                    /* Virtual Disk */
+        sim_vhd_disk_flush (uptr->fileref);
+        break;
+    case DKUF_F_RAW:                                    /* Physical */
+        sim_os_disk_flush_raw (uptr->fileref);
+        break;
+        }
+}
+
+static void _sim_disk_io_flush (UNIT *uptr);
+
+/* Write cached data for a unit (or all units when uptr is NULL) to the
+   container(s).  Simulated devices call this for their flush or
+   synchronize cache commands. */
+
+t_stat sim_disk_flush (UNIT *uptr)
+{
+DEVICE *dptr;
+uint32 i, j;
+t_stat r = SCPE_OK, r2;
+
+if (uptr == NULL) {
+    for (i = 0; (dptr = sim_devices[i]) != NULL; i++)
+        for (j = 0; j < dptr->numunits; j++)
+            if ((dptr->units[j].flags & UNIT_ATT) &&
+                (dptr->units[j].io_flush == _sim_disk_io_flush) &&
+                ((r2 = sim_disk_flush (&dptr->units[j])) != SCPE_OK))
+                r = r2;
     return r;
     }
+if (!(uptr->flags & UNIT_ATT))
+    return SCPE_UNATT;
+#if defined (SIM_ASYNCH_IO)
+_disk_cancel (uptr);                                    /* wait for the I/O thread to be idle */
+#endif
+r = _disk_cache_flush (uptr, FALSE);
+_sim_disk_fflush (uptr);
+return r;
 }
 
-t_stat sim_disk_rdsect_a (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects, DISK_PCALLBACK callback)
+/* Discard the whole cache, first writing back any dirty data */
+
+static t_stat _disk_cache_drop (void)
 {
-t_stat r = SCPE_OK;
-AIO_CALLSETUP
-    r = sim_disk_rdsect (uptr, lba, buf, sectsread, sects);
-AIO_CALL(DOP_RSEC, lba, buf, sectsread, sects, callback);
+struct disk_cache_line *l;
+t_stat r = sim_disk_flush (NULL);
+
+CACHE_LOCK;
+while ((l = disk_cache.lru)) {
+    _disk_cache_unlink (l);
+    free (l);
+    }
+CACHE_UNLOCK;
 return r;
 }
 
-/* Write Sectors */
+/* SET DISKS CACHE{=size}|NOCACHE|WRITEBACK|WRITETHROUGH|FLUSH */
 
-static t_stat _sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+static t_stat _disk_cache_set_size (int32 flag, CONST char *cptr)
 {
-t_offset da;
-uint32 err, tbc;
-size_t i;
-struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_stat r;
+t_value size = 64;
+char *tptr;
+uint32 buckets;
 
-sim_debug_unit (ctx->dbit, uptr, "_sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
+if (flag == 0) {                                        /* NOCACHE */
+    if (cptr)
+        return SCPE_ARG;
+    size = 0;
+    }
+else {
+    if (cptr && *cptr) {
+        size = strtotv (cptr, (CONST char **)&tptr, 10);
+        if (tptr == cptr)
+            return sim_messagef (SCPE_ARG, "Invalid cache size: %s\n", cptr);
+        switch (toupper (*tptr)) {
+            case 'G':
+                size *= 1024;
+                /* fall through */
+            case 'M':
+            case 0:
+                size *= 1024;
+                /* fall through */
+            case 'K':
+                size *= 1024;
+                break;
+            default:
+                return sim_messagef (SCPE_ARG, "Invalid cache size: %s\n", cptr);
+            }
+        if (*tptr && tptr[1] && (toupper (tptr[1]) != 'B'))
+            return sim_messagef (SCPE_ARG, "Invalid cache size: %s\n", cptr);
+        }
+    else
+        size *= 1024 * 1024;
+    if (size < 64 * 1024)
+        return sim_messagef (SCPE_ARG, "Cache size must be at least 64KB\n");
+    }
+r = _disk_cache_drop ();
+if (r != SCPE_OK)
+    return r;
+free (disk_cache.hash);
+disk_cache.hash = NULL;
+disk_cache.limit = 0;
+if (size == 0)
+    return SCPE_OK;
+for (buckets = 64; (buckets < (uint32)(size / DISK_CACHE_LINE)) && (buckets < 0x40000000); buckets <<= 1) ;
+disk_cache.hash = (struct disk_cache_line **)calloc (buckets, sizeof (*disk_cache.hash));
+if (disk_cache.hash == NULL)
+    return SCPE_MEM;
+disk_cache.hash_size = buckets;
+disk_cache.limit = (size_t)size;
+return SCPE_OK;
+}
 
-da = ((t_offset)lba) * ctx->sector_size;
-tbc = sects * ctx->sector_size;
-if (sectswritten)
-    *sectswritten = 0;
-err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
-if (err)
-    return SCPE_IOERR;
-i = sim_fwrite (buf, ctx->xfer_element_size, tbc/ctx->xfer_element_size, uptr->fileref);
-if (sectswritten)
-    *sectswritten += (t_seccnt)((i * ctx->xfer_element_size + ctx->sector_size - 1)/ctx->sector_size);
-err = ferror (uptr->fileref);
-if (err)
-    return SCPE_IOERR;
+static t_stat _disk_cache_set_mode (int32 flag, CONST char *cptr)
+{
+if (cptr)
+    return SCPE_ARG;
+if (!flag && disk_cache.writeback) {                    /* to write through? */
+    t_stat r = sim_disk_flush (NULL);
+
+    if (r != SCPE_OK)
+        return r;
+    }
+disk_cache.writeback = (flag != 0);
 return SCPE_OK;
 }
 
-t_stat sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+static t_stat _disk_cache_set_flush (int32 flag, CONST char *cptr)
 {
-struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-uint32 f = DK_GET_FMT (uptr);
-t_stat r;
-uint8 *tbuf = NULL;
+if (cptr)
+    return SCPE_ARG;
+return sim_disk_flush (NULL);
+}
 
-sim_debug_unit (ctx->dbit, uptr, "sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
+static t_stat _disk_set_sparse (int32 flag, CONST char *cptr)
+{
+if (cptr)
+    return SCPE_ARG;
+disk_sparse = (flag != 0);
+return SCPE_OK;
+}
 
-if (uptr->dynflags & UNIT_DISK_CHK) {
-    DEVICE *dptr = find_dev_from_unit (uptr);
-    uint32 capac_factor = ((dptr->dwidth / dptr->aincr) >= 32) ? 8 : ((dptr->dwidth / dptr->aincr) == 16) ? 2 : 1; /* capacity units (quadword: 8, word: 2, byte: 1) */
-    t_lba total_sectors = (t_lba)((uptr->capac*capac_factor)/(ctx->sector_size/((dptr->flags & DEV_SECTORS) ? 512 : 1)));
-    t_lba sect;
+static t_stat _disk_set_mmap (int32 flag, CONST char *cptr)
+{
+if (cptr)
+    return SCPE_ARG;
+disk_mmap = (flag != 0);
+return SCPE_OK;
+}
 
-    for (sect = 0; sect < sects; sect++) {
-        t_lba offset;
-        t_bool sect_error = FALSE;
+static CTAB set_disk_tab[] = {
+    { "CACHE",          &_disk_cache_set_size,  1 },
+    { "NOCACHE",        &_disk_cache_set_size,  0 },
+    { "WRITEBACK",      &_disk_cache_set_mode,  1 },
+    { "WRITETHROUGH",   &_disk_cache_set_mode,  0 },
+    { "FLUSH",          &_disk_cache_set_flush, 0 },
+    { "SPARSE",         &_disk_set_sparse,      1 },
+    { "NOSPARSE",       &_disk_set_sparse,      0 },
+    { "MMAP",           &_disk_set_mmap,        1 },
+    { "NOMMAP",         &_disk_set_mmap,        0 },
+    { NULL,             NULL,                   0 }
+    };
 
-        for (offset = 0; offset < ctx->sector_size; offset += sizeof(uint32)) {
-            if (*((uint32 *)&buf[sect*ctx->sector_size + offset]) != (uint32)(lba + sect)) {
-                sect_error = TRUE;
-                break;
-                }
-            }
-        if (sect_error) {
-            uint32 save_dctrl = dptr->dctrl;
-            FILE *save_sim_deb = sim_deb;
+t_stat sim_disk_set_cache (int32 arg, CONST char *cptr)
+{
+char *cvptr, gbuf[CBUFSIZE];
+CTAB *ctptr;
+t_stat r;
 
-            sim_printf ("\n%s: Write Address Verification Error on lbn %d(0x%X) of %d(0x%X).\n", sim_uname (uptr), (int)(lba+sect), (int)(lba+sect), (int)total_sectors, (int)total_sectors);
-            dptr->dctrl = 0xFFFFFFFF;
-            sim_deb = save_sim_deb ? save_sim_deb : stdout;
-            sim_disk_data_trace (uptr, buf+sect*ctx->sector_size, lba+sect, ctx->sector_size,    "Found", TRUE, 1);
-            dptr->dctrl = save_dctrl;
-            sim_deb = save_sim_deb;
-            }
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_2FARG;
+while (*cptr != 0) {                                    /* do all mods */
+    cptr = get_glyph_nc (cptr, gbuf, ',');              /* get modifier */
+    if ((cvptr = strchr (gbuf, '=')))                   /* = value? */
+        *cvptr++ = 0;
+    get_glyph (gbuf, gbuf, 0);                          /* modifier to UC */
+    if ((ctptr = find_ctab (set_disk_tab, gbuf))) {     /* match? */
+        r = ctptr->action (ctptr->arg, cvptr);          /* do the rest */
+        if (r != SCPE_OK)
+            return r;
         }
+    else return SCPE_NOPARAM;
     }
-switch (f) {                                            /* case on format */
-    case DKUF_F_STD:                                    /* SIMH format */
-        return _sim_disk_wrsect (uptr, lba, buf, sectswritten, sects);
-    case DKUF_F_VHD:                                    /* VHD format */
-        if (!sim_end && (ctx->xfer_element_size != sizeof (char))) {
-            tbuf = (uint8*) malloc (sects * ctx->sector_size);
-            if (NULL == tbuf)
-                return SCPE_MEM;
-            sim_buf_copy_swapped (tbuf, buf, ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size);
-            buf = tbuf;
-            }
-        r = sim_vhd_disk_wrsect  (uptr, lba, buf, sectswritten, sects);
-        free (tbuf);
-        return r;
-    case DKUF_F_RAW:                                    /* Raw Physical Disk Access */
-        break;                                          /* handle below */
-    default:
-        return SCPE_NOFNC;
-    }
-if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
-    ((0 == ((lba*ctx->sector_size) & (ctx->storage_sector_size - 1))) &&
-     (0 == ((sects*ctx->sector_size) & (ctx->storage_sector_size - 1))))) {
+return SCPE_OK;
+}
 
-    if (!sim_end && (ctx->xfer_element_size != sizeof (char))) {
-        tbuf = (uint8*) malloc (sects * ctx->sector_size);
-        if (NULL == tbuf)
-            return SCPE_MEM;
-        sim_buf_copy_swapped (tbuf, buf, ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size);
-        buf = tbuf;
-        }
+static double _disk_cache_pct (t_uint64 part, t_uint64 whole)
+{
+return whole ? (100.0 * (double)part) / (double)whole : 0.0;
+}
 
-    r = sim_os_disk_wrsect (uptr, lba, buf, sectswritten, sects);
+t_stat sim_disk_show_cache (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST char *cptr)
+{
+if (cptr && (*cptr != 0))
+    return SCPE_2MARG;
+if (disk_cache.limit == 0)
+    fprintf (st, "Disk cache disabled\n");
+else {
+    fprintf (st, "Disk cache: %.1fMB, %s\n", disk_cache.limit / 1048576.0, disk_cache.writeback ? "write-back" : "write-through");
+    fprintf (st, "  In use:        %.1fMB in %u lines, %u dirty\n", disk_cache.used / 1048576.0, disk_cache.lines, disk_cache.dirty);
     }
-else { /* Unaligned and/or partial sector transfers in RAW mode */
-    size_t tbufsize = sects * ctx->sector_size + 2 * ctx->storage_sector_size;
-    t_offset ssaddr = (lba * (t_offset)ctx->sector_size) & ~(t_offset)(ctx->storage_sector_size -1);
-    t_offset sladdr = ((lba + sects) * (t_offset)ctx->sector_size) & ~(t_offset)(ctx->storage_sector_size -1);
-    uint32 soffset = (uint32)((lba * (t_offset)ctx->sector_size) - ssaddr);
-    uint32 byteswritten;
+if (disk_cache.rd_sects || disk_cache.wr_sects) {
+    fprintf (st, "  Reads:         %" LL_FMT "u sectors, %" LL_FMT "u from cache (%.1f%%)\n",
+                 disk_cache.rd_sects, disk_cache.rd_hits, _disk_cache_pct (disk_cache.rd_hits, disk_cache.rd_sects));
+    fprintf (st, "  Writes:        %" LL_FMT "u sectors, %" LL_FMT "u held in cache (%.1f%%)\n",
+                 disk_cache.wr_sects, disk_cache.wr_held, _disk_cache_pct (disk_cache.wr_held, disk_cache.wr_sects));
+    fprintf (st, "  Write backs:   %" LL_FMT "u lines\n", disk_cache.writebacks);
+    fprintf (st, "  Evictions:     %" LL_FMT "u lines\n", disk_cache.evictions);
+    }
+return SCPE_OK;
+}
 
-    tbuf = (uint8*) malloc (tbufsize);
-    if (sectswritten)
-        *sectswritten = 0;
-    if (tbuf == NULL)
-        return SCPE_MEM;
-    /* Partial Sector writes require a read-modify-write sequence for the partial sectors */
-    if (soffset) 
-        sim_os_disk_read (uptr, ssaddr, tbuf, NULL, ctx->storage_sector_size);
-    sim_os_disk_read (uptr, sladdr, tbuf + (size_t)(sladdr - ssaddr), NULL, ctx->storage_sector_size);
-    sim_buf_copy_swapped (tbuf + soffset,
-                          buf, ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size);
-    r = sim_os_disk_write (uptr, ssaddr, tbuf, &byteswritten, (soffset + (sects * ctx->sector_size) + ctx->storage_sector_size - 1) & ~(ctx->storage_sector_size - 1));
-    if (sectswritten) {
-        *sectswritten = byteswritten / ctx->sector_size;
-        if (*sectswritten > sects)
-            *sectswritten = sects;
+/* SHOW DISKS - logical size and host storage used by attached containers */
+
+t_stat sim_disk_show_disk (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST char *cptr)
+{
+DEVICE *dptr;
+UNIT *uptr;
+uint32 i, j;
+int units = 0;
+
+if (cptr && (*cptr != 0))
+    return SCPE_2MARG;
+fprintf (st, "Sparse containers %s\n", disk_sparse ? "enabled" : "disabled");
+fprintf (st, "Memory mapping of read only containers %s\n", disk_mmap ? "enabled" : "disabled");
+for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
+    for (j = 0; j < dptr->numunits; j++) {
+        struct disk_context *ctx;
+        struct stat statb;
+        t_offset logical, allocated;
+
+        uptr = &dptr->units[j];
+        if (!(uptr->flags & UNIT_ATT) || (uptr->io_flush != _sim_disk_io_flush))
+            continue;
+        ctx = (struct disk_context *)uptr->disk_ctx;
+        logical = ((t_offset)uptr->capac) * ctx->capac_factor * ((dptr->flags & DEV_SECTORS) ? 512 : 1);
+        if (sim_stat (uptr->filename, &statb))
+            allocated = 0;
+        else
+#if !defined (_WIN32) && !defined (VMS)
+            if (S_ISREG (statb.st_mode))
+                allocated = ((t_offset)statb.st_blocks) * 512;
+            else
+#endif
+                allocated = (t_offset)statb.st_size;
+        fprintf (st, "  %-8s %-4s %10.1fMB logical %10.1fMB allocated (%.1f%%)  %s%s\n",
+                     sim_uname (uptr), sim_disk_fmt (uptr), logical / 1048576.0, allocated / 1048576.0,
+                     _disk_cache_pct ((t_uint64)allocated, (t_uint64)logical), uptr->filename, ctx->map ? " (mapped)" : "");
+        if (ctx->snap)
+            fprintf (st, "           snapshot of %s, %u of %u chunks written\n", ctx->snap->base, ctx->snap->used, ctx->snap->chunks);
+        ++units;
         }
     }
-free (tbuf);
-return r;
+if (units == 0)
+    fprintf (st, "  No disks attached\n");
+if (disk_hole_sects)
+    fprintf (st, "  Zero sectors not written: %" LL_FMT "u\n", disk_hole_sects);
+return SCPE_OK;
 }
 
 t_stat sim_disk_wrsect_a (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects, DISK_PCALLBACK callback)
@@ -873,26 +2135,17 @@ switch (DK_GET_FMT (uptr)) {                            /* case on format */
 */
 static void _sim_disk_io_flush (UNIT *uptr)
 {
-uint32 f = DK_GET_FMT (uptr);
-
 #if defined (SIM_ASYNCH_IO)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 sim_disk_clr_async (uptr);
+#endif
+_disk_cache_flush (uptr, FALSE);                        /* write back cached data */
+#if defined (SIM_ASYNCH_IO)
 if (sim_asynch_enabled)
     sim_disk_set_async (uptr, ctx->asynch_io_latency);
 #endif
-switch (f) {                                            /* case on format */
-    case DKUF_F_STD:                                    /* Simh */
-        fflush (uptr->fileref);
-        break;
-    case DKUF_F_VHD:                                    /* Virtual Disk */
-        sim_vhd_disk_flush (uptr->fileref);
-        break;
-    case DKUF_F_RAW:                                    /* Physical */
-        sim_os_disk_flush_raw (uptr->fileref);
-        break;
-        }
+_sim_disk_fflush (uptr);
 }
 
 static t_stat _err_return (UNIT *uptr, t_stat stat)
@@ -2272,6 +3525,291 @@ switch (f->AccessFormat) {
 return SCPE_OK;
 }
 
+/* Snapshot overlay creation, attach and merge */
+
+static void _sim_disk_snap_mtime (const char *filename, uint32 *mtime)
+{
+struct stat statb;
+t_uint64 t = sim_stat (filename, &statb) ? 0 : (t_uint64)statb.st_mtime;
+
+mtime[0] = NtoHl ((uint32)(t >> 32));
+mtime[1] = NtoHl ((uint32)t);
+}
+
+/* Open a file if it is a snapshot overlay */
+
+static FILE *_sim_disk_snap_open (const char *filename, const char *mode, struct simh_snap_header *hdr)
+{
+FILE *f = sim_fopen (filename, mode);
+
+if (f == NULL)
+    return NULL;
+if ((sizeof (*hdr) != sim_fread (hdr, 1, sizeof (*hdr), f)) ||
+    (memcmp (hdr->Signature, "SIMHSNAP", sizeof (hdr->Signature)) != 0) ||
+    (hdr->Checksum != NtoHl (eth_crc32 (0, hdr, sizeof (*hdr) - sizeof (hdr->Checksum)))) ||
+    (hdr->ChunkSectors == 0)) {
+    fclose (f);
+    return NULL;
+    }
+hdr->BasePath[sizeof (hdr->BasePath) - 1] = '\0';
+return f;
+}
+
+/* Check that a snapshot's base hasn't changed since the snapshot was made */
+
+static t_stat _sim_disk_snap_check_base (UNIT *uptr, const char *cptr, struct simh_snap_header *hdr, size_t sector_size)
+{
+uint32 mtime[2];
+struct stat statb;
+
+if (NtoHl (hdr->SectorSize) != sector_size)
+    return sim_messagef (SCPE_INCOMPDSK, "%s: snapshot overlay '%s' has %u byte sectors rather than %u byte sectors\n", 
+                                         sim_uname (uptr), cptr, NtoHl (hdr->SectorSize), (uint32)sector_size);
+if (sim_stat ((char *)hdr->BasePath, &statb))           /* missing base reported when opened */
+    return SCPE_OK;
+_sim_disk_snap_mtime ((char *)hdr->BasePath, mtime);
+if ((memcmp (mtime, hdr->BaseModifyTime, sizeof (mtime)) != 0) &&
+    !(sim_switches & SWMASK ('O')))
+    return sim_messagef (SCPE_OPENERR, "%s: base container '%s' has changed since snapshot overlay '%s' was created\n", 
+                                       sim_uname (uptr), (char *)hdr->BasePath, cptr);
+return SCPE_OK;
+}
+
+static t_stat _sim_disk_snap_create (UNIT *uptr, const char *cptr, const char *base, size_t sector_size)
+{
+struct simh_snap_header hdr;
+size_t written;
+char *fullbase;
+FILE *f;
+
+if ((f = sim_fopen (cptr, "rb")) != NULL) {
+    fclose (f);
+    return sim_messagef (SCPE_ARG, "%s: snapshot overlay '%s' already exists\n", sim_uname (uptr), cptr);
+    }
+if ((f = _sim_disk_snap_open (base, "rb", &hdr)) != NULL) {
+    fclose (f);
+    return sim_messagef (SCPE_ARG, "%s: '%s' is itself a snapshot overlay\n", sim_uname (uptr), base);
+    }
+fullbase = sim_filepath_parts (base, "f");
+if (fullbase == NULL)
+    return SCPE_MEM;
+if (strlen (fullbase) >= sizeof (hdr.BasePath)) {
+    free (fullbase);
+    return sim_messagef (SCPE_ARG, "%s: snapshot base container name is too long: %s\n", sim_uname (uptr), base);
+    }
+memset (&hdr, 0, sizeof (hdr));
+memcpy (hdr.Signature, "SIMHSNAP", sizeof (hdr.Signature));
+hdr.Version = NtoHl (1);
+hdr.SectorSize = NtoHl ((uint32)sector_size);
+hdr.ChunkSectors = NtoHl ((sector_size < DISK_SNAP_CHUNK) ? (uint32)(DISK_SNAP_CHUNK / sector_size) : 1);
+_sim_disk_snap_mtime (base, hdr.BaseModifyTime);
+strlcpy ((char *)hdr.CreatingSimulator, sim_name, sizeof (hdr.CreatingSimulator));
+strlcpy ((char *)hdr.BasePath, fullbase, sizeof (hdr.BasePath));
+free (fullbase);
+hdr.Checksum = NtoHl (eth_crc32 (0, &hdr, sizeof (hdr) - sizeof (hdr.Checksum)));
+f = sim_fopen (cptr, "wb");
+if (f == NULL)
+    return sim_messagef (SCPE_OPENERR, "%s: Can't create file: %s\n", sim_uname (uptr), cptr);
+written = sim_fwrite (&hdr, 1, sizeof (hdr), f);
+if ((fclose (f) == EOF) || (written != sizeof (hdr))) {
+    (void)remove (cptr);
+    return sim_messagef (SCPE_IOERR, "%s: Can't write snapshot overlay: %s\n", sim_uname (uptr), cptr);
+    }
+sim_messagef (SCPE_OK, "%s: creating new snapshot overlay '%s' of '%s'\n", sim_uname (uptr), cptr, base);
+return SCPE_OK;
+}
+
+/* Attach a snapshot overlay: the base container is attached read only
+   and the overlay's index is loaded */
+
+static t_stat _sim_disk_snap_attach (UNIT *uptr, const char *cptr, size_t sector_size, size_t xfer_element_size, t_bool dontchangecapac,
+                                     uint32 dbit, const char *dtype, uint32 pdp11tracksize, int completion_delay, const char **drivetypes)
+{
+struct disk_context *ctx;
+struct disk_snapshot *snap;
+struct simh_snap_header hdr;
+DEVICE *dptr = find_dev_from_unit (uptr);
+int32 saved_switches = sim_switches;
+int32 saved_quiet = sim_quiet;
+t_bool read_only = ((sim_switches & SWMASK ('R')) || (uptr->flags & UNIT_RO));
+t_bool sized = FALSE;
+uint32 i;
+FILE *f = NULL;
+t_stat r;
+
+if (!read_only) {
+    f = _sim_disk_snap_open (cptr, "rb+", &hdr);
+    if ((f == NULL) && (uptr->flags & UNIT_ROABLE) &&
+        ((errno == EROFS) || (errno == EACCES)))
+        read_only = TRUE;
+    }
+if (read_only)
+    f = _sim_disk_snap_open (cptr, "rb", &hdr);
+if (f == NULL)
+    return sim_messagef (SCPE_OPENERR, "%s: Can't open snapshot overlay: %s\n", sim_uname (uptr), cptr);
+r = _sim_disk_snap_check_base (uptr, cptr, &hdr, sector_size);
+if (r != SCPE_OK) {
+    fclose (f);
+    return r;
+    }
+sim_switches |= SWMASK ('R') | SWMASK ('E');
+sim_quiet = TRUE;
+disk_snap_base = TRUE;
+r = sim_disk_attach_ex (uptr, (char *)hdr.BasePath, sector_size, xfer_element_size, dontchangecapac, dbit, dtype, pdp11tracksize, completion_delay, drivetypes);
+disk_snap_base = FALSE;
+sim_switches = saved_switches;
+sim_quiet = saved_quiet;
+if (r != SCPE_OK) {
+    fclose (f);
+    return sim_messagef (r, "%s: Can't open snapshot base container: %s - %s\n", sim_uname (uptr), (char *)hdr.BasePath, sim_error_text (r));
+    }
+ctx = (struct disk_context *)uptr->disk_ctx;
+if (DK_GET_FMT (uptr) == DKUF_F_VHD) {
+    sim_disk_detach (uptr);
+    fclose (f);
+    return sim_messagef (SCPE_ARG, "%s: snapshot base container '%s' is a VHD, use a differencing VHD (ATTACH -D) instead\n", sim_uname (uptr), (char *)hdr.BasePath);
+    }
+snap = (struct disk_snapshot *)calloc (1, sizeof (*snap));
+if (snap == NULL) {
+    sim_disk_detach (uptr);
+    fclose (f);
+    return SCPE_MEM;
+    }
+snap->file = f;
+strlcpy (snap->base, (char *)hdr.BasePath, sizeof (snap->base));
+snap->chunk_sects = NtoHl (hdr.ChunkSectors);
+snap->chunks = NtoHl (hdr.ChunkCount);
+snap->sectors = (t_lba)((((t_offset)uptr->capac)*ctx->capac_factor*((dptr->flags & DEV_SECTORS) ? 512 : 1))/ctx->sector_size);
+if ((snap->chunks == 0) && !read_only) {                /* first attach sizes the index */
+    snap->chunks = (uint32)((snap->sectors + snap->chunk_sects - 1) / snap->chunk_sects);
+    hdr.ChunkCount = NtoHl (snap->chunks);
+    hdr.Checksum = NtoHl (eth_crc32 (0, &hdr, sizeof (hdr) - sizeof (hdr.Checksum)));
+    if ((sim_fseeko (f, 0, SEEK_SET) != 0) ||
+        (sizeof (hdr) != sim_fwrite (&hdr, 1, sizeof (hdr), f)))
+        r = SCPE_IOERR;
+    sized = TRUE;
+    }
+snap->data_offset = _sim_disk_snap_data_offset (snap->chunks);
+snap->index = (uint32 *)calloc (snap->chunks + 1, sizeof (*snap->index));
+snap->cbuf = (uint8 *)malloc (snap->chunk_sects * ctx->sector_size);
+if ((snap->index == NULL) || (snap->cbuf == NULL))
+    r = SCPE_MEM;
+if ((r == SCPE_OK) && !sized &&
+    ((sim_fseeko (f, sizeof (hdr), SEEK_SET) != 0) ||
+     (snap->chunks != sim_fread (snap->index, sizeof (*snap->index), snap->chunks, f))))
+    r = SCPE_IOERR;
+if (r != SCPE_OK) {
+    free (snap->index);
+    free (snap->cbuf);
+    free (snap);
+    fclose (f);
+    sim_disk_detach (uptr);
+    return sim_messagef (r, "%s: Can't load snapshot overlay: %s - %s\n", sim_uname (uptr), cptr, sim_error_text (r));
+    }
+for (i = 0; i < snap->chunks; i++)
+    if (snap->index[i] > snap->used)
+        snap->used = snap->index[i];
+snap->dirty_lo = sized ? 0 : snap->chunks;              /* a new index is written out */
+snap->dirty_hi = sized ? snap->chunks : 0;
+ctx->snap = snap;
+if ((r = _sim_disk_snap_flush (uptr)) != SCPE_OK) {
+    sim_disk_detach (uptr);
+    return sim_messagef (r, "%s: Can't write snapshot overlay: %s - %s\n", sim_uname (uptr), cptr, sim_error_text (r));
+    }
+if (!read_only)
+    uptr->flags &= ~UNIT_RO;                            /* writes go to the overlay */
+strlcpy (uptr->filename, cptr, CBUFSIZE);
+sim_messagef (SCPE_OK, "%s: attached snapshot overlay '%s' of '%s'%s\n", sim_uname (uptr), cptr, (char *)hdr.BasePath, read_only ? " read only" : "");
+return SCPE_OK;
+}
+
+/* Merge a snapshot overlay into its base container, leaving the base
+   attached and removing the overlay */
+
+static t_stat _sim_disk_snap_merge (UNIT *uptr, const char *cptr, size_t sector_size, size_t xfer_element_size, t_bool dontchangecapac,
+                                    uint32 dbit, const char *dtype, uint32 pdp11tracksize, int completion_delay, const char **drivetypes)
+{
+struct disk_context *ctx;
+struct simh_snap_header hdr;
+DEVICE *dptr = find_dev_from_unit (uptr);
+int32 saved_switches = sim_switches;
+int32 saved_quiet = sim_quiet;
+uint32 chunks, chunk_sects, k, used = 0, merged = 0;
+uint32 *index = NULL;
+uint8 *buf = NULL;
+t_lba total_sectors;
+FILE *f;
+t_stat r;
+
+f = _sim_disk_snap_open (cptr, "rb", &hdr);
+if (f == NULL)
+    return SCPE_OPENERR;
+r = _sim_disk_snap_check_base (uptr, cptr, &hdr, sector_size);
+if (r != SCPE_OK) {
+    fclose (f);
+    return r;
+    }
+sim_switches = (sim_switches & ~SWMASK ('R')) | SWMASK ('E');
+sim_quiet = TRUE;
+r = sim_disk_attach_ex (uptr, (char *)hdr.BasePath, sector_size, xfer_element_size, dontchangecapac, dbit, dtype, pdp11tracksize, completion_delay, drivetypes);
+sim_switches = saved_switches;
+sim_quiet = saved_quiet;
+if (r != SCPE_OK) {
+    fclose (f);
+    return sim_messagef (r, "%s: Can't open snapshot base container: %s - %s\n", sim_uname (uptr), (char *)hdr.BasePath, sim_error_text (r));
+    }
+ctx = (struct disk_context *)uptr->disk_ctx;
+if (uptr->flags & UNIT_RO) {
+    sim_disk_detach (uptr);
+    fclose (f);
+    return sim_messagef (SCPE_RO, "%s: Can't merge into read only base container: %s\n", sim_uname (uptr), (char *)hdr.BasePath);
+    }
+chunks = NtoHl (hdr.ChunkCount);
+chunk_sects = NtoHl (hdr.ChunkSectors);
+total_sectors = (t_lba)((((t_offset)uptr->capac)*ctx->capac_factor*((dptr->flags & DEV_SECTORS) ? 512 : 1))/ctx->sector_size);
+index = (uint32 *)calloc (chunks + 1, sizeof (*index));
+buf = (uint8 *)malloc (chunk_sects * ctx->sector_size);
+if ((index == NULL) || (buf == NULL))
+    r = SCPE_MEM;
+if ((r == SCPE_OK) &&
+    ((sim_fseeko (f, sizeof (hdr), SEEK_SET) != 0) ||
+     (chunks != sim_fread (index, sizeof (*index), chunks, f))))
+    r = SCPE_IOERR;
+for (k = 0; k < chunks; k++)
+    if (index[k] != 0)
+        ++used;
+for (k = 0; (k < chunks) && (r == SCPE_OK); k++) {
+    t_lba lba = k * chunk_sects;
+    t_seccnt sects = chunk_sects, written;
+
+    if ((index[k] == 0) || (lba >= total_sectors))
+        continue;
+    if (lba + sects > total_sectors)
+        sects = total_sectors - lba;
+    if ((sim_fseeko (f, _sim_disk_snap_data_offset (chunks) + ((t_offset)(index[k] - 1)) * chunk_sects * ctx->sector_size, SEEK_SET) != 0) ||
+        (((sects * ctx->sector_size) / ctx->xfer_element_size) != sim_fread (buf, ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size, f)))
+        r = SCPE_IOERR;
+    if (r == SCPE_OK)
+        r = _sim_disk_wrsect_direct (uptr, lba, buf, &written, sects);
+    if ((r == SCPE_OK) && (written != sects))
+        r = SCPE_IOERR;
+    ++merged;
+    sim_messagef (SCPE_OK, "%s: Merged %u/%u chunks.  %d%% complete.\r", sim_uname (uptr), merged, used, (int)((((float)merged)*100)/used));
+    }
+free (index);
+free (buf);
+fclose (f);
+if (r == SCPE_OK)
+    r = sim_disk_flush (uptr);
+if (r != SCPE_OK) {
+    sim_disk_detach (uptr);
+    return sim_messagef (r, "\n%s: Error merging snapshot overlay '%s': %s\n", sim_uname (uptr), cptr, sim_error_text (r));
+    }
+(void)remove (cptr);
+sim_messagef (SCPE_OK, "%s%s: Merged %u chunks from '%s' into '%s'. Done.\n", merged ? "\n" : "", sim_uname (uptr), merged, cptr, uptr->filename);
+return SCPE_OK;
+}
+
 t_stat sim_disk_attach (UNIT *uptr, const char *cptr, size_t sector_size, size_t xfer_element_size, t_bool dontchangecapac,
                         uint32 dbit, const char *dtype, uint32 pdp11tracksize, int completion_delay)
 {
@@ -2332,6 +3870,22 @@ if (sim_switches & SWMASK ('D')) {                      /* create difference dis
         }
     return sim_messagef (SCPE_ARG, "Unable to create differencing VHD: %s\n", gbuf);
     }
+if (sim_switches & SWMASK ('S')) {                      /* create snapshot overlay? */
+    char gbuf[CBUFSIZE];
+    t_stat r;
+
+    sim_switches = sim_switches & ~(SWMASK ('S'));
+    cptr = get_glyph_nc (cptr, gbuf, 0);                /* get overlay name */
+    if (*cptr == 0)                                     /* must be more */
+        return SCPE_2FARG;
+    r = _sim_disk_snap_create (uptr, gbuf, cptr, sector_size);
+    if (r != SCPE_OK)
+        return r;
+    r = _sim_disk_snap_attach (uptr, gbuf, sector_size, xfer_element_size, dontchangecapac, dbit, dtype, pdp11tracksize, completion_delay, drivetypes);
+    if (r != SCPE_OK)
+        (void)remove (gbuf);                            /* remove the unusable overlay */
+    return r;
+    }
 if (sim_switches & SWMASK ('C')) {                      /* create new disk container & copy contents? */
     char gbuf[CBUFSIZE];
     const char *dest_fmt = ((DK_GET_FMT (uptr) == DKUF_F_AUTO) || (DK_GET_FMT (uptr) == DKUF_F_VHD)) ? "VHD" : "SIMH";
@@ -2394,7 +3948,7 @@ if (sim_switches & SWMASK ('C')) {                      /* create new disk conta
 
                 sim_disk_set_fmt (uptr, 0, dest_fmt, NULL);
                 uptr->fileref = dest;
-                r = sim_disk_wrsect (uptr, lba, copy_buf, &sects_written, sects_read);
+                r = _sim_disk_wrsect_direct (uptr, lba, copy_buf, &sects_written, sects_read);
                 uptr->fileref = save_unit_fileref;
                 uptr->flags = saved_unit_flags;
                 if (sects_read != sects_written)
@@ -2432,7 +3986,7 @@ if (sim_switches & SWMASK ('C')) {                      /* create new disk conta
 
                     sim_disk_set_fmt (uptr, 0, dest_fmt, NULL);
                     uptr->fileref = dest;
-                    r = sim_disk_rdsect (uptr, lba, verify_buf, &verify_read, sects_read);
+                    r = _sim_disk_rdsect_direct (uptr, lba, verify_buf, &verify_read, sects_read);
                     uptr->fileref = save_unit_fileref;
                     uptr->flags = saved_unit_flags;
                     if (r == SCPE_OK) {
@@ -2488,10 +4042,15 @@ if (sim_switches & SWMASK ('C')) {                      /* create new disk conta
 else
     if (sim_switches & SWMASK ('M')) {                 /* merge difference disk? */
         char gbuf[CBUFSIZE], *Parent = NULL;
+        struct simh_snap_header hdr;
         FILE *vhd;
 
         sim_switches = sim_switches & ~(SWMASK ('M'));
         get_glyph_nc (cptr, gbuf, 0);                  /* get spec */
+        if ((vhd = _sim_disk_snap_open (gbuf, "rb", &hdr)) != NULL) {  /* snapshot overlay? */
+            fclose (vhd);
+            return _sim_disk_snap_merge (uptr, gbuf, sector_size, xfer_element_size, dontchangecapac, dbit, dtype, pdp11tracksize, completion_delay, drivetypes);
+            }
         vhd = sim_vhd_disk_merge (gbuf, &Parent);
         if (vhd) {
             t_stat r;
@@ -2503,6 +4062,15 @@ else
             }
         return SCPE_ARG;
         }
+if (1) {
+    struct simh_snap_header hdr;
+    FILE *snap = _sim_disk_snap_open (cptr, "rb", &hdr);
+
+    if (snap != NULL) {                                 /* snapshot overlay? */
+        fclose (snap);
+        return _sim_disk_snap_attach (uptr, cptr, sector_size, xfer_element_size, dontchangecapac, dbit, dtype, pdp11tracksize, completion_delay, drivetypes);
+        }
+    }
 
 switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_AUTO:                                   /* SIMH format */
@@ -2577,7 +4145,7 @@ ctx->storage_sector_size = (uint32)sector_size;         /* Default */
 if ((sim_switches & SWMASK ('R')) ||                    /* read only? */
     ((uptr->flags & UNIT_RO) != 0)) {
     if (((uptr->flags & UNIT_ROABLE) == 0) &&           /* allowed? */
-        ((uptr->flags & UNIT_RO) == 0))
+        ((uptr->flags & UNIT_RO) == 0) && !disk_snap_base)
         return _err_return (uptr, SCPE_NORO);           /* no, error */
     uptr->fileref = open_function (cptr, "rb");         /* open rd only */
     if (uptr->fileref == NULL)                          /* open fail? */
@@ -2682,14 +4250,19 @@ if ((created) && (!copied)) {
             if the containing disk is full
          3) it leaves a Simh Format disk at the intended size so it may
             subsequently be autosized with the correct size.
+       When sparse containers are enabled (the default) only the last sector
+       of a Simh Format disk is written, which achieves 3) while leaving the
+       rest of the container as a hole that takes no storage.
     */
     if (secbuf == NULL)
         r = SCPE_MEM;
     if (r == SCPE_OK) { /* Write all blocks */
-        t_lba lba;
+        t_lba lba = 0;
         t_lba total_lbas = (t_lba)((((t_offset)uptr->capac)*ctx->capac_factor*((dptr->flags & DEV_SECTORS) ? 512 : 1))/ctx->sector_size);
 
-        for (lba = 0; (r == SCPE_OK) && (lba < total_lbas); lba += 128) { 
+        if (disk_sparse && (DK_GET_FMT (uptr) == DKUF_F_STD) && (total_lbas > 0))
+            lba = total_lbas - 1;
+        for (; (r == SCPE_OK) && (lba < total_lbas); lba += 128) { 
             t_seccnt sectors = ((lba + 128) <= total_lbas) ? 128 : total_lbas - lba;
 
             r = sim_disk_wrsect (uptr, lba, secbuf, NULL, sectors);
@@ -2841,7 +4414,7 @@ if (container_size && (container_size != (t_offset)-1)) {
                 }
             }
         if ((container_size != current_unit_size) && 
-            ((DKUF_F_VHD == DK_GET_FMT (uptr)) || (0 != (uptr->flags & UNIT_RO)) ||
+            ((DKUF_F_VHD == DK_GET_FMT (uptr)) || ((0 != (uptr->flags & UNIT_RO)) && !disk_snap_base) ||
              (ctx->footer))) {
             if (!sim_quiet) {
                 int32 saved_switches = sim_switches;
@@ -2868,7 +4441,7 @@ if (container_size && (container_size != (t_offset)-1)) {
         else {                                              /* Unrecognized file system */
             if (container_size < current_unit_size)         /*     Use MAX of container or current device size */
                 if ((DKUF_F_VHD != DK_GET_FMT (uptr)) &&    /*     when size can be expanded */
-                    (0 == (uptr->flags & UNIT_RO)))
+                    ((0 == (uptr->flags & UNIT_RO)) || disk_snap_base))
                     container_size = current_unit_size;     /*     Use MAX of container or current device size */
             }
         uptr->capac = (t_addr)(container_size/(ctx->capac_factor*((dptr->flags & DEV_SECTORS) ? 512 : 1)));  /* update current size */
@@ -2878,6 +4451,9 @@ if (container_size && (container_size != (t_offset)-1)) {
 if (dtype && (created || (ctx->footer == NULL)))
     store_disk_footer (uptr, dtype);
 
+_sim_disk_map (uptr);
+if (!ctx->removable && !ctx->map)                       /* fixed unmapped media may be cached */
+    ctx->cache_spl = (ctx->sector_size < DISK_CACHE_LINE) ? DISK_CACHE_LINE / ctx->sector_size : 1;
 #if defined (SIM_ASYNCH_IO)
 sim_disk_set_async (uptr, completion_delay);
 #endif
@@ -2928,6 +4504,13 @@ if (uptr->io_flush)
     uptr->io_flush (uptr);                              /* flush buffered data */
 
 sim_disk_clr_async (uptr);
+#if defined (SIM_ASYNCH_IO)
+_disk_free_reqs (ctx);
+#endif
+_disk_cache_flush (uptr, TRUE);                         /* drop cached data */
+if (ctx->snap)
+    _sim_disk_snap_close (uptr);                        /* write back the overlay's index */
+_sim_disk_unmap (uptr);
 
 uptr->flags &= ~(UNIT_ATT | UNIT_RO);
 uptr->dynflags &= ~(UNIT_NO_FIO | UNIT_DISK_CHK);
@@ -3005,6 +4588,12 @@ fprintf (st, "which describes the drive size and the simh device type in use whe
 fprintf (st, "was created.  This metadata is therefore available whenever that VHD is\n");
 fprintf (st, "attached to an emulated disk device in the future so the device type and\n");
 fprintf (st, "size can be automatically be configured.\n\n");
+fprintf (st, "A snapshot overlay (created with ATTACH -S) holds the changes made to a SIMH\n");
+fprintf (st, "or RAW format disk which is itself only opened read only, so many simulators\n");
+fprintf (st, "can each boot the same disk through their own overlay.  Space is allocated in\n");
+fprintf (st, "the overlay in 64KB chunks as the disk is written.  An overlay records the\n");
+fprintf (st, "name (as given when it was created) of the disk it is a snapshot of, so a\n");
+fprintf (st, "later ATTACH of the overlay attaches both.\n\n");
 
 if (dptr->numunits > 1) {
     uint32 i, attachable_count = 0, out_count = 0, skip_count;
@@ -3059,9 +4648,14 @@ fprintf (st, "    -X          When creating a VHD, create a fixed sized VHD (vs
 fprintf (st, "                expanding one).\n");
 fprintf (st, "    -D          Create a Differencing VHD (relative to an already existing VHD\n");
 fprintf (st, "                disk)\n");
-fprintf (st, "    -M          Merge a Differencing VHD into its parent VHD disk\n");
+fprintf (st, "    -S          Create a snapshot overlay of an existing SIMH or RAW format\n");
+fprintf (st, "                disk.  The existing disk is only read and may be shared, all\n");
+fprintf (st, "                changes are written to the overlay.\n");
+fprintf (st, "    -M          Merge a Differencing VHD into its parent VHD disk, or a\n");
+fprintf (st, "                snapshot overlay into the disk it is a snapshot of\n");
 fprintf (st, "    -O          Override consistency checks when attaching differencing disks\n");
-fprintf (st, "                which have unexpected parent disk GUID or timestamps\n\n");
+fprintf (st, "                which have unexpected parent disk GUID or timestamps, or\n");
+fprintf (st, "                snapshot overlays whose disk has changed\n\n");
 fprintf (st, "    -U          Fix inconsistencies which are overridden by the -O switch\n");
 if (strstr (sim_name, "-10") == NULL) {
     fprintf (st, "    -Y          Answer Yes to prompt to overwrite last track (on disk create)\n");
@@ -3091,6 +4685,8 @@ fprintf (st, "  04/14/2011  12:57 PM             5,120 %s.vhd\n", ex->dtype4);
 fprintf (st, "                 1 File(s)          5,120 bytes\n");
 fprintf (st, "  sim> # create a differencing vhd (%s-1-Diff.vhd) with %s.vhd as parent\n", ex->dtype4, ex->dtype4);
 fprintf (st, "  sim> attach %s3 -d %s-1-Diff.vhd %s.vhd\n", ex->dname, ex->dtype4, ex->dtype4);
+fprintf (st, "  sim> # boot from a shared SIMH format disk through a private snapshot overlay\n");
+fprintf (st, "  sim> attach %s1 -s %s-1.snap %s.dsk\n", ex->dname, ex->dtype3, ex->dtype3);
 fprintf (st, "  sim> # create a VHD (%s-1.vhd) which is a copy of an existing disk\n", ex->dtype4);
 fprintf (st, "  sim> attach %s3 -c %s-1.vhd %s.vhd\n", ex->dname, ex->dtype4, ex->dtype4);
 fprintf (st, "  %s3: creating new virtual disk '%s-1.vhd'\n", ex->dname, ex->dtype4);
@@ -4823,8 +6419,139 @@ struct VHD_IOData {
     FILE *File;
     char ParentVHDPath[512];
     struct VHD_IOData *Parent;
+    uint8 **BitMaps;                /* cached block sector bitmaps (differencing disks) */
+    uint8 *BitMapDirty;             /* per block bitmap needs writing */
+    t_bool BitMapsDirty;            /* some bitmap needs writing */
+    t_bool BATDirty;                /* BAT entries changed since last flush */
+    uint32 BATDirtyLow;             /* first changed BAT entry */
+    uint32 BATDirtyHigh;            /* last changed BAT entry + 1 */
     };
 
+/* VHD metadata caching
+
+   The BAT is loaded when a VHD is opened and changes to it (block allocations)
+   are only recorded in memory and written back as one run when the disk is
+   flushed or closed, rather than one BAT sector write per allocated block.
+
+   Differencing disks may contain blocks which are only partially populated,
+   where the block's sector bitmap indicates which sectors are present in the
+   block and which still come from the parent.  Those bitmaps are read once and
+   cached here.  Bitmaps which are completely full (which is the case for all
+   blocks allocated by simh) are represented by VHD_BITMAP_FULL and take the
+   fast path which reads the block data directly.
+ */
+
+static uint8 _VHD_FullBitMap;
+#define VHD_BITMAP_FULL (&_VHD_FullBitMap)
+#define VHD_BITMAP_TEST(bm, s) ((bm)[(s) >> 3] & (0x80 >> ((s) & 7)))
+#define VHD_BITMAP_SET(bm, s) (bm)[(s) >> 3] |= (0x80 >> ((s) & 7))
+
+static uint8 *
+_VHD_BlockBitMap(VHDHANDLE hVHD,
+                 uint32 BlockNumber)
+{
+uint32 Entries = NtoHl (hVHD->Dynamic.MaxTableEntries);
+uint32 BlockSectors = NtoHl (hVHD->Dynamic.BlockSize) / VHD_Internal_SectorSize;
+uint32 BitMapBytes = (7 + BlockSectors) / 8;
+uint32 BytesRead;
+uint8 *BitMap;
+uint32 i;
+
+if (hVHD->BitMaps == NULL) {
+    hVHD->BitMaps = (uint8 **)calloc (Entries, sizeof (*hVHD->BitMaps));
+    hVHD->BitMapDirty = (uint8 *)calloc (Entries, sizeof (*hVHD->BitMapDirty));
+    if ((hVHD->BitMaps == NULL) || (hVHD->BitMapDirty == NULL)) {
+        free (hVHD->BitMaps);
+        hVHD->BitMaps = NULL;
+        free (hVHD->BitMapDirty);
+        hVHD->BitMapDirty = NULL;
+        return NULL;
+        }
+    }
+if (hVHD->BitMaps[BlockNumber])
+    return hVHD->BitMaps[BlockNumber];
+BitMap = (uint8 *)calloc (1, BitMapBytes);
+if (BitMap == NULL)
+    return NULL;
+if (ReadFilePosition(hVHD->File,
+                     BitMap,
+                     BitMapBytes,
+                     &BytesRead,
+                     VHD_Internal_SectorSize * (uint64)NtoHl (hVHD->BAT[BlockNumber])) ||
+    (BytesRead != BitMapBytes)) {
+    free (BitMap);
+    return NULL;
+    }
+for (i = 0; (i < BlockSectors) && VHD_BITMAP_TEST (BitMap, i); ++i)
+    ;
+if (i == BlockSectors) {
+    free (BitMap);
+    BitMap = VHD_BITMAP_FULL;
+    }
+return hVHD->BitMaps[BlockNumber] = BitMap;
+}
+
+static void
+_VHD_FreeBitMaps(VHDHANDLE hVHD)
+{
+uint32 i;
+
+if (hVHD->BitMaps == NULL)
+    return;
+for (i = 0; i < NtoHl (hVHD->Dynamic.MaxTableEntries); ++i)
+    if (hVHD->BitMaps[i] != VHD_BITMAP_FULL)
+        free (hVHD->BitMaps[i]);
+free (hVHD->BitMaps);
+hVHD->BitMaps = NULL;
+free (hVHD->BitMapDirty);
+hVHD->BitMapDirty = NULL;
+}
+
+/* Write back changed bitmaps and the changed range of the BAT */
+
+static t_stat
+_VHD_FlushMetadata(VHDHANDLE hVHD)
+{
+t_stat r = SCPE_OK;
+
+if ((hVHD == NULL) || (hVHD->File == NULL))
+    return SCPE_OK;
+if (hVHD->BitMapsDirty) {
+    uint32 BitMapBytes = (7 + (NtoHl (hVHD->Dynamic.BlockSize) / VHD_Internal_SectorSize)) / 8;
+    uint32 i;
+
+    for (i = 0; i < NtoHl (hVHD->Dynamic.MaxTableEntries); ++i) {
+        if (!hVHD->BitMapDirty[i])
+            continue;
+        if (WriteFilePosition(hVHD->File,
+                              hVHD->BitMaps[i],
+                              BitMapBytes,
+                              NULL,
+                              VHD_Internal_SectorSize * (uint64)NtoHl (hVHD->BAT[i])))
+            r = SCPE_IOERR;
+        else
+            hVHD->BitMapDirty[i] = 0;
+        }
+    if (r == SCPE_OK)
+        hVHD->BitMapsDirty = FALSE;
+    }
+if (hVHD->BATDirty) {
+    /* The in memory BAT is a whole number of sectors, just like the on disk one */
+    size_t Start = (hVHD->BATDirtyLow * sizeof (*hVHD->BAT)) & ~((size_t)VHD_Internal_SectorSize - 1);
+    size_t End = (hVHD->BATDirtyHigh * sizeof (*hVHD->BAT) + VHD_Internal_SectorSize - 1) & ~((size_t)VHD_Internal_SectorSize - 1);
+
+    if (WriteFilePosition(hVHD->File,
+                          ((uint8 *)hVHD->BAT) + Start,
+                          End - Start,
+                          NULL,
+                          NtoHll (hVHD->Dynamic.TableOffset) + Start))
+        r = SCPE_IOERR;
+    else
+        hVHD->BATDirty = FALSE;
+    }
+return r;
+}
+
 static t_stat sim_vhd_disk_implemented (void)
 {
 return SCPE_OK;
@@ -5051,6 +6778,7 @@ static FILE *sim_vhd_disk_merge (const char *szVHDPath, char **ParentVHD)
     sim_messagef (SCPE_OK, "Merging %s\ninto %s\n", szVHDPath, hVHD->ParentVHDPath);
     for (BlockNumber=NeededBlock=0; BlockNumber < NtoHl (hVHD->Dynamic.MaxTableEntries); ++BlockNumber) {
         uint32 BlockSectors = SectorsPerBlock;
+        uint8 *BitMap;
 
         if (hVHD->BAT[BlockNumber] == VHD_BAT_FREE_ENTRY)
             continue;
@@ -5064,13 +6792,39 @@ static FILE *sim_vhd_disk_merge (const char *szVHDPath, char **ParentVHD)
                              &BytesRead,
                              BlockOffset))
             break;
-        if (WriteVirtualDiskSectors (Parent,
-                                     (uint8*)BlockData,
-                                     BlockSectors,
-                                     &SectorsWritten,
-                                     SectorSize,
-                                     SectorsPerBlock*BlockNumber))
+        BitMap = _VHD_BlockBitMap (hVHD, BlockNumber);
+        if (BitMap == NULL)
             break;
+        if (BitMap == VHD_BITMAP_FULL) {
+            if (WriteVirtualDiskSectors (Parent,
+                                         (uint8*)BlockData,
+                                         BlockSectors,
+                                         &SectorsWritten,
+                                         SectorSize,
+                                         SectorsPerBlock*BlockNumber))
+                break;
+            }
+        else {                          /* Only merge the sectors present in the block */
+            uint32 Sector = 0, RunStart;
+            t_stat r = SCPE_OK;
+
+            while ((Sector < BlockSectors) && (r == SCPE_OK)) {
+                if (!VHD_BITMAP_TEST (BitMap, Sector)) {
+                    ++Sector;
+                    continue;
+                    }
+                for (RunStart = Sector; (Sector < BlockSectors) && VHD_BITMAP_TEST (BitMap, Sector); ++Sector)
+                    ;
+                r = WriteVirtualDiskSectors (Parent,
+                                             (uint8*)BlockData + RunStart*SectorSize,
+                                             Sector - RunStart,
+                                             &SectorsWritten,
+                                             SectorSize,
+                                             SectorsPerBlock*BlockNumber + RunStart);
+                }
+            if (r != SCPE_OK)
+                break;
+            }
         sim_messagef (SCPE_OK, "Merged %dMB.  %d%% complete.\r", (int)((((float)NeededBlock)*SectorsPerBlock)*SectorSize/1000000), (int)((((float)NeededBlock)*100)/BlocksToMerge));
         hVHD->BAT[BlockNumber] = VHD_BAT_FREE_ENTRY;
         }
@@ -5090,6 +6844,7 @@ Cleanup_Return:
     free (BlockData);
     if (hVHD->File)
         fclose (hVHD->File);
+    _VHD_FreeBitMaps (hVHD);
     if (Status) {
         free (hVHD->BAT);
         free (hVHD);
@@ -5112,6 +6867,8 @@ VHDHANDLE hVHD = (VHDHANDLE)f;
 if (NULL != hVHD) {
     if (hVHD->Parent)
         sim_vhd_disk_close ((FILE *)hVHD->Parent);
+    _VHD_FlushMetadata (hVHD);
+    _VHD_FreeBitMaps (hVHD);
     free (hVHD->BAT);
     if (hVHD->File) {
         fflush (hVHD->File);
@@ -5127,8 +6884,10 @@ static void sim_vhd_disk_flush (FILE *f)
 {
 VHDHANDLE hVHD = (VHDHANDLE)f;
 
-if ((NULL != hVHD) && (hVHD->File))
+if ((NULL != hVHD) && (hVHD->File)) {
+    _VHD_FlushMetadata (hVHD);
     fflush (hVHD->File);
+    }
 }
 
 static t_offset sim_vhd_disk_size (FILE *f)
@@ -5696,6 +7455,17 @@ while (BytesToRead && (r == SCPE_OK)) {
     if (BlockNumber != (Offset + BytesToRead) / NtoHl (hVHD->Dynamic.BlockSize))
         BytesInRead = (uint32)(((BlockNumber + 1) * NtoHl (hVHD->Dynamic.BlockSize)) - Offset);
     if (hVHD->BAT[BlockNumber] == VHD_BAT_FREE_ENTRY) {
+        uint32 NextBlock = BlockNumber + 1;
+
+        /* Coalesce following unallocated blocks into a single request */
+        while ((BytesInRead < BytesToRead) &&
+               (NextBlock < NtoHl (hVHD->Dynamic.MaxTableEntries)) &&
+               (hVHD->BAT[NextBlock] == VHD_BAT_FREE_ENTRY)) {
+            BytesInRead += NtoHl (hVHD->Dynamic.BlockSize);
+            if (BytesInRead > BytesToRead)
+                BytesInRead = BytesToRead;
+            ++NextBlock;
+            }
         if (!hVHD->Parent) {
             memset (buf, 0, BytesInRead);
             BytesThisRead = BytesInRead;
@@ -5711,13 +7481,53 @@ while (BytesToRead && (r == SCPE_OK)) {
         }
     else {
         uint64 BlockOffset = VHD_Internal_SectorSize * ((uint64)(NtoHl (hVHD->BAT[BlockNumber]) + BitMapSectors)) + (Offset % NtoHl (hVHD->Dynamic.BlockSize));
+        uint8 *BitMap = hVHD->Parent ? _VHD_BlockBitMap (hVHD, BlockNumber) : VHD_BITMAP_FULL;
 
-        if (ReadFilePosition(hVHD->File,
-                             buf,
-                             BytesInRead,
-                             &BytesThisRead,
-                             BlockOffset))
+        if (BitMap == NULL)
             r = SCPE_IOERR;
+        else {
+            if (BitMap == VHD_BITMAP_FULL) {
+                if (ReadFilePosition(hVHD->File,
+                                     buf,
+                                     BytesInRead,
+                                     &BytesThisRead,
+                                     BlockOffset))
+                    r = SCPE_IOERR;
+                }
+            else {  /* Partially populated block: runs of present sectors come from this file, the rest from the parent */
+                uint32 InBlock = (uint32)(Offset % NtoHl (hVHD->Dynamic.BlockSize));
+
+                while ((BytesThisRead < BytesInRead) && (r == SCPE_OK)) {
+                    uint32 Sector = (InBlock + BytesThisRead) / VHD_Internal_SectorSize;
+                    t_bool Present = (VHD_BITMAP_TEST (BitMap, Sector) != 0);
+                    uint32 RunEnd = (Sector + 1) * VHD_Internal_SectorSize;
+                    uint32 RunBytes;
+
+                    while ((RunEnd < InBlock + BytesInRead) &&
+                           (Present == (VHD_BITMAP_TEST (BitMap, RunEnd / VHD_Internal_SectorSize) != 0)))
+                        RunEnd += VHD_Internal_SectorSize;
+                    if (RunEnd > InBlock + BytesInRead)
+                        RunEnd = InBlock + BytesInRead;
+                    RunBytes = RunEnd - (InBlock + BytesThisRead);
+                    if (Present)
+                        r = ReadFilePosition(hVHD->File,
+                                             buf + BytesThisRead,
+                                             RunBytes,
+                                             NULL,
+                                             BlockOffset + BytesThisRead);
+                    else
+                        r = ReadVirtualDisk(hVHD->Parent,
+                                            buf + BytesThisRead,
+                                            RunBytes,
+                                            NULL,
+                                            Offset + BytesThisRead);
+                    if (r != SCPE_OK)
+                        r = SCPE_IOERR;
+                    else
+                        BytesThisRead += RunBytes;
+                    }
+                }
+            }
         }
     BytesToRead -= BytesThisRead;
     buf = (uint8 *)(((char *)buf) + BytesThisRead);
@@ -5776,6 +7586,50 @@ for (i=0; i<BufferSize; ++i)
 return TRUE;
 }
 
+/* Mark the sectors about to be written in a partially populated block of a
+   differencing disk as present.  Sectors which are only partly covered by
+   the write first get the rest of their contents from the parent. */
+
+static t_stat
+_VHD_PopulateSectors(VHDHANDLE hVHD,
+                     uint32 BlockNumber,
+                     uint8 *BitMap,
+                     uint64 FileOffset,
+                     uint64 Offset,
+                     uint32 BytesToWrite)
+{
+uint32 InBlock = (uint32)(Offset % NtoHl (hVHD->Dynamic.BlockSize));
+uint64 BlockStart = Offset - InBlock;
+uint64 FileBlockStart = FileOffset - InBlock;
+uint32 First = InBlock / VHD_Internal_SectorSize;
+uint32 Last = (InBlock + BytesToWrite - 1) / VHD_Internal_SectorSize;
+uint8 SectorData[VHD_Internal_SectorSize];
+uint32 Sector;
+
+for (Sector = First; Sector <= Last; ++Sector) {
+    if (VHD_BITMAP_TEST (BitMap, Sector))
+        continue;
+    if (((Sector == First) && (InBlock % VHD_Internal_SectorSize)) ||
+        ((Sector == Last) && ((InBlock + BytesToWrite) % VHD_Internal_SectorSize))) {
+        if (ReadVirtualDisk(hVHD->Parent,
+                            SectorData,
+                            VHD_Internal_SectorSize,
+                            NULL,
+                            BlockStart + Sector * VHD_Internal_SectorSize) ||
+            WriteFilePosition(hVHD->File,
+                              SectorData,
+                              VHD_Internal_SectorSize,
+                              NULL,
+                              FileBlockStart + Sector * VHD_Internal_SectorSize))
+            return SCPE_IOERR;
+        }
+    VHD_BITMAP_SET (BitMap, Sector);
+    hVHD->BitMapDirty[BlockNumber] = 1;
+    hVHD->BitMapsDirty = TRUE;
+    }
+return SCPE_OK;
+}
+
 static t_stat
 WriteVirtualDisk(VHDHANDLE hVHD,
                  uint8 *buf,
@@ -5826,10 +7680,7 @@ while (BytesToWrite && (r == SCPE_OK)) {
         uint8 *BitMap = NULL;
         uint32 BitMapBufferSize = VHD_DATA_BLOCK_ALIGNMENT;
         uint8 *BitMapBuffer = NULL;
-        void *BlockData = NULL;
-        uint8 *BATUpdateBufferAddress;
-        uint32 BATUpdateBufferSize;
-        uint64 BATUpdateStorageAddress;
+        uint8 *BlockData;
         uint64 BlockOffset;
 
         if (!hVHD->Parent && BufferIsZeros(buf, BytesInWrite)) {
@@ -5843,11 +7694,21 @@ while (BytesToWrite && (r == SCPE_OK)) {
         if ((BitMapSectors * VHD_Internal_SectorSize) > BitMapBufferSize)
             BitMapBufferSize = BitMapSectors * VHD_Internal_SectorSize;
         BitMapBuffer = (uint8 *)calloc(1, BitMapBufferSize + NtoHl(hVHD->Dynamic.BlockSize));
-        if (BitMapBufferSize > BitMapSectors * VHD_Internal_SectorSize)
-            BitMap = BitMapBuffer + BitMapBufferSize - BitMapBytes;
-        else
-            BitMap = BitMapBuffer;
+        if (BitMapBuffer == NULL)
+            return SCPE_MEM;
+        BitMap = BitMapBuffer + BitMapBufferSize - (BitMapSectors * VHD_Internal_SectorSize);
         memset(BitMap, 0xFF, BitMapBytes);
+        /* The new block is written once, already containing its initial contents
+           (from the parent when differencing) merged with the data being written */
+        BlockData = BitMapBuffer + BitMapBufferSize;
+        if (hVHD->Parent &&
+            ReadVirtualDisk(hVHD->Parent,
+                            BlockData,
+                            NtoHl (hVHD->Dynamic.BlockSize),
+                            NULL,
+                            (Offset / NtoHl (hVHD->Dynamic.BlockSize)) * NtoHl (hVHD->Dynamic.BlockSize)))
+            goto Fatal_IO_Error;
+        memcpy (BlockData + (Offset % NtoHl (hVHD->Dynamic.BlockSize)), buf, BytesInWrite);
         BlockOffset -= sizeof(hVHD->Footer);
         if (0 == (BlockOffset & (VHD_DATA_BLOCK_ALIGNMENT-1)))
             {  // Already aligned, so use padded BitMapBuffer
@@ -5855,10 +7716,8 @@ while (BytesToWrite && (r == SCPE_OK)) {
                                   BitMapBuffer,
                                   BitMapBufferSize + NtoHl(hVHD->Dynamic.BlockSize),
                                   NULL,
-                                  BlockOffset)) {
-                free (BitMapBuffer);
-                return SCPE_IOERR;
-                }
+                                  BlockOffset))
+                goto Fatal_IO_Error;
             BlockOffset += BitMapBufferSize;
             }
         else
@@ -5874,10 +7733,8 @@ while (BytesToWrite && (r == SCPE_OK)) {
                                   BitMap,
                                   (BitMapSectors * VHD_Internal_SectorSize) + NtoHl(hVHD->Dynamic.BlockSize),
                                   NULL,
-                                  BlockOffset)) {
-                free (BitMapBuffer);
-                return SCPE_IOERR;
-                }
+                                  BlockOffset))
+                goto Fatal_IO_Error;
             BlockOffset += BitMapSectors * VHD_Internal_SectorSize;
             }
         free(BitMapBuffer);
@@ -5885,70 +7742,45 @@ while (BytesToWrite && (r == SCPE_OK)) {
         /* the BAT block address is the beginning of the block bitmap */
         BlockOffset -= BitMapSectors * VHD_Internal_SectorSize;
         hVHD->BAT[BlockNumber] = NtoHl((uint32)(BlockOffset / VHD_Internal_SectorSize));
+        if (hVHD->BitMaps)
+            hVHD->BitMaps[BlockNumber] = VHD_BITMAP_FULL;
         BlockOffset += (BitMapSectors * VHD_Internal_SectorSize) + NtoHl(hVHD->Dynamic.BlockSize);
+        /* Keep the file valid by moving the footer to the new end of file now.
+           The BAT entry is written back with any others allocated before the
+           next flush (or close) of this disk */
+        if (!hVHD->BATDirty || (BlockNumber < hVHD->BATDirtyLow))
+            hVHD->BATDirtyLow = BlockNumber;
+        if (!hVHD->BATDirty || (BlockNumber >= hVHD->BATDirtyHigh))
+            hVHD->BATDirtyHigh = BlockNumber + 1;
+        hVHD->BATDirty = TRUE;
         if (WriteFilePosition(hVHD->File,
                               &hVHD->Footer,
                               sizeof(hVHD->Footer),
                               NULL,
                               BlockOffset))
-            goto Fatal_IO_Error;
-        /* Since a large VHD can have a pretty large BAT, and we've only changed one longword bat entry
-           in the current BAT, we write just the aligned sector which contains the updated BAT entry */
-        BATUpdateBufferAddress = (uint8 *)hVHD->BAT - (size_t)NtoHll(hVHD->Dynamic.TableOffset) + 
-            (size_t)((((size_t)&hVHD->BAT[BlockNumber]) - (size_t)hVHD->BAT + (size_t)NtoHll(hVHD->Dynamic.TableOffset)) & ~(VHD_DATA_BLOCK_ALIGNMENT-1));
-        /* If the starting of the BAT isn't on a VHD_DATA_BLOCK_ALIGNMENT boundary and we've just updated 
-           a BAT entry early in the array, the buffer computed address might be before the start of the
-           BAT table.  If so, only write the BAT data needed */
-        if (BATUpdateBufferAddress < (uint8 *)hVHD->BAT) {
-            BATUpdateBufferAddress = (uint8 *)hVHD->BAT;
-            BATUpdateBufferSize = (uint32)((((size_t)&hVHD->BAT[BlockNumber]) - (size_t)hVHD->BAT) + 512) & ~511;
-            BATUpdateStorageAddress = NtoHll(hVHD->Dynamic.TableOffset);
-            }
-        else {
-            BATUpdateBufferSize = VHD_DATA_BLOCK_ALIGNMENT;
-            BATUpdateStorageAddress = NtoHll(hVHD->Dynamic.TableOffset) + BATUpdateBufferAddress - ((uint8 *)hVHD->BAT);
-            }
-        /* If the total BAT is smaller than one VHD_DATA_BLOCK_ALIGNMENT, then be sure to only write out the BAT data */
-        if ((size_t)(BATUpdateBufferAddress - (uint8 *)hVHD->BAT + BATUpdateBufferSize) > VHD_Internal_SectorSize * ((sizeof(*hVHD->BAT)*NtoHl(hVHD->Dynamic.MaxTableEntries) + VHD_Internal_SectorSize - 1)/VHD_Internal_SectorSize))
-            BATUpdateBufferSize = (uint32)(VHD_Internal_SectorSize * ((sizeof(*hVHD->BAT) * NtoHl(hVHD->Dynamic.MaxTableEntries) + VHD_Internal_SectorSize - 1)/VHD_Internal_SectorSize) - (BATUpdateBufferAddress - ((uint8 *)hVHD->BAT)));
-        if (WriteFilePosition(hVHD->File,
-                              BATUpdateBufferAddress,
-                              BATUpdateBufferSize,
-                              NULL,
-                              BATUpdateStorageAddress))
-            goto Fatal_IO_Error;
-        if (hVHD->Parent)
-            { /* Need to populate data block contents from parent VHD */
-            BlockData = malloc (NtoHl (hVHD->Dynamic.BlockSize));
-
-            if (ReadVirtualDisk(hVHD->Parent,
-                                (uint8*) BlockData,
-                                NtoHl (hVHD->Dynamic.BlockSize),
-                                NULL,
-                                (Offset / NtoHl (hVHD->Dynamic.BlockSize)) * NtoHl (hVHD->Dynamic.BlockSize)))
-                goto Fatal_IO_Error;
-            if (WriteVirtualDisk(hVHD,
-                                 (uint8*) BlockData,
-                                 NtoHl (hVHD->Dynamic.BlockSize),
-                                 NULL,
-                                 (Offset / NtoHl (hVHD->Dynamic.BlockSize)) * NtoHl (hVHD->Dynamic.BlockSize)))
-                goto Fatal_IO_Error;
-            free(BlockData);
-            }
-        continue;
+            r = SCPE_IOERR;
+        else
+            BytesThisWrite = BytesInWrite;
+        goto IO_Done;
 Fatal_IO_Error:
-        free (BitMap);
-        free (BlockData);
+        free (BitMapBuffer);
         r = SCPE_IOERR;
         }
     else {
         uint64 BlockOffset = VHD_Internal_SectorSize * ((uint64)(NtoHl(hVHD->BAT[BlockNumber]) + BitMapSectors)) + (Offset % NtoHl(hVHD->Dynamic.BlockSize));
+        uint8 *BitMap = hVHD->Parent ? _VHD_BlockBitMap (hVHD, BlockNumber) : VHD_BITMAP_FULL;
 
-        if (WriteFilePosition(hVHD->File,
-                              buf,
-                              BytesInWrite,
-                              &BytesThisWrite,
-                              BlockOffset))
+        if (BitMap == NULL)
+            r = SCPE_IOERR;
+        else
+            if (BitMap != VHD_BITMAP_FULL)
+                r = _VHD_PopulateSectors (hVHD, BlockNumber, BitMap, BlockOffset, Offset, BytesInWrite);
+        if ((r == SCPE_OK) &&
+            (WriteFilePosition(hVHD->File,
+                               buf,
+                               BytesInWrite,
+                               &BytesThisWrite,
+                               BlockOffset)))
             r = SCPE_IOERR;
         }
 IO_Done:
@@ -6137,6 +7969,368 @@ struct disk_test_coverage {
     uint32 *data;
     };
 
+#if defined (SIM_ASYNCH_IO)
+static uint32 disk_test_callbacks;
+static t_stat disk_test_cbstat;
+
+static void sim_disk_test_callback (UNIT *uptr, t_stat status)
+{
+++disk_test_callbacks;
+if (status != SCPE_OK)
+    disk_test_cbstat = status;
+}
+
+/* Issue several asynchronous reads back to back and check that all of
+   them complete, in one dispatch, with the expected data */
+
+static t_stat sim_disk_test_async (UNIT *uptr, uint32 *data, t_seccnt sectors, t_lba total_sectors)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 uint32s_per_sector = (ctx->sector_size / sizeof (*data));
+t_seccnt sects_read[8];
+t_lba lba;
+uint32 i, j, n = 8;
+
+if (!ctx->asynch_io)
+    return SCPE_OK;
+if (sectors > total_sectors / n)
+    sectors = total_sectors / n;
+if (sectors == 0)
+    return SCPE_OK;
+disk_test_callbacks = 0;
+disk_test_cbstat = SCPE_OK;
+for (i = 0; i < n; i++)
+    sim_disk_rdsect_a (uptr, i * sectors, (uint8 *)(data + i * sectors * uint32s_per_sector), &sects_read[i], sectors, sim_disk_test_callback);
+_disk_cancel (uptr);                                    /* wait for the I/O thread */
+AIO_UPDATE_QUEUE;                                       /* dispatch completions */
+sim_cancel (uptr);
+if ((disk_test_callbacks != n) || (disk_test_cbstat != SCPE_OK) || _disk_is_active (uptr)) {
+    sim_printf ("Asynchronous reads: %u of %u completed, status: %s\n", disk_test_callbacks, n, sim_error_text (disk_test_cbstat));
+    return SCPE_IERR;
+    }
+for (i = 0; i < n * sectors; i++) {
+    lba = i;
+    if (sects_read[i / sectors] != sectors)
+        return SCPE_IERR;
+    for (j = 0; j < uint32s_per_sector; j++)
+        if (data[i * uint32s_per_sector + j] != lba) {
+            sim_printf ("Asynchronous read of sector %u has unexpected data at offset 0x%X: 0x%08X\n", lba, j, data[i * uint32s_per_sector + j]);
+            return SCPE_IERR;
+            }
+    }
+sim_printf ("Asynchronous reads OK\n");
+return SCPE_OK;
+}
+#endif
+
+/* Overwrite part of the container at random through a small block cache
+   (so lines are evicted and written back) in write-back and then in
+   write-through mode, checking reads along the way and the container
+   contents afterwards */
+
+static t_stat sim_disk_test_cache (UNIT *uptr, uint32 *data, t_lba total_sectors)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 uint32s_per_sector = (ctx->sector_size / sizeof (*data));
+size_t saved_limit = disk_cache.limit;
+t_bool saved_writeback = disk_cache.writeback;
+t_lba region = (total_sectors < 512) ? total_sectors : 512;
+uint8 *gen = (uint8 *)calloc (region, sizeof (*gen));
+t_seccnt sects, done;
+t_lba lba, i;
+uint32 j, pass, op;
+t_stat r = SCPE_OK;
+
+if ((gen == NULL) || (ctx->cache_spl == 0) || (region < 2)) {
+    free (gen);
+    return SCPE_OK;
+    }
+#define CACHE_TEST_DATA(l) ((uint32)(l) + ((uint32)gen[l] << 24))
+for (pass = 0; (pass < 2) && (r == SCPE_OK); pass++) {
+    r = _disk_cache_set_size (1, "64K");
+    disk_cache.writeback = (pass == 0);
+    for (op = 0; (op < 2000) && (r == SCPE_OK); op++) {
+        lba = rand () % region;
+        sects = 1 + rand () % ((region - lba < 32) ? region - lba : 32);
+        if (rand () & 1) {
+            for (i = 0; i < sects; i++) {
+                ++gen[lba + i];
+                for (j = 0; j < uint32s_per_sector; j++)
+                    data[i * uint32s_per_sector + j] = CACHE_TEST_DATA(lba + i);
+                }
+            r = sim_disk_wrsect (uptr, lba, (uint8 *)data, &done, sects);
+            }
+        else {
+            r = sim_disk_rdsect (uptr, lba, (uint8 *)data, &done, sects);
+            for (i = 0; (i < sects) && (r == SCPE_OK); i++)
+                for (j = 0; j < uint32s_per_sector; j++)
+                    if (data[i * uint32s_per_sector + j] != CACHE_TEST_DATA(lba + i)) {
+                        sim_printf ("Cached read of sector %u has unexpected data at offset 0x%X: 0x%08X\n", lba + i, j, data[i * uint32s_per_sector + j]);
+                        r = SCPE_IERR;
+                        break;
+                        }
+            }
+        if ((r == SCPE_OK) && (done != sects))
+            r = SCPE_INCOMP;
+        }
+    if (r == SCPE_OK)
+        r = sim_disk_flush (uptr);
+    if (r == SCPE_OK)
+        r = _disk_cache_set_size (0, NULL);
+    for (lba = 0; (lba < region) && (r == SCPE_OK); lba++) {
+        r = sim_disk_rdsect (uptr, lba, (uint8 *)data, NULL, 1);
+        for (j = 0; (j < uint32s_per_sector) && (r == SCPE_OK); j++)
+            if (data[j] != CACHE_TEST_DATA(lba)) {
+                sim_printf ("Sector %u was not written back (offset 0x%X: 0x%08X)\n", lba, j, data[j]);
+                r = SCPE_IERR;
+                }
+        }
+    }
+#undef CACHE_TEST_DATA
+free (gen);
+_disk_cache_set_size (0, NULL);
+if (saved_limit) {
+    char size[32];
+
+    snprintf (size, sizeof (size), "%uK", (uint32)(saved_limit / 1024));
+    _disk_cache_set_size (1, size);
+    }
+disk_cache.writeback = saved_writeback;
+if (r == SCPE_OK)
+    sim_printf ("Cached reads and writes OK\n");
+return r;
+}
+
+/* Check that a container byte range holds no data.  Returns SCPE_OK
+   if it is all hole, SCPE_IERR if not and SCPE_NOFNC if the host can't
+   tell.  The granularity of holes is returned in blksize. */
+
+static t_stat _sim_disk_test_hole (UNIT *uptr, t_offset addr, t_offset bytes, t_offset *blksize)
+{
+#if (defined (__linux) || defined (__linux__)) && defined (SEEK_DATA)
+struct stat statb;
+off_t pos, data;
+int fd, err;
+
+if (DK_GET_FMT (uptr) == DKUF_F_STD) {
+    fflush (uptr->fileref);
+    fd = fileno (uptr->fileref);
+    }
+else
+    fd = (int)((long)uptr->fileref);
+if (fstat (fd, &statb) || !S_ISREG (statb.st_mode))
+    return SCPE_NOFNC;
+*blksize = (t_offset)statb.st_blksize;
+if (bytes == 0)
+    return SCPE_OK;
+pos = lseek (fd, 0, SEEK_CUR);
+data = lseek (fd, (off_t)addr, SEEK_DATA);
+err = errno;
+lseek (fd, pos, SEEK_SET);
+if (data == (off_t)-1)                                  /* hole up to the end? */
+    return (err == ENXIO) ? SCPE_OK : SCPE_NOFNC;
+return (data >= (off_t)(addr + bytes)) ? SCPE_OK : SCPE_IERR;
+#else
+return SCPE_NOFNC;
+#endif
+}
+
+/* Write buffers mixing runs of zero and non zero sectors over existing
+   data (so runs of zeros may become holes in sparse containers) and
+   check that they read back correctly.  When holes were punched, the
+   host blocks lying wholly inside the zero runs must hold no data. */
+
+static t_stat sim_disk_test_sparse (UNIT *uptr, uint32 *data, t_lba total_sectors)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 uint32s_per_sector = (ctx->sector_size / sizeof (*data));
+static const uint32 zero_masks[] = {0xFFFFFFFF, 0xFFFF9FFE, 0x00000000, 0x7FFFFFFF, 0xFFFFFFFE, 0x00FF00FF};
+t_seccnt sects = (total_sectors < 32) ? (t_seccnt)total_sectors : 32;
+t_seccnt done;
+t_lba lba;
+t_uint64 holes;
+t_offset first, last, blksize = 0;
+uint32 m, i, j, z;
+t_stat r = SCPE_OK;
+
+for (m = 0; (m < sizeof (zero_masks) / sizeof (zero_masks[0])) && (r == SCPE_OK); m++) {
+    lba = (m * sects) % (total_sectors - sects + 1);
+    for (i = 0; i < sects * uint32s_per_sector; i++)
+        data[i] = 0xFFFFFFFF - lba;
+    r = sim_disk_wrsect (uptr, lba, (uint8 *)data, &done, sects);
+    holes = disk_hole_sects;
+    for (i = 0; i < sects; i++)
+        for (j = 0; j < uint32s_per_sector; j++)
+            data[i * uint32s_per_sector + j] = (zero_masks[m] & (1u << i)) ? 0 : (lba + i + 1);
+    if (r == SCPE_OK)
+        r = sim_disk_wrsect (uptr, lba, (uint8 *)data, &done, sects);
+    if ((r == SCPE_OK) && (done != sects))
+        r = SCPE_INCOMP;
+    if ((r == SCPE_OK) && (disk_hole_sects != holes) &&  /* holes punched? */
+        (_sim_disk_test_hole (uptr, 0, 0, &blksize) == SCPE_OK) && (blksize > 0)) {
+        for (i = 0; (i < sects) && (r == SCPE_OK); i = z + 1) {
+            for (z = i; (z < sects) && (zero_masks[m] & (1u << z)); z++)
+                ;
+            if ((z - i) * ctx->sector_size < DISK_HOLE_MIN)
+                continue;
+            first = ((t_offset)(lba + i) * ctx->sector_size + blksize - 1) / blksize;
+            last = ((t_offset)(lba + z) * ctx->sector_size) / blksize;
+            if ((last > first) &&                       /* whole host blocks? */
+                (_sim_disk_test_hole (uptr, first * blksize, (last - first) * blksize, &blksize) == SCPE_IERR)) {
+                sim_printf ("Zero sectors %u-%u were not made a hole\n", lba + i, lba + z - 1);
+                r = SCPE_IERR;
+                }
+            }
+        }
+    memset (data, 0xA5, sects * ctx->sector_size);
+    if (r == SCPE_OK)
+        r = sim_disk_rdsect (uptr, lba, (uint8 *)data, &done, sects);
+    for (i = 0; (i < sects) && (r == SCPE_OK); i++)
+        for (j = 0; j < uint32s_per_sector; j++)
+            if (data[i * uint32s_per_sector + j] != ((zero_masks[m] & (1u << i)) ? 0 : (lba + i + 1))) {
+                sim_printf ("Sector %u has unexpected data at offset 0x%X: 0x%08X\n", lba + i, j, data[i * uint32s_per_sector + j]);
+                r = SCPE_IERR;
+                break;
+                }
+    }
+if (r == SCPE_OK)
+    sim_printf ("Zero sector writes OK\n");
+return r;
+}
+
+/* Write through a snapshot overlay of the (SIMH or RAW) test container
+   and check the data through the overlay, that the base is unchanged,
+   that a reattached overlay still has the data and finally that merging
+   the overlay leaves the data in the base (which is left attached) */
+
+static t_stat sim_disk_test_snapshot (UNIT *uptr, uint32 *data, t_lba total_sectors)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 ss = ctx->sector_size, xfer = ctx->xfer_element_size;
+uint32 uint32s_per_sector = (ss / sizeof (*data));
+t_seccnt chunk_sects = (ss < DISK_SNAP_CHUNK) ? DISK_SNAP_CHUNK / ss : 1;
+t_seccnt sects = 4 * chunk_sects + 3, wsects = 2 * chunk_sects, done;
+t_lba lba = chunk_sects / 2 + 1, wlba = lba + chunk_sects / 3 + 1;
+uint32 *orig;
+char base[CBUFSIZE], overlay[CBUFSIZE + sizeof (".snap")], cmd[sizeof (overlay) + sizeof (base) + 1];
+int32 saved_switches = sim_switches;
+int pass;
+uint32 i, j;
+t_stat r;
+
+if (lba + sects > total_sectors)
+    return SCPE_OK;
+orig = (uint32 *)malloc (sects * ss);
+if (orig == NULL)
+    return SCPE_MEM;
+strlcpy (base, uptr->filename, sizeof (base));
+snprintf (overlay, sizeof (overlay), "%s.snap", base);
+(void)remove (overlay);
+r = sim_disk_rdsect (uptr, lba, (uint8 *)orig, &done, sects);
+sim_disk_detach (uptr);
+snprintf (cmd, sizeof (cmd), "%s %s", overlay, base);
+sim_switches = SWMASK ('S');
+if (r == SCPE_OK)
+    r = sim_disk_attach_ex (uptr, cmd, ss, xfer, TRUE, 0, NULL, 0, 0, NULL);
+for (i = 0; i < wsects * uint32s_per_sector; i++)
+    data[i] = 0xC0000000 | (wlba + i / uint32s_per_sector);
+if (r == SCPE_OK)
+    r = sim_disk_wrsect (uptr, wlba, (uint8 *)data, &done, wsects);
+/* check through the overlay, the unchanged base, the reattached overlay and the merged base */
+for (pass = 0; (pass < 4) && (r == SCPE_OK); pass++) {
+    if (pass > 0) {
+        sim_disk_detach (uptr);
+        sim_switches = (pass == 3) ? SWMASK ('M') : 0;
+        r = sim_disk_attach_ex (uptr, (pass == 1) ? base : overlay, ss, xfer, TRUE, 0, NULL, 0, 0, NULL);
+        if (r != SCPE_OK)
+            break;
+        }
+    memset (data, 0xA5, sects * ss);
+    r = sim_disk_rdsect (uptr, lba, (uint8 *)data, &done, sects);
+    for (i = 0; (i < sects) && (r == SCPE_OK); i++)
+        for (j = 0; j < uint32s_per_sector; j++) {
+            uint32 expected = ((pass != 1) && (lba + i >= wlba) && (lba + i < wlba + wsects)) ? (0xC0000000 | (lba + i)) : orig[i * uint32s_per_sector + j];
+
+            if (data[i * uint32s_per_sector + j] != expected) {
+                sim_printf ("Snapshot pass %d: Sector %u has unexpected data at offset 0x%X: 0x%08X\n", pass, lba + i, j, data[i * uint32s_per_sector + j]);
+                r = SCPE_IERR;
+                break;
+                }
+            }
+    }
+if (r == SCPE_OK) {                                     /* merged base is attached by its full path */
+    char *fullbase = sim_filepath_parts (base, "f");
+
+    if ((fullbase == NULL) || (strcmp (uptr->filename, fullbase) != 0))
+        r = SCPE_IERR;
+    free (fullbase);
+    }
+sim_switches = saved_switches;
+free (orig);
+if (r == SCPE_OK)
+    sim_printf ("Snapshot overlay OK\n");
+return r;
+}
+
+/* Reattach the test container read only, which maps SIMH and RAW
+   containers when the host can, and check that reads, including ones
+   which run past the end of the container, return the same data as
+   before.  The container is then reattached as it was. */
+
+static t_stat sim_disk_test_mmap (UNIT *uptr, uint32 *data, t_lba total_sectors)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 ss = ctx->sector_size, xfer = ctx->xfer_element_size;
+t_seccnt sects = (total_sectors < 64) ? (t_seccnt)total_sectors : 64;
+t_lba lbas[3];
+uint8 *expected;
+char filename[CBUFSIZE];
+int32 saved_switches = sim_switches;
+t_seccnt done[3], mdone;
+t_addr saved_capac = uptr->capac;
+t_bool mapped = FALSE;
+int i;
+t_stat r = SCPE_OK;
+
+lbas[0] = 0;
+lbas[1] = total_sectors / 3 + 1;
+lbas[2] = total_sectors - sects / 2;                    /* runs past the end */
+expected = (uint8 *)malloc (3 * sects * ss);
+if (expected == NULL)
+    return SCPE_MEM;
+for (i = 0; (i < 3) && (r == SCPE_OK); i++)
+    r = sim_disk_rdsect (uptr, lbas[i], expected + i * sects * ss, &done[i], sects);
+strlcpy (filename, uptr->filename, sizeof (filename));
+sim_disk_detach (uptr);
+sim_switches = SWMASK ('R');
+if (r == SCPE_OK)                                       /* autosize since read only containers can't grow */
+    r = sim_disk_attach_ex (uptr, filename, ss, xfer, FALSE, 0, NULL, 0, 0, NULL);
+sim_switches = saved_switches;
+if (r != SCPE_OK) {
+    free (expected);
+    return r;
+    }
+ctx = (struct disk_context *)uptr->disk_ctx;
+mapped = (ctx->map != NULL);
+for (i = 0; (i < 3) && (r == SCPE_OK); i++) {
+    memset (data, 0xA5, sects * ss);
+    r = sim_disk_rdsect (uptr, lbas[i], (uint8 *)data, &mdone, sects);
+    if ((r == SCPE_OK) &&
+        ((mdone != done[i]) || (memcmp (data, expected + i * sects * ss, mdone * ss) != 0))) {
+        sim_printf ("Read only reread of %u sectors at lba %u differs\n", sects, lbas[i]);
+        r = SCPE_IERR;
+        }
+    }
+free (expected);
+sim_disk_detach (uptr);
+uptr->capac = saved_capac;
+if (r == SCPE_OK)
+    r = sim_disk_attach_ex (uptr, filename, ss, xfer, TRUE, 0, NULL, 0, 0, NULL);
+if (r == SCPE_OK)
+    sim_printf ("Read only %s reads OK\n", mapped ? "mapped" : "unmapped");
+return r;
+}
+
 static t_stat sim_disk_test_exercise (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
@@ -6234,6 +8428,18 @@ if (r == SCPE_OK) {
         r = SCPE_IERR;
         }
     }
+#if defined (SIM_ASYNCH_IO)
+if (r == SCPE_OK)
+    r = sim_disk_test_async (uptr, c->data, c->max_xfer_sectors / 8, c->total_sectors);
+#endif
+if (r == SCPE_OK)
+    r = sim_disk_test_cache (uptr, c->data, c->total_sectors);
+if (r == SCPE_OK)
+    r = sim_disk_test_sparse (uptr, c->data, c->total_sectors);
+if ((r == SCPE_OK) && (DK_GET_FMT (uptr) != DKUF_F_VHD))
+    r = sim_disk_test_snapshot (uptr, c->data, c->total_sectors);
+if (r == SCPE_OK)
+    r = sim_disk_test_mmap (uptr, c->data, c->total_sectors);
 free (c->data);
 free (c->wbitmap);
 free (c);
@@ -112,6 +112,10 @@ t_bool sim_disk_vhd_support (void);
 t_bool sim_disk_raw_support (void);
 void sim_disk_data_trace (UNIT *uptr, const uint8 *data, size_t lba, size_t len, const char* txt, int detail, uint32 reason);
 t_stat sim_disk_info_cmd (int32 flag, CONST char *ptr);
+t_stat sim_disk_flush (UNIT *uptr);
+t_stat sim_disk_set_cache (int32 flag, CONST char *cptr);
+t_stat sim_disk_show_cache (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat sim_disk_show_disk (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat sim_disk_test (DEVICE *dptr);
 
 #ifdef  __cplusplus
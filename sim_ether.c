@@ -1885,6 +1885,17 @@ _eth_write(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine);
 static void
 _eth_error(ETH_DEV* dev, const char* where);
 
+#if defined (USE_READER_THREAD)
+/* Frames the reader thread drains per wakeup and stages in the read 
+   queue before making them all visible at once.  glibc only declares
+   recvmmsg when _GNU_SOURCE is defined */
+#define ETH_READ_BATCH 32
+#define ETH_READ_RING_SIZE (256*1024)                   /* read queue arena bytes (power of 2) */
+#if (defined(__linux) || defined(__linux__)) && defined(_GNU_SOURCE) && defined(MSG_WAITFORONE)
+#define ETH_HAVE_RECVMMSG 1
+#endif
+#endif
+
 #if defined(HAVE_SLIRP_NETWORK)
 static void _slirp_callback (void *opaque, const unsigned char *buf, int len)
 {
@@ -1897,6 +1908,182 @@ _eth_callback((u_char *)opaque, &header, buf);
 #endif
 
 #if defined (USE_READER_THREAD)
+/* Receive ring
+
+   The read queue between the reader thread (the only producer) and the
+   simulator thread calling eth_read (the only consumer) is a lock free
+   ring of variable length packet records in one contiguous arena.  A
+   record is a small header followed by just the bytes of the frame, so
+   a minimum size frame occupies 72 bytes rather than a full ETH_PACK.
+   A record never wraps; when one won't fit at the end of the arena a
+   wrap marker sends the consumer back to the start.
+
+   head and tail are free running byte offsets.  The producer writes
+   records beyond tail and publishes them as a batch by advancing tail;
+   the consumer advances head as it removes them.  Each side only reads
+   the other's offset, so the ordering provided by acquire loads and
+   release stores is all the synchronization needed.  When the arena is
+   full the arriving frame is dropped and counted, as a real controller
+   drops frames when it has no receive buffers.
+ */
+
+struct eth_ring_rec {
+  uint32              len;                              /* packet length without CRC, or ETH_RING_WRAP */
+  uint32              crc_len;                          /* packet length with CRC */
+  };
+
+#define ETH_RING_WRAP       0xFFFFFFFF
+#define ETH_RING_ALIGN      8
+#define ETH_RING_RECSIZE(bytes) ((sizeof (struct eth_ring_rec) + (bytes) + ETH_RING_ALIGN - 1) & ~(ETH_RING_ALIGN - 1))
+
+#if defined (__ATOMIC_ACQUIRE)
+#define ETH_RING_LOAD(var)          __atomic_load_n (&(var), __ATOMIC_ACQUIRE)
+#define ETH_RING_STORE(var, val)    __atomic_store_n (&(var), (val), __ATOMIC_RELEASE)
+#elif defined (_WIN32) || defined (__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+#if defined (_WIN32)
+#define ETH_RING_BARRIER()          MemoryBarrier ()
+#else
+#define ETH_RING_BARRIER()          __sync_synchronize ()
+#endif
+#define ETH_RING_LOAD(var)          _eth_ring_load (&(var))
+#define ETH_RING_STORE(var, val)    do {ETH_RING_BARRIER (); (var) = (val);} while (0)
+
+static uint32 _eth_ring_load (volatile uint32 *var)
+{
+uint32 val = *var;
+
+ETH_RING_BARRIER ();
+return val;
+}
+#else
+/* No memory barriers available, serialize ring access with dev->lock */
+#define ETH_RING_LOCKED     1
+#define ETH_RING_LOAD(var)          (var)
+#define ETH_RING_STORE(var, val)    (var) = (val)
+#endif
+#if defined (ETH_RING_LOCKED)
+#define ETH_RING_LOCK(dev)          pthread_mutex_lock (&(dev)->lock)
+#define ETH_RING_UNLOCK(dev)        pthread_mutex_unlock (&(dev)->lock)
+#else
+#define ETH_RING_LOCK(dev)
+#define ETH_RING_UNLOCK(dev)
+#endif
+
+static t_stat _eth_ring_init (ETH_RING* ring, uint32 size)
+{
+memset (ring, 0, sizeof (*ring));
+ring->arena = (uint8 *)malloc (size);
+if (!ring->arena) {
+  sim_printf("EthQ: failed to allocate receive ring[%d]\n", (int)size);
+  return SCPE_MEM;
+  }
+ring->size = size;
+return SCPE_OK;
+}
+
+static void _eth_ring_destroy (ETH_RING* ring)
+{
+free (ring->arena);
+memset (ring, 0, sizeof (*ring));
+}
+
+/* Producer: append a packet to the ring without making it visible */
+static int _eth_ring_put (ETH_RING* ring, const uint8 *data, uint32 len, uint32 crc_len, const uint8 *crc_data)
+{
+uint32 bytes = (len > crc_len) ? len : crc_len;
+uint32 need = ETH_RING_RECSIZE (bytes);
+uint32 offset = ring->fill & (ring->size - 1);
+uint32 room = ring->size - (ring->fill - ETH_RING_LOAD (ring->head));
+uint32 skip = (offset + need > ring->size) ? ring->size - offset : 0;
+struct eth_ring_rec *rec;
+
+if (skip + need > room) {
+  ++ring->loss;
+  return 0;
+  }
+if (skip) {
+  ((struct eth_ring_rec *)(ring->arena + offset))->len = ETH_RING_WRAP;
+  ring->fill += skip;
+  offset = 0;
+  }
+rec = (struct eth_ring_rec *)(ring->arena + offset);
+rec->len = len;
+rec->crc_len = crc_len;
+if (crc_data && (crc_len > len)) {
+  memcpy (rec + 1, data, len);
+  memcpy ((uint8 *)(rec + 1) + len, crc_data, ETH_CRC_SIZE);
+  }
+else
+  memcpy (rec + 1, data, bytes);
+ring->fill += need;
+++ring->staged;
+return 1;
+}
+
+/* Producer: make the staged packets visible to the consumer and update
+   the high water marks.  Returns the number of packets in the ring. */
+static uint32 _eth_ring_publish (ETH_RING* ring)
+{
+uint32 count, bytes;
+
+if (ring->staged) {
+  ETH_RING_STORE (ring->produced, ring->produced + ring->staged);
+  ETH_RING_STORE (ring->tail, ring->fill);
+  ring->staged = 0;
+  }
+count = ring->produced - ETH_RING_LOAD (ring->consumed);
+bytes = ring->tail - ETH_RING_LOAD (ring->head);
+if (count > ring->high)
+  ring->high = count;
+if (bytes > ring->high_bytes)
+  ring->high_bytes = bytes;
+return count;
+}
+
+/* Consumer: remove the oldest packet, copying it to packet if provided */
+static int _eth_ring_get (ETH_RING* ring, ETH_PACK* packet)
+{
+uint32 head = ring->head;
+struct eth_ring_rec *rec;
+uint32 bytes;
+
+if (head == ETH_RING_LOAD (ring->tail))
+  return 0;
+rec = (struct eth_ring_rec *)(ring->arena + (head & (ring->size - 1)));
+if (rec->len == ETH_RING_WRAP) {
+  head += ring->size - (head & (ring->size - 1));
+  rec = (struct eth_ring_rec *)ring->arena;
+  }
+bytes = (rec->len > rec->crc_len) ? rec->len : rec->crc_len;
+if (packet) {
+  packet->len = rec->len;
+  packet->crc_len = rec->crc_len;
+  memcpy (packet->msg, rec + 1, bytes);
+  }
+ETH_RING_STORE (ring->consumed, ring->consumed + 1);
+ETH_RING_STORE (ring->head, head + ETH_RING_RECSIZE (bytes));
+return 1;
+}
+
+static uint32 _eth_ring_count (ETH_RING* ring)
+{
+return ETH_RING_LOAD (ring->produced) - ETH_RING_LOAD (ring->consumed);
+}
+
+/* Make the frames the reader thread has put in the ring since the last
+   call visible to the simulator with a single release of the ring tail.
+   Returns non-zero if the ring has frames for the simulator to consume. */
+static int
+_eth_queue_batch (ETH_DEV* dev)
+{
+uint32 count;
+
+ETH_RING_LOCK (dev);
+count = _eth_ring_publish (&dev->read_queue);
+ETH_RING_UNLOCK (dev);
+return (count != 0);
+}
+
 static void *
 _eth_reader(void *arg)
 {
@@ -1905,6 +2092,11 @@ int status = 0;
 int sel_ret = 0;
 int do_select = 0;
 SOCKET select_fd = 0;
+#if defined (ETH_HAVE_RECVMMSG)
+struct mmsghdr rx_msgs[ETH_READ_BATCH];
+struct iovec rx_iov[ETH_READ_BATCH];
+u_char *rx_bufs = NULL;
+#endif
 #if defined (_WIN32)
 HANDLE hWait = (dev->eth_api == ETH_API_PCAP) ? pcap_getevent ((pcap_t*)dev->handle) : NULL;
 #endif
@@ -1926,6 +2118,22 @@ switch (dev->eth_api) {
     select_fd = dev->fd_handle;
     break;
   }
+#if defined (ETH_HAVE_RECVMMSG)
+if (dev->eth_api == ETH_API_UDP) {
+  rx_bufs = (u_char *)malloc (ETH_READ_BATCH * ETH_MAX_JUMBO_FRAME);
+  if (rx_bufs) {
+    int i;
+
+    memset (rx_msgs, 0, sizeof (rx_msgs));
+    for (i = 0; i < ETH_READ_BATCH; i++) {
+      rx_iov[i].iov_base = rx_bufs + i * ETH_MAX_JUMBO_FRAME;
+      rx_iov[i].iov_len = ETH_MAX_JUMBO_FRAME;
+      rx_msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+      rx_msgs[i].msg_hdr.msg_iovlen = 1;
+      }
+    }
+  }
+#endif
 
 sim_debug(dev->dbit, dev->dptr, "Reader Thread Starting\n");
 
@@ -1980,22 +2188,24 @@ while (dev->handle) {
       case ETH_API_TAP:
         if (1) {
           struct pcap_pkthdr header;
-          int len;
+          int len, frames;
           u_char buf[ETH_MAX_JUMBO_FRAME];
 
           memset(&header, 0, sizeof(header));
-          len = read(dev->fd_handle, buf, sizeof(buf));
-          if (len > 0) {
+          status = 0;
+          /* drain the frames that are ready rather than select per frame */
+          for (frames = 0; frames < ETH_READ_BATCH; frames++) {
+            len = read(dev->fd_handle, buf, sizeof(buf));
+            if (len <= 0) {
+              if ((len < 0) && 
+                  ((frames == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK))))
+                status = -1;
+              break;
+              }
             status = 1;
             header.caplen = header.len = len;
             _eth_callback((u_char *)dev, &header, buf);
             }
-          else {
-            if (len < 0)
-              status = -1;
-            else
-              status = 0;
-            }
           }
         break;
 #endif /* HAVE_TAP_NETWORK */
@@ -2029,34 +2239,57 @@ while (dev->handle) {
         break;
 #endif /* HAVE_SLIRP_NETWORK */
       case ETH_API_UDP:
-        if (1) {
+#if defined (ETH_HAVE_RECVMMSG)
+        if (rx_bufs) {
           struct pcap_pkthdr header;
-          int len;
-          u_char buf[ETH_MAX_JUMBO_FRAME];
+          int frames, i;
 
           memset(&header, 0, sizeof(header));
-          len = (int)sim_read_sock (select_fd, (char *)buf, (int32)sizeof(buf));
-          if (len > 0) {
+          /* one system call for everything that is ready */
+          frames = recvmmsg (select_fd, rx_msgs, ETH_READ_BATCH, MSG_DONTWAIT, NULL);
+          if (frames > 0) {
             status = 1;
-            header.caplen = header.len = len;
-            _eth_callback((u_char *)dev, &header, buf);
+            for (i = 0; i < frames; i++) {
+              if (rx_msgs[i].msg_len == 0)
+                continue;
+              header.caplen = header.len = rx_msgs[i].msg_len;
+              _eth_callback((u_char *)dev, &header, (u_char *)rx_iov[i].iov_base);
+              }
             }
           else {
-            if (len < 0)
+            if ((frames < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
               status = -1;
             else
               status = 0;
             }
+          break;
+          }
+#endif
+        if (1) {
+          struct pcap_pkthdr header;
+          int len, frames;
+          u_char buf[ETH_MAX_JUMBO_FRAME];
+
+          memset(&header, 0, sizeof(header));
+          status = 0;
+          for (frames = 0; frames < ETH_READ_BATCH; frames++) {
+            len = (int)sim_read_sock (select_fd, (char *)buf, (int32)sizeof(buf));
+            if (len <= 0) {
+              if ((len < 0) || (frames == 0))
+                status = len;
+              break;
+              }
+            status = 1;
+            header.caplen = header.len = len;
+            _eth_callback((u_char *)dev, &header, buf);
+            }
           }
         break;
       }
-    if ((status > 0) && (dev->asynch_io)) {
-      int wakeup_needed;
+    if ((status > 0) || (dev->read_queue.staged != 0)) {
+      int wakeup_needed = _eth_queue_batch (dev);
 
-      pthread_mutex_lock (&dev->lock);
-      wakeup_needed = (dev->read_queue.count != 0);
-      pthread_mutex_unlock (&dev->lock);
-      if (wakeup_needed) {
+      if (wakeup_needed && (dev->asynch_io)) {
         sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
         sim_activate_abs (dev->dptr->units, dev->asynch_io_latency);
         }
@@ -2080,6 +2313,9 @@ while (dev->handle) {
     }
   }
 
+#if defined (ETH_HAVE_RECVMMSG)
+free (rx_bufs);
+#endif
 sim_debug(dev->dbit, dev->dptr, "Reader Thread Exiting\n");
 return NULL;
 }
@@ -2150,9 +2386,7 @@ int wakeup_needed;
 
 dev->asynch_io = 1;
 dev->asynch_io_latency = latency;
-pthread_mutex_lock (&dev->lock);
-wakeup_needed = (dev->read_queue.count != 0);
-pthread_mutex_unlock (&dev->lock);
+wakeup_needed = (_eth_ring_count (&dev->read_queue) != 0);
 if (wakeup_needed) {
   sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
   sim_activate_abs (dev->dptr->units, dev->asynch_io_latency);
@@ -2547,7 +2781,7 @@ dev->dbit = dbit;
 if (1) {
   pthread_attr_t attr;
 
-  ethq_init (&dev->read_queue, 200);         /* initialize FIFO queue */
+  _eth_ring_init (&dev->read_queue, ETH_READ_RING_SIZE);
   pthread_mutex_init (&dev->lock, NULL);
   pthread_mutex_init (&dev->writer_lock, NULL);
   pthread_mutex_init (&dev->self_lock, NULL);
@@ -2642,7 +2876,7 @@ if (1) {
     free(buffer);
     }
   }
-ethq_destroy (&dev->read_queue);         /* release FIFO queue */
+_eth_ring_destroy (&dev->read_queue);
 #endif
 
 _eth_close_port (dev->eth_api, pcap, pcap_fd);
@@ -3748,10 +3982,13 @@ if (bpf_used ? to_me : (to_me && !from_me)) {
 
     eth_packet_trace (dev, data, len, "rcvqd");
 
-    pthread_mutex_lock (&dev->lock);
-    ethq_insert_data(&dev->read_queue, ETH_ITM_NORMAL, data, 0, len, crc_len, crc_data, 0);
+    /* Stage the frame; the reader publishes the whole batch at once */
+    ETH_RING_LOCK (dev);
+    _eth_ring_put (&dev->read_queue, data, len, crc_len, crc_data);
+    ETH_RING_UNLOCK (dev);
     ++dev->packets_received;
-    pthread_mutex_unlock (&dev->lock);
+    if (dev->read_queue.staged == ETH_READ_BATCH)
+      _eth_queue_batch (dev);
     free(moved_data);
     }
 #else /* !USE_READER_THREAD */
@@ -3889,17 +4126,9 @@ if (status < 0) {
 
 #else /* USE_READER_THREAD */
 
-  status = 0;
-  pthread_mutex_lock (&dev->lock);
-  if (dev->read_queue.count > 0) {
-    ETH_ITEM* item = &dev->read_queue.item[dev->read_queue.head];
-    packet->len = item->packet.len;
-    packet->crc_len = item->packet.crc_len;
-    memcpy(packet->msg, item->packet.msg, ((packet->len > packet->crc_len) ? packet->len : packet->crc_len));
-    status = 1;
-    ethq_remove(&dev->read_queue);
-  }
-  pthread_mutex_unlock (&dev->lock);  
+  ETH_RING_LOCK (dev);
+  status = _eth_ring_get (&dev->read_queue, packet);
+  ETH_RING_UNLOCK (dev);
   if ((status) && (routine))
     routine(0);
 #endif
@@ -4151,9 +4380,10 @@ if (dev->eth_api == ETH_API_PCAP) {
     pcap_freecode(&bpf);
     }
 #ifdef USE_READER_THREAD
-  pthread_mutex_lock (&dev->lock);
-  ethq_clear (&dev->read_queue); /* Empty FIFO Queue when filter list changes */
-  pthread_mutex_unlock (&dev->lock);
+  ETH_RING_LOCK (dev);
+  while (_eth_ring_get (&dev->read_queue, NULL))  /* Empty FIFO Queue when filter list changes */
+    ;
+  ETH_RING_UNLOCK (dev);
 #endif
   }
 #endif /* USE_BPF */
@@ -4202,9 +4432,11 @@ if (dev->asynch_io)
   fprintf(st, "  Interrupt Latency:       %d uSec\n", dev->asynch_io_latency);
 if (dev->throttle_count)
   fprintf(st, "  Throttle Delays:         %d\n", dev->throttle_count);
-fprintf(st, "  Read Queue: Count:       %d\n", dev->read_queue.count);
-fprintf(st, "  Read Queue: High:        %d\n", dev->read_queue.high);
-fprintf(st, "  Read Queue: Loss:        %d\n", dev->read_queue.loss);
+fprintf(st, "  Read Queue: Count:       %d\n", (int)_eth_ring_count (&dev->read_queue));
+fprintf(st, "  Read Queue: High:        %d\n", (int)dev->read_queue.high);
+fprintf(st, "  Read Queue: Loss:        %d\n", (int)dev->read_queue.loss);
+fprintf(st, "  Read Queue: Size:        %d bytes\n", (int)dev->read_queue.size);
+fprintf(st, "  Read Queue: High Bytes:  %d\n", (int)dev->read_queue.high_bytes);
 fprintf(st, "  Peak Write Queue Size:   %d\n", dev->write_queue_peak);
 #endif
 if (dev->bpf_filter)
@@ -4409,6 +4641,144 @@ if (bpf_compile_skip_count)
 return (errors == 0) ? SCPE_OK : SCPE_IERR;
 }
 
+#if defined (USE_READER_THREAD)
+#define ETH_RATE_FRAMES 200000                  /* frames sent per receive rate case */
+#define ETH_RATE_BURST_MAX 256                  /* largest burst sent between drains */
+
+/* Measure the rate at which frames pass through the reader thread and 
+   the read queue.  Frames are sent in bursts from a plain UDP socket to 
+   a udp: transport device and read back with eth_read, the way a 
+   simulated NIC polls its queue.  The simulator side doesn't read while 
+   a burst is being sent, so the large burst case shows how much of a 
+   burst the read queue absorbs.  Each frame carries a sequence number 
+   so reordering or duplication is detected and missing frames are 
+   counted as lost. */
+
+static
+t_stat eth_test_receive_rate (DEVICE *dptr)
+{
+static const struct {
+    int         size;                           /* frame size */
+    int         burst;                          /* frames per burst */
+    } cases[] = {
+        {ETH_MIN_PACKET,    64},
+        {ETH_MAX_PACKET,    64},
+        {ETH_MIN_PACKET,    ETH_RATE_BURST_MAX},
+        };
+DEVICE eth_tst;
+ETH_DEV dev;
+ETH_PACK rpkt;
+ETH_MAC mac = {0x02, 0x00, 0x5E, 0x10, 0x20, 0x30};
+uint8 frame[ETH_MAX_PACKET];
+uint8 *burst;
+#if defined (ETH_HAVE_RECVMMSG)
+static struct mmsghdr msgs[ETH_RATE_BURST_MAX];
+static struct iovec iov[ETH_RATE_BURST_MAX];
+#endif
+SOCKET sender;
+t_stat stat = SCPE_OK;
+int c, i, n;
+
+burst = (uint8 *)malloc (ETH_RATE_BURST_MAX * ETH_MAX_PACKET);
+if (burst == NULL)
+  return SCPE_MEM;
+memset (&eth_tst, 0, sizeof(eth_tst));
+sender = sim_connect_sock_ex ("65505", "localhost:65504", NULL, NULL, SIM_SOCK_OPT_DATAGRAM);
+if (sender == INVALID_SOCKET) {
+  free (burst);
+  return sim_messagef (SCPE_IERR, "%s: Eth: can't create UDP sender socket\n", dptr->name);
+  }
+if (SCPE_OK != eth_open (&dev, "udp:65504:localhost:65505", &eth_tst, 1)) {
+  sim_close_sock (sender);
+  free (burst);
+  return sim_messagef (SCPE_IERR, "%s: Eth: can't open udp:65504:localhost:65505\n", dptr->name);
+  }
+eth_filter (&dev, 1, &mac, FALSE, FALSE);
+for (c = 0; (c < (int)(sizeof (cases) / sizeof (cases[0]))) && (stat == SCPE_OK); c++) {
+  int size = cases[c].size;
+  uint32 sent = 0, rcvd = 0, expect = 0;
+  int loss = dev.read_queue.loss;
+  double start, elapsed, idle;
+
+  memset (frame, 0, sizeof (frame));
+  memcpy (frame, mac, sizeof (mac));
+  frame[6] = 0x02;                              /* locally administered source */
+  frame[11] = 0x01;
+  frame[12] = 0x60;                             /* customer use protocol */
+  frame[13] = 0x06;
+  for (i = 18; i < size; i++)
+    frame[i] = (uint8)i;
+  start = sim_timenow_double ();
+  while ((sent < ETH_RATE_FRAMES) && (stat == SCPE_OK)) {
+    for (n = 0; (n < cases[c].burst) && (sent + n < ETH_RATE_FRAMES); n++) {
+      uint8 *f = burst + n * size;
+
+      memcpy (f, frame, size);
+      f[14] = (sent + n) & 0xFF;
+      f[15] = ((sent + n) >> 8) & 0xFF;
+      f[16] = ((sent + n) >> 16) & 0xFF;
+      f[17] = ((sent + n) >> 24) & 0xFF;
+      }
+#if defined (ETH_HAVE_RECVMMSG)
+    memset (msgs, 0, n * sizeof (msgs[0]));
+    for (i = 0; i < n; i++) {
+      iov[i].iov_base = burst + i * size;
+      iov[i].iov_len = size;
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      }
+    i = sendmmsg (sender, msgs, n, 0);
+    if (i > 0)
+      sent += i;
+#else
+    for (i = 0; i < n; i++) {
+      if (sim_write_sock (sender, (char *)(burst + i * size), size) != size)
+        break;                                  /* socket full, drain first */
+      ++sent;
+      }
+#endif
+    idle = sim_timenow_double ();
+    while ((expect < sent) && (stat == SCPE_OK)) {
+      uint32 seq;
+
+      if (!eth_read (&dev, &rpkt, NULL)) {
+        if (sim_timenow_double () - idle > 0.1)
+          break;                                /* remainder of burst was lost */
+        continue;
+        }
+      seq = rpkt.msg[14] | (rpkt.msg[15] << 8) | (rpkt.msg[16] << 16) | ((uint32)rpkt.msg[17] << 24);
+      if ((seq < expect) || (seq >= sent))
+        stat = sim_messagef (SCPE_IERR, "%s: Eth: frame %u received when expecting %u\n", dptr->name, seq, expect);
+      else if ((rpkt.len != (uint32)size) ||
+               (memcmp (&rpkt.msg[18], &frame[18], size - 18)))
+        stat = sim_messagef (SCPE_IERR, "%s: Eth: frame %u content mismatch\n", dptr->name, seq);
+      expect = seq + 1;
+      ++rcvd;
+      idle = sim_timenow_double ();
+      }
+    expect = sent;
+    }
+  elapsed = sim_timenow_double () - start;
+  if ((stat == SCPE_OK) && (rcvd == 0))
+    stat = sim_messagef (SCPE_IERR, "%s: Eth: no frames received\n", dptr->name);
+  if (stat == SCPE_OK)
+    sim_messagef (SCPE_OK, "udp receive %4d byte frames, bursts of %4d: %9.0f frames/sec, %u of %u lost (%d queue overflow)\n",
+                           size, cases[c].burst, rcvd / elapsed, sent - rcvd, sent, dev.read_queue.loss - loss);
+  }
+if (stat == SCPE_OK) {                          /* cost of a simulator poll finding nothing */
+  double start = sim_timenow_double ();
+
+  for (i = 0; i < 1000000; i++)
+    eth_read (&dev, &rpkt, NULL);
+  sim_messagef (SCPE_OK, "eth_read polling an empty queue: %.1f ns per call\n", (sim_timenow_double () - start) * 1000.0);
+  }
+sim_close_sock (sender);
+eth_close (&dev);
+free (burst);
+return stat;
+}
+#endif /* USE_READER_THREAD */
+
 #include <setjmp.h>
 
 t_stat sim_ether_test (DEVICE *dptr)
@@ -4420,6 +4790,9 @@ sim_printf ("Testing %s device sim_ether APIs\n", dptr->name);
 
 SIM_TEST(eth_test_crc32 (dptr));
 SIM_TEST(eth_test_bpf (dptr));
+#if defined (USE_READER_THREAD)
+SIM_TEST(eth_test_receive_rate (dptr));
+#endif
 return stat;
 }
 #endif /* USE_NETWORK */
@@ -232,6 +232,20 @@ struct eth_queue {
   struct eth_item*    item;
 };
 
+struct eth_ring {                                       /* single producer/single consumer packet ring */
+  uint8*              arena;                            /* variable length packet records */
+  uint32              size;                             /* arena size in bytes (power of 2) */
+  volatile uint32     head;                             /* consumer byte offset (free running) */
+  volatile uint32     tail;                             /* published producer byte offset (free running) */
+  uint32              fill;                             /* producer byte offset including staged packets */
+  volatile uint32     produced;                         /* packets published */
+  volatile uint32     consumed;                         /* packets removed */
+  uint32              staged;                           /* packets written but not yet published */
+  uint32              loss;                             /* packets dropped with the ring full */
+  uint32              high;                             /* high water mark (packets) */
+  uint32              high_bytes;                       /* high water mark (bytes) */
+};
+
 struct eth_list {
   char    name[ETH_DEV_NAME_MAX];
   char    desc[ETH_DEV_DESC_MAX];
@@ -246,6 +260,7 @@ typedef void (*ETH_PCALLBACK)(int status);
 typedef struct eth_list ETH_LIST;
 typedef struct eth_queue ETH_QUE;
 typedef struct eth_item ETH_ITEM;
+typedef struct eth_ring ETH_RING;
 struct eth_write_request {
   struct eth_write_request *next;
   ETH_PACK packet;
@@ -312,7 +327,7 @@ struct eth_device {
 #if defined (USE_READER_THREAD)
   int           asynch_io;                              /* Asynchronous Interrupt scheduling enabled */
   int           asynch_io_latency;                      /* instructions to delay pending interrupt */
-  ETH_QUE       read_queue;
+  ETH_RING      read_queue;                             /* frames from the reader thread */
   pthread_mutex_t     lock;
   pthread_t     reader_thread;                          /* Reader Thread Id */
   pthread_t     writer_thread;                          /* Writer Thread Id */
@@ -53,6 +53,9 @@
    sim_buf_swap_data -       swap data elements inplace in buffer
    sim_shmem_open            create or attach to a shared memory region
    sim_shmem_close           close a shared memory region
+   sim_memmap_open           create a memory region backed by a file
+   sim_memmap_open_ro        map an existing file read only
+   sim_memmap_sync           flush file backed memory regions to disk
 
 
    sim_fopen and sim_fseek are OS-dependent.  The other routines are not.
@@ -556,6 +559,28 @@ free (shmem->shm_name);
 free (shmem);
 }
 
+t_stat sim_memmap_open (const char *filename, size_t size, SHMEM **shmem, void **addr)
+{
+*shmem = NULL;
+return SCPE_NOFNC;
+}
+
+t_stat sim_memmap_open_ro (const char *filename, t_offset size, SHMEM **shmem, const void **addr)
+{
+*shmem = NULL;
+return SCPE_NOFNC;
+}
+
+t_stat sim_memmap_sync (void)
+{
+return SCPE_OK;
+}
+
+t_bool sim_memmap_in_use (void)
+{
+return FALSE;
+}
+
 int32 sim_shmem_atomic_add (int32 *p, int32 v)
 {
 return InterlockedExchangeAdd ((volatile long *) p,v) + (v);
@@ -653,8 +678,12 @@ struct SHMEM {
     size_t shm_size;
     void *shm_base;
     char *shm_name;
+    t_bool shm_file;                    /* backed by a regular file */
+    SHMEM *shm_next;                    /* next file backed region */
     };
 
+static SHMEM *sim_memmap_list = NULL;   /* open file backed regions */
+
 t_stat sim_shmem_open (const char *name, size_t size, SHMEM **shmem, void **addr)
 {
 #if defined (HAVE_SHM_OPEN) && defined (__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
@@ -721,18 +750,131 @@ return SCPE_NOFNC;
 
 void sim_shmem_close (SHMEM *shmem)
 {
-#if defined (HAVE_SHM_OPEN)
+SHMEM **lptr;
+
 if (shmem == NULL)
     return;
+for (lptr = &sim_memmap_list; *lptr != NULL; lptr = &(*lptr)->shm_next) {
+    if (*lptr == shmem) {
+        *lptr = shmem->shm_next;
+        break;
+        }
+    }
 if (shmem->shm_base != MAP_FAILED)
     munmap (shmem->shm_base, shmem->shm_size);
 if (shmem->shm_fd != -1) {
-    shm_unlink (shmem->shm_name);
+#if defined (HAVE_SHM_OPEN)
+    if (!shmem->shm_file)
+        shm_unlink (shmem->shm_name);
+#endif
     close (shmem->shm_fd);
     }
 free (shmem->shm_name);
 free (shmem);
-#endif
+}
+
+/* Memory region backed by a regular file
+
+   The file is (re)created as a sparse file of the requested size, so the
+   region reads as zeros and host pages are only allocated as they are
+   touched.  The mapping is shared, so other processes can watch the
+   contents change by reading or mapping the same file.  The region is
+   released with sim_shmem_close.
+*/
+
+t_stat sim_memmap_open (const char *filename, size_t size, SHMEM **shmem, void **addr)
+{
+char namebuf[PATH_MAX + 1];
+
+*addr = NULL;
+*shmem = (SHMEM *)calloc (1, sizeof(**shmem));
+if (*shmem == NULL)
+    return SCPE_MEM;
+(*shmem)->shm_fd = -1;
+(*shmem)->shm_base = MAP_FAILED;
+(*shmem)->shm_size = size;
+(*shmem)->shm_file = TRUE;
+(*shmem)->shm_name = (char *)calloc (1, 1 + strlen (filename));
+if ((*shmem)->shm_name == NULL) {
+    sim_shmem_close (*shmem);
+    *shmem = NULL;
+    return SCPE_MEM;
+    }
+strcpy ((*shmem)->shm_name, filename);
+_sim_expand_homedir (filename, namebuf, sizeof (namebuf));
+(*shmem)->shm_fd = open (namebuf, O_CREAT | O_RDWR, 0660);
+if (((*shmem)->shm_fd == -1) ||
+    ftruncate ((*shmem)->shm_fd, 0) ||              /* discard old contents */
+    ftruncate ((*shmem)->shm_fd, (off_t)size)) {
+    int last_errno = errno;
+
+    sim_shmem_close (*shmem);
+    *shmem = NULL;
+    return sim_messagef (SCPE_OPENERR, "Can't create a %u byte memory file '%s' - errno=%d - %s\n", (unsigned int)size, filename, last_errno, strerror (last_errno));
+    }
+(*shmem)->shm_base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, (*shmem)->shm_fd, 0);
+if ((*shmem)->shm_base == MAP_FAILED) {
+    int last_errno = errno;
+
+    sim_shmem_close (*shmem);
+    *shmem = NULL;
+    return sim_messagef (SCPE_OPENERR, "Memory file '%s' mmap() failed. errno=%d - %s\n", filename, last_errno, strerror (last_errno));
+    }
+(*shmem)->shm_next = sim_memmap_list;
+sim_memmap_list = *shmem;
+*addr = (*shmem)->shm_base;
+return SCPE_OK;
+}
+
+/* Map an existing file read only.  The mapping is shared, so any number of
+   processes mapping the same file use the same host page cache pages.
+   The mapping is released with sim_shmem_close. */
+
+t_stat sim_memmap_open_ro (const char *filename, t_offset size, SHMEM **shmem, const void **addr)
+{
+char namebuf[PATH_MAX + 1];
+
+*addr = NULL;
+*shmem = NULL;
+if ((size <= 0) || ((t_offset)((size_t)size) != size))  /* can't map it all? */
+    return SCPE_NOFNC;
+*shmem = (SHMEM *)calloc (1, sizeof(**shmem));
+if (*shmem == NULL)
+    return SCPE_MEM;
+(*shmem)->shm_base = MAP_FAILED;
+(*shmem)->shm_size = (size_t)size;
+(*shmem)->shm_file = TRUE;
+(*shmem)->shm_name = (char *)calloc (1, 1 + strlen (filename));
+if ((*shmem)->shm_name != NULL)
+    strcpy ((*shmem)->shm_name, filename);
+_sim_expand_homedir (filename, namebuf, sizeof (namebuf));
+(*shmem)->shm_fd = open (namebuf, O_RDONLY);
+if (((*shmem)->shm_name == NULL) ||
+    ((*shmem)->shm_fd == -1) ||
+    (MAP_FAILED == ((*shmem)->shm_base = mmap (NULL, (*shmem)->shm_size, PROT_READ, MAP_SHARED, (*shmem)->shm_fd, 0)))) {
+    sim_shmem_close (*shmem);
+    *shmem = NULL;
+    return SCPE_OPENERR;
+    }
+*addr = (*shmem)->shm_base;
+return SCPE_OK;
+}
+
+t_stat sim_memmap_sync (void)
+{
+SHMEM *shmem;
+t_stat r = SCPE_OK;
+
+for (shmem = sim_memmap_list; shmem != NULL; shmem = shmem->shm_next) {
+    if (msync (shmem->shm_base, shmem->shm_size, MS_SYNC))
+        r = sim_messagef (SCPE_IOERR, "Memory file '%s' msync() failed. errno=%d - %s\n", shmem->shm_name, errno, strerror (errno));
+    }
+return r;
+}
+
+t_bool sim_memmap_in_use (void)
+{
+return (sim_memmap_list != NULL);
 }
 
 int32 sim_shmem_atomic_add (int32 *p, int32 v)
@@ -769,6 +911,28 @@ void sim_shmem_close (SHMEM *shmem)
 {
 }
 
+t_stat sim_memmap_open (const char *filename, size_t size, SHMEM **shmem, void **addr)
+{
+*shmem = NULL;
+return SCPE_NOFNC;
+}
+
+t_stat sim_memmap_open_ro (const char *filename, t_offset size, SHMEM **shmem, const void **addr)
+{
+*shmem = NULL;
+return SCPE_NOFNC;
+}
+
+t_stat sim_memmap_sync (void)
+{
+return SCPE_OK;
+}
+
+t_bool sim_memmap_in_use (void)
+{
+return FALSE;
+}
+
 int32 sim_shmem_atomic_add (int32 *p, int32 v)
 {
 return -1;
@@ -93,6 +93,10 @@ const char *sim_get_os_error_text (int error);
 typedef struct SHMEM SHMEM;
 t_stat sim_shmem_open (const char *name, size_t size, SHMEM **shmem, void **addr);
 void sim_shmem_close (SHMEM *shmem);
+t_stat sim_memmap_open (const char *filename, size_t size, SHMEM **shmem, void **addr);
+t_stat sim_memmap_open_ro (const char *filename, t_offset size, SHMEM **shmem, const void **addr);
+t_stat sim_memmap_sync (void);
+t_bool sim_memmap_in_use (void);
 int32 sim_shmem_atomic_add (int32 *ptr, int32 val);
 t_bool sim_shmem_atomic_cas (int32 *ptr, int32 oldv, int32 newv);
 
@@ -54,6 +54,7 @@
 #define CMD_SNDDIAG     0x1D                            /* send diagnostic */
 #define CMD_SPACE       0x11                            /* space */
 #define CMD_WRFMARK     0x10                            /* write filemarks */
+#define CMD_SYNCCACHE   0x35                            /* synchronize cache */
 
 /* SCSI status codes */
 
@@ -64,6 +65,7 @@
 
 #define KEY_OK          0                               /* no sense */
 #define KEY_NOTRDY      2                               /* not ready */
+#define KEY_MEDERR      3                               /* medium error */
 #define KEY_ILLREQ      5                               /* illegal request */
 #define KEY_PROT        7                               /* data protect */
 #define KEY_BLANK       8                               /* blank check */
@@ -360,6 +362,24 @@ else
     scsi_status (bus, STS_CHK, KEY_NOTRDY, ASC_NOMEDIA); /* no media present */
 }
 
+/* Command - Synchronize Cache */
+
+void scsi_sync_cache (SCSI_BUS *bus, uint8 *data, uint32 len)
+{
+UNIT *uptr = bus->dev[bus->target];
+
+sim_debug (SCSI_DBG_CMD, bus->dptr, "Synchronize Cache\n");
+
+if ((uptr->flags & UNIT_ATT) == 0) {                    /* not attached? */
+    scsi_status (bus, STS_CHK, KEY_NOTRDY, ASC_NOMEDIA);
+    return;
+    }
+if (sim_disk_flush (uptr) != SCPE_OK)                   /* write back cached data */
+    scsi_status (bus, STS_CHK, KEY_MEDERR, ASC_OK);
+else
+    scsi_status (bus, STS_OK, KEY_OK, ASC_OK);          /* GOOD status */
+}
+
 /* Command - Inquiry */
 
 void scsi_inquiry (SCSI_BUS *bus, uint8 *data, uint32 len)
@@ -1249,6 +1269,10 @@ switch (data[0]) {
         scsi_write10_disk (bus, data, len);
         break;
 
+    case CMD_SYNCCACHE:                                 /* optional */
+        scsi_sync_cache (bus, data, len);
+        break;
+
     default:
         sim_printf ("SCSI: unknown disk command %02X\n", data[0]);
         scsi_status (bus, STS_CHK, KEY_ILLREQ, ASC_INVCOM);
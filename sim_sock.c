@@ -54,6 +54,9 @@ extern "C" {
 #if defined(AF_INET6) && defined(_WIN32)
 #include <ws2tcpip.h>
 #endif
+#if !defined(_WIN32) && !defined(VMS) && (!defined(__OS2__) || defined(__EMX__))
+#include <sys/uio.h>                                    /* for struct iovec */
+#endif
 
 #ifdef HAVE_DLOPEN
 #include <dlfcn.h>
@@ -79,6 +82,7 @@ extern "C" {
    sim_accept_conn      accept connection
    sim_read_sock        read from socket
    sim_write_sock       write from socket
+   sim_writev_sock      write several buffers to socket
    sim_close_sock       close socket
    sim_setnonblock      set socket non-blocking
 */
@@ -120,6 +124,11 @@ int sim_write_sock (SOCKET sock, char *msg, int nbytes)
 return 0;
 }
 
+int sim_writev_sock (SOCKET sock, const char **msgs, const int *nbytes, int count)
+{
+return 0;
+}
+
 void sim_close_sock (SOCKET sock)
 {
 return;
@@ -1252,6 +1261,65 @@ if (sbytes == SOCKET_ERROR) {
 return sbytes;
 }
 
+/* Write several buffers (at most SIM_SOCK_MAX_IOV) with a single call.
+   Returns the total number of bytes written, which may end part way
+   through any buffer, 0 if the write would block, or SOCKET_ERROR */
+
+int sim_writev_sock (SOCKET sock, const char **msgs, const int *nbytes, int count)
+{
+int i, err, sbytes;
+#if defined (_WIN32)
+WSABUF bufs[SIM_SOCK_MAX_IOV];
+DWORD sent;
+#elif !defined (VMS)
+struct iovec bufs[SIM_SOCK_MAX_IOV];
+struct msghdr msg;
+#endif
+
+if (count > SIM_SOCK_MAX_IOV)
+    count = SIM_SOCK_MAX_IOV;
+#if defined (_WIN32)
+for (i = 0; i < count; i++) {
+    bufs[i].buf = (char *)msgs[i];
+    bufs[i].len = (u_long)nbytes[i];
+    }
+if (WSASend (sock, bufs, (DWORD)count, &sent, 0, NULL, NULL) == 0)
+    sbytes = (int)sent;
+else
+    sbytes = SOCKET_ERROR;
+#elif defined (VMS)
+for (i = sbytes = 0; i < count; i++) {                  /* no gathered send, write each in turn */
+    int wbytes = sim_write_sock (sock, msgs[i], nbytes[i]);
+
+    if (wbytes < 0)
+        return (sbytes ? sbytes : wbytes);
+    sbytes += wbytes;
+    if (wbytes < nbytes[i])                             /* partial write? */
+        break;
+    }
+return sbytes;
+#else
+memset (&msg, 0, sizeof (msg));
+for (i = 0; i < count; i++) {
+    bufs[i].iov_base = (void *)msgs[i];
+    bufs[i].iov_len = (size_t)nbytes[i];
+    }
+msg.msg_iov = bufs;
+msg.msg_iovlen = count;
+sbytes = (int)sendmsg (sock, &msg, 0);
+#endif
+if (sbytes == SOCKET_ERROR) {
+    err = WSAGetLastError ();
+    if (err == WSAEWOULDBLOCK)                          /* no data */
+        return 0;
+#if defined(EAGAIN)
+    if (err == EAGAIN)                                  /* no data */
+        return 0;
+#endif
+    }
+return sbytes;
+}
+
 void sim_close_sock (SOCKET sock)
 {
 shutdown(sock, SD_BOTH);
@@ -138,11 +138,34 @@ static t_addr sim_tape_tpc_fnd (UNIT *uptr, t_addr *map);
 static void sim_tape_data_trace (UNIT *uptr, const uint8 *data, size_t len, const char* txt, int detail, uint32 reason);
 static t_stat tape_erase_fwd (UNIT *uptr, t_mtrlnt gap_size);
 static t_stat tape_erase_rev (UNIT *uptr, t_mtrlnt gap_size);
+static void sim_tape_index_add (UNIT *uptr, t_addr pos, t_mtrlnt bc);
+static void sim_tape_index_truncate (UNIT *uptr, t_addr pos);
+static void sim_tape_index_free (UNIT *uptr);
+static t_stat sim_tape_stream_flush (UNIT *uptr);
+
+typedef struct {
+    t_addr              pos;                /* file position of the leading metadatum */
+    t_mtrlnt            bc;                 /* record length metadatum or MTR_TMK */
+    } TAPE_INDEX_ENTRY;
 
 struct tape_context {
     DEVICE              *dptr;              /* Device for unit (access to debug flags) */
     uint32              dbit;               /* debugging bit for trace */
     uint32              auto_format;        /* Format determined dynamically */
+    TAPE_INDEX_ENTRY    *index;             /* record/tape mark index (SIMH and E11 formats) */
+    uint32              index_count;        /* objects in the index */
+    uint32              index_size;         /* index entries allocated */
+    uint32              *index_tmk;         /* index entry numbers of the tape marks */
+    uint32              index_tmk_count;    /* tape marks in the index */
+    uint32              index_tmk_size;     /* tape mark entries allocated */
+    uint32              index_hint;         /* entry located by the most recent lookup */
+    t_addr              index_end;          /* file position following the last indexed object */
+    t_bool              index_complete;     /* scan stopped at a gap, EOM or invalid object */
+    t_bool              index_suspend;      /* index lookups disabled (image validation) */
+    uint8               *xbuf;              /* streaming buffer (SIMH and E11 formats) */
+    t_addr              xbuf_pos;           /* file position of the buffer contents */
+    uint32              xbuf_len;           /* bytes read ahead or waiting to be written */
+    t_bool              xbuf_dirty;         /* buffer holds data waiting to be written */
 #if defined SIM_ASYNCH_IO
     t_bool              asynch_io;          /* Asynchronous Interrupt scheduling enabled */
     int                 asynch_io_latency;  /* instructions to delay pending interrupt */
@@ -608,8 +631,11 @@ sim_tape_clr_async (uptr);
 if (sim_asynch_enabled)
     sim_tape_set_async (uptr, ctx->asynch_io_latency);
 #endif
-if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
+if (MT_GET_FMT (uptr) < MTUF_F_ANSI) {
+    if (sim_tape_stream_flush (uptr) != MTSE_OK)        /* write out streamed data */
+        sim_tape_ioerr (uptr);
     fflush (uptr->fileref);
+    }
 }
 
 static const char *_sim_tape_format_name (UNIT *uptr)
@@ -1033,6 +1059,9 @@ uptr->tape_eom = 0;
 uptr->pos = 0;
 MT_CLR_PNU (uptr);
 MT_CLR_INMRK (uptr);                                    /* Not within a TAR tapemark */
+sim_tape_index_free (uptr);
+if (ctx)
+    free (ctx->xbuf);
 free (uptr->tape_ctx);
 uptr->tape_ctx = NULL;
 uptr->io_flush = NULL;
@@ -1121,18 +1150,521 @@ if (sim_deb && ((uptr->dctrl | ctx->dptr->dctrl) & reason))
 
 static int sim_tape_seek (UNIT *uptr, t_addr pos)
 {
-if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
+if (MT_GET_FMT (uptr) < MTUF_F_ANSI) {
+    if (sim_tape_stream_flush (uptr) != MTSE_OK)        /* write out streamed data first */
+        return -1;
     return sim_fseek (uptr->fileref, pos, SEEK_SET);
+    }
 return 0;
 }
 
 static t_offset sim_tape_size (UNIT *uptr)
 {
-if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
+if (MT_GET_FMT (uptr) < MTUF_F_ANSI) {
+    if (sim_tape_stream_flush (uptr) != MTSE_OK)        /* include any streamed data */
+        sim_tape_ioerr (uptr);
     return sim_fsize_ex (uptr->fileref); /* True on-disk tape images: file size  */
+    }
 return uptr->tape_eom;                   /* Virtual tape images: record/TM count */
 }
 
+/* Record index (SIMH and E11 formats)
+
+   Spacing and reverse reading a SIMH format image normally walks it one
+   metadatum at a time.  To avoid rereading the metadata of a long image each
+   time a program spaces over it, every attached SIMH or E11 format tape keeps
+   a sorted list of the positions and length metadata of the data records and
+   tape marks contiguously following the BOT.  The list is filled in as records
+   are read (the attach time image validation pass usually covers the whole
+   image) and, when a spacing operation runs past its end, by scanning ahead
+   through the record metadata.  Positions within the indexed region can then
+   be located with a binary search, and the number of records to the next (or
+   previous) tape mark is the difference of two entry numbers.
+
+   Only well formed objects are indexed.  The index stops at the first erase
+   gap, EOM marker, invalid record or the end of the file, and operations
+   which go beyond that point are performed by the original per record code.
+   Any write, tape mark, EOM or erase discards the entries at and beyond the
+   position written, so the index never describes stale data.
+*/
+
+#define TAPE_INDEX_SCAN     4096            /* objects examined per scan ahead */
+
+#define TAPE_INDEX_OBJ(bc)  (((bc) != MTR_EOM) && ((bc) != MTR_GAP) &&           \
+                             ((bc) != MTR_FHGAP) && (((bc) & MTR_M_RHGAP) != MTR_RHGAP))
+
+static t_bool sim_tape_index_usable (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 f = MT_GET_FMT (uptr);
+
+return ((ctx != NULL) && !ctx->index_suspend &&
+        (uptr->flags & UNIT_ATT) &&
+        ((f == MTUF_F_STD) || (f == MTUF_F_E11)));
+}
+
+/* Return the file position following an object starting at pos */
+
+static t_addr sim_tape_index_obj_end (UNIT *uptr, t_addr pos, t_mtrlnt bc)
+{
+t_mtrlnt sbc = MTR_L (bc);
+
+if (bc == MTR_TMK)
+    return pos + sizeof (t_mtrlnt);
+return pos + 2 * sizeof (t_mtrlnt) + ((MT_GET_FMT (uptr) == MTUF_F_STD) ? (sbc + 1) & ~1 : sbc);
+}
+
+/* Append an object to the index if it immediately follows the indexed region */
+
+static void sim_tape_index_add (UNIT *uptr, t_addr pos, t_mtrlnt bc)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 f = MT_GET_FMT (uptr);
+
+if ((ctx == NULL) || (pos != ctx->index_end) || !TAPE_INDEX_OBJ (bc) ||
+    ((f != MTUF_F_STD) && (f != MTUF_F_E11)))
+    return;
+if (ctx->index_count == ctx->index_size) {
+    uint32 size = (ctx->index_size == 0) ? 1024 : 2 * ctx->index_size;
+    TAPE_INDEX_ENTRY *index = (TAPE_INDEX_ENTRY *)realloc (ctx->index, size * sizeof (*index));
+
+    if (index == NULL)                      /* no memory? */
+        return;                             /*   index stays as it was */
+    ctx->index = index;
+    ctx->index_size = size;
+    }
+if ((bc == MTR_TMK) && (ctx->index_tmk_count == ctx->index_tmk_size)) {
+    uint32 size = (ctx->index_tmk_size == 0) ? 64 : 2 * ctx->index_tmk_size;
+    uint32 *tmk = (uint32 *)realloc (ctx->index_tmk, size * sizeof (*tmk));
+
+    if (tmk == NULL)
+        return;
+    ctx->index_tmk = tmk;
+    ctx->index_tmk_size = size;
+    }
+if (bc == MTR_TMK)
+    ctx->index_tmk[ctx->index_tmk_count++] = ctx->index_count;
+ctx->index[ctx->index_count].pos = pos;
+ctx->index[ctx->index_count].bc = bc;
+++ctx->index_count;
+ctx->index_end = sim_tape_index_obj_end (uptr, pos, bc);
+}
+
+/* Locate the entry starting at pos.  Returns the entry number, index_count
+   if pos is the end of the indexed region, or -1 if pos isn't the start of
+   an indexed object. */
+
+static int32 sim_tape_index_find (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 lo, hi, p;
+
+if (pos == ctx->index_end)
+    return (int32)ctx->index_count;
+if ((pos > ctx->index_end) || (ctx->index_count == 0))
+    return -1;
+p = ctx->index_hint;                        /* sequential access is the common case */
+if ((p < ctx->index_count) && (ctx->index[p].pos == pos))
+    return (int32)p;
+if ((p + 1 < ctx->index_count) && (ctx->index[p + 1].pos == pos))
+    return (int32)(ctx->index_hint = p + 1);
+if ((p > 0) && (p <= ctx->index_count) && (ctx->index[p - 1].pos == pos))
+    return (int32)(ctx->index_hint = p - 1);
+lo = 0;
+hi = ctx->index_count;
+while (lo < hi) {
+    p = (lo + hi) >> 1;
+    if (ctx->index[p].pos < pos)
+        lo = p + 1;
+    else
+        hi = p;
+    }
+if ((lo < ctx->index_count) && (ctx->index[lo].pos == pos))
+    return (int32)(ctx->index_hint = lo);
+return -1;
+}
+
+/* Return the position in the tape mark list of the first tape mark at or
+   after entry number entry (index_tmk_count if there is none) */
+
+static uint32 sim_tape_index_tmk_find (struct tape_context *ctx, uint32 entry)
+{
+uint32 lo = 0, hi = ctx->index_tmk_count, p;
+
+while (lo < hi) {
+    p = (lo + hi) >> 1;
+    if (ctx->index_tmk[p] < entry)
+        lo = p + 1;
+    else
+        hi = p;
+    }
+return lo;
+}
+
+/* Scan forward from the end of the indexed region adding well formed objects */
+
+static t_bool sim_tape_index_extend (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 added = 0;
+t_mtrlnt bc, rev_bc;
+t_addr pos, next;
+
+while (!ctx->index_complete && (added < TAPE_INDEX_SCAN)) {
+    pos = ctx->index_end;
+    if ((uptr->tape_eom > 0) && (pos >= uptr->tape_eom))
+        break;
+    if (sim_tape_seek (uptr, pos) ||
+        (sim_fread (&bc, sizeof (t_mtrlnt), 1, uptr->fileref) != 1) ||
+        !TAPE_INDEX_OBJ (bc)) {
+        ctx->index_complete = TRUE;
+        break;
+        }
+    if (bc != MTR_TMK) {
+        next = sim_tape_index_obj_end (uptr, pos, bc);
+        if (sim_tape_seek (uptr, next - sizeof (t_mtrlnt)) ||
+            (sim_fread (&rev_bc, sizeof (t_mtrlnt), 1, uptr->fileref) != 1) ||
+            (rev_bc != bc)) {
+            ctx->index_complete = TRUE;
+            break;
+            }
+        }
+    sim_tape_index_add (uptr, pos, bc);
+    if (ctx->index_end == pos)              /* couldn't be added? */
+        break;
+    ++added;
+    }
+clearerr (uptr->fileref);
+sim_debug_unit (MTSE_DBG_STR, uptr, "index: %u objects added, %u indexed through pos: %" T_ADDR_FMT "u%s\n",
+                added, ctx->index_count, ctx->index_end, ctx->index_complete ? " (complete)" : "");
+return (added > 0);
+}
+
+/* Discard the index entries for objects at or beyond a position being written */
+
+static void sim_tape_index_truncate (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 lo, hi, p;
+
+if (ctx == NULL)
+    return;
+ctx->index_complete = FALSE;
+if (pos >= ctx->index_end)
+    return;
+lo = 0;                                     /* find the first object extending past pos */
+hi = ctx->index_count;
+while (lo < hi) {
+    p = (lo + hi) >> 1;
+    if (sim_tape_index_obj_end (uptr, ctx->index[p].pos, ctx->index[p].bc) <= pos)
+        lo = p + 1;
+    else
+        hi = p;
+    }
+ctx->index_count = lo;
+ctx->index_end = (lo == 0) ? 0 : sim_tape_index_obj_end (uptr, ctx->index[lo - 1].pos, ctx->index[lo - 1].bc);
+ctx->index_tmk_count = sim_tape_index_tmk_find (ctx, lo);
+if (ctx->index_hint > lo)
+    ctx->index_hint = lo;
+}
+
+static void sim_tape_index_free (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (ctx == NULL)
+    return;
+free (ctx->index);
+ctx->index = NULL;
+free (ctx->index_tmk);
+ctx->index_tmk = NULL;
+ctx->index_count = ctx->index_size = 0;
+ctx->index_tmk_count = ctx->index_tmk_size = 0;
+ctx->index_hint = 0;
+ctx->index_end = 0;
+ctx->index_complete = FALSE;
+}
+
+/* Space records forward using the index.  Returns TRUE with the operation
+   status in *st if the operation completed, or FALSE (with *skipped and the
+   tape position reflecting any progress made) if the remainder needs to be
+   performed record by record. */
+
+static t_bool sim_tape_index_sprecsf (UNIT *uptr, uint32 count, uint32 *skipped, t_stat *st)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+int32 i;
+uint32 remaining, t, n;
+
+if (!sim_tape_index_usable (uptr))
+    return FALSE;
+while (*skipped < count) {
+    i = sim_tape_index_find (uptr, uptr->pos);
+    if (i < 0)
+        return FALSE;
+    n = ctx->index_count;
+    if ((uint32)i == n) {                   /* at the end of the indexed region? */
+        if (!sim_tape_index_extend (uptr))
+            return FALSE;
+        continue;
+        }
+    MT_CLR_PNU (uptr);
+    remaining = count - *skipped;
+    t = sim_tape_index_tmk_find (ctx, (uint32)i);
+    t = (t < ctx->index_tmk_count) ? ctx->index_tmk[t] : n;
+    if ((t < n) && (t - (uint32)i < remaining)) {       /* tape mark reached? */
+        *skipped += t - (uint32)i;
+        uptr->pos = ctx->index[t].pos + sizeof (t_mtrlnt);
+        ctx->index_hint = t;
+        *st = MTSE_TMK;
+        return TRUE;
+        }
+    if ((uint32)i + remaining <= n) {       /* count satisfied within the index? */
+        *skipped = count;
+        ctx->index_hint = (uint32)i + remaining;
+        uptr->pos = (ctx->index_hint < n) ? ctx->index[ctx->index_hint].pos : ctx->index_end;
+        *st = MTSE_OK;
+        return TRUE;
+        }
+    *skipped += n - (uint32)i;              /* skip the rest of the index */
+    uptr->pos = ctx->index_end;
+    ctx->index_hint = n;
+    }
+return FALSE;
+}
+
+/* Space records reverse using the index (see sim_tape_index_sprecsf) */
+
+static t_bool sim_tape_index_sprecsr (UNIT *uptr, uint32 count, uint32 *skipped, t_stat *st)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+int32 i;
+uint32 t;
+
+if (!sim_tape_index_usable (uptr) || MT_TST_PNU (uptr) || (count == 0))
+    return FALSE;
+while (((i = sim_tape_index_find (uptr, uptr->pos)) < 0) && (uptr->pos > ctx->index_end))
+    if (!sim_tape_index_extend (uptr))      /* index the region leading up to the position */
+        return FALSE;
+if (i <= 0)
+    return FALSE;
+t = sim_tape_index_tmk_find (ctx, (uint32)i);
+if ((t > 0) && ((uint32)i - 1 - ctx->index_tmk[t - 1] < count)) {  /* tape mark reached? */
+    t = ctx->index_tmk[t - 1];
+    *skipped = (uint32)i - 1 - t;
+    uptr->pos = ctx->index[t].pos;
+    ctx->index_hint = t;
+    *st = MTSE_TMK;
+    return TRUE;
+    }
+if ((uint32)i < count) {                    /* BOT will be reached */
+    *skipped = (uint32)i;                   /*   so let the record by record code report it */
+    uptr->pos = ctx->index[0].pos;
+    ctx->index_hint = 0;
+    return FALSE;
+    }
+*skipped = count;
+ctx->index_hint = (uint32)i - count;
+uptr->pos = ctx->index[ctx->index_hint].pos;
+*st = MTSE_OK;
+return TRUE;
+}
+
+/* Streaming buffer (SIMH and E11 formats)
+
+   Reading a record forward otherwise takes a seek and separate reads of its
+   leading length, its data and its trailing length, and writing one takes a
+   seek and three writes, each of which reaches the host as a system call.
+   Records of SIMH and E11 format images are instead transferred through a
+   per unit buffer: reads are satisfied from a large block read ahead of (or,
+   when reading in reverse, behind) the tape position, and records and tape
+   marks written in sequence are collected and written as a single block.
+   When asynchronous I/O is enabled this all happens on the unit's I/O
+   thread, ahead of the completion callback.  Records larger than half the
+   buffer are transferred directly.
+
+   Any other access to the image file positions it with sim_tape_seek, which
+   writes out pending data first, and operations which write the file
+   directly discard the buffer.  Pending data is also written at each tape
+   mark, when the simulator stops and when the unit is detached.
+*/
+
+#define TAPE_STREAM_SIZE    (256 * 1024)    /* streaming buffer size */
+
+static t_bool sim_tape_stream_usable (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 f = MT_GET_FMT (uptr);
+
+if ((ctx == NULL) || !(uptr->flags & UNIT_ATT) ||
+    ((f != MTUF_F_STD) && (f != MTUF_F_E11)))
+    return FALSE;
+if (ctx->xbuf == NULL)
+    ctx->xbuf = (uint8 *)malloc (TAPE_STREAM_SIZE);
+return (ctx->xbuf != NULL);
+}
+
+/* Write out pending data.  An error is returned with errno and the file's
+   error indicator set for the caller to report. */
+
+static t_stat sim_tape_stream_flush (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if ((ctx == NULL) || !ctx->xbuf_dirty)
+    return MTSE_OK;
+ctx->xbuf_dirty = FALSE;
+if (sim_fseek (uptr->fileref, ctx->xbuf_pos, SEEK_SET) ||
+    (sim_fwrite (ctx->xbuf, sizeof (uint8), ctx->xbuf_len, uptr->fileref) != ctx->xbuf_len)) {
+    ctx->xbuf_len = 0;
+    return MTSE_IOERR;
+    }
+sim_debug_unit (MTSE_DBG_STR, uptr, "stream: wrote %u bytes at pos: %" T_ADDR_FMT "u\n", ctx->xbuf_len, ctx->xbuf_pos);
+return MTSE_OK;
+}
+
+/* Write out pending data and forget the buffer contents (the file is about
+   to be written directly) */
+
+static t_stat sim_tape_stream_discard (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+t_stat r = sim_tape_stream_flush (uptr);
+
+if (ctx != NULL)
+    ctx->xbuf_len = 0;
+return r;
+}
+
+/* Read count elements of size bytes at file position pos, with the same
+   conventions as sim_fread */
+
+static size_t sim_tape_stream_read (UNIT *uptr, t_addr pos, void *bptr, size_t size, size_t count, t_bool reverse)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+size_t bytes = size * count;
+size_t avail;
+
+if ((bytes > TAPE_STREAM_SIZE / 2) || !sim_tape_stream_usable (uptr)) {
+    if (sim_tape_seek (uptr, pos))
+        return 0;
+    return sim_fread (bptr, size, count, uptr->fileref);
+    }
+if ((pos < ctx->xbuf_pos) || (pos + bytes > ctx->xbuf_pos + ctx->xbuf_len)) {   /* not buffered? */
+    if (sim_tape_stream_flush (uptr) != MTSE_OK)
+        return 0;
+    if (reverse)                            /* reading in reverse keeps the data preceding pos */
+        ctx->xbuf_pos = (pos + bytes > TAPE_STREAM_SIZE) ? pos + bytes - TAPE_STREAM_SIZE : 0;
+    else
+        ctx->xbuf_pos = pos;
+    ctx->xbuf_len = 0;
+    if (sim_fseek (uptr->fileref, ctx->xbuf_pos, SEEK_SET))
+        return 0;
+    ctx->xbuf_len = (uint32)fread (ctx->xbuf, sizeof (uint8), TAPE_STREAM_SIZE, uptr->fileref);
+    if (ferror (uptr->fileref)) {
+        ctx->xbuf_len = 0;
+        return 0;
+        }
+    if (pos >= ctx->xbuf_pos + ctx->xbuf_len)   /* nothing there? */
+        return 0;
+    }
+avail = (size_t)(ctx->xbuf_pos + ctx->xbuf_len - pos);
+if (avail > bytes)
+    avail = bytes;
+count = avail / size;
+sim_buf_copy_swapped (bptr, ctx->xbuf + (size_t)(pos - ctx->xbuf_pos), size, count);
+return count;
+}
+
+/* Write count elements of size bytes at file position pos, with the same
+   conventions as sim_fwrite */
+
+static size_t sim_tape_stream_write (UNIT *uptr, t_addr pos, const void *bptr, size_t size, size_t count)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+size_t bytes = size * count;
+
+if ((bytes > TAPE_STREAM_SIZE / 2) || !sim_tape_stream_usable (uptr)) {
+    if ((sim_tape_stream_discard (uptr) != MTSE_OK) || sim_tape_seek (uptr, pos))
+        return 0;
+    return sim_fwrite (bptr, size, count, uptr->fileref);
+    }
+if (!ctx->xbuf_dirty ||                     /* not continuing a sequential write? */
+    (pos != ctx->xbuf_pos + ctx->xbuf_len) ||
+    (ctx->xbuf_len + bytes > TAPE_STREAM_SIZE)) {
+    if (sim_tape_stream_flush (uptr) != MTSE_OK)
+        return 0;
+    ctx->xbuf_pos = pos;                    /* start collecting at pos */
+    ctx->xbuf_len = 0;
+    ctx->xbuf_dirty = TRUE;
+    }
+sim_buf_copy_swapped (ctx->xbuf + ctx->xbuf_len, bptr, size, count);
+ctx->xbuf_len += (uint32)bytes;
+return count;
+}
+
+/* Read the length of the record or tape mark at the current position from the
+   streaming buffer.  Returns FALSE, leaving the position unchanged, unless a
+   well formed record or a tape mark is present; gaps, EOM and anything
+   unexpected are left to the record by record code. */
+
+static t_bool sim_tape_stream_rdlntf (UNIT *uptr, t_mtrlnt *bc, t_stat *status)
+{
+const t_addr pos = uptr->pos;
+t_mtrlnt rev_bc;
+t_addr next;
+
+if (!sim_tape_stream_usable (uptr) ||
+    (sim_tape_stream_read (uptr, pos, bc, sizeof (t_mtrlnt), 1, FALSE) != 1)) {
+    *bc = 0;
+    return FALSE;
+    }
+if (*bc == MTR_TMK) {
+    uptr->pos = pos + sizeof (t_mtrlnt);
+    *status = MTSE_TMK;
+    }
+else {
+    next = sim_tape_index_obj_end (uptr, pos, *bc);
+    if (!TAPE_INDEX_OBJ (*bc) ||
+        (sim_tape_stream_read (uptr, next - sizeof (t_mtrlnt), &rev_bc, sizeof (t_mtrlnt), 1, FALSE) != 1) ||
+        (rev_bc != *bc)) {
+        *bc = 0;
+        return FALSE;
+        }
+    uptr->pos = next;
+    *status = MTSE_OK;
+    }
+sim_tape_index_add (uptr, pos, *bc);
+return TRUE;
+}
+
+/* Reverse counterpart of sim_tape_stream_rdlntf */
+
+static t_bool sim_tape_stream_rdlntr (UNIT *uptr, t_mtrlnt *bc, t_stat *status)
+{
+const t_addr pos = uptr->pos;
+t_addr size;
+
+if (!sim_tape_stream_usable (uptr) || (pos < sizeof (t_mtrlnt)) ||
+    (sim_tape_stream_read (uptr, pos - sizeof (t_mtrlnt), bc, sizeof (t_mtrlnt), 1, TRUE) != 1)) {
+    *bc = 0;
+    return FALSE;
+    }
+if (*bc == MTR_TMK) {
+    uptr->pos = pos - sizeof (t_mtrlnt);
+    *status = MTSE_TMK;
+    return TRUE;
+    }
+size = sim_tape_index_obj_end (uptr, 0, *bc);
+if (!TAPE_INDEX_OBJ (*bc) || (size > pos)) {
+    *bc = 0;
+    return FALSE;
+    }
+uptr->pos = pos - size;
+*status = MTSE_OK;
+return TRUE;
+}
+
 /* Read record length forward (internal routine).
 
    Inputs:
@@ -1235,6 +1767,7 @@ t_awshdr awshdr;
 size_t   rdcnt;
 t_mtrlnt buffer [256];                                  /* local tape buffer */
 t_addr   saved_pos = uptr->pos;
+const t_addr start_pos = uptr->pos;                     /* the starting position */
 uint32   bufcntr, bufcap;                               /* buffer counter and capacity */
 int32    runaway_counter, sizeof_gap;                   /* bytes remaining before runaway and bytes per gap */
 t_stat   status = MTSE_OK;
@@ -1251,6 +1784,26 @@ if ((uptr->tape_eom > 0) &&
     return MTSE_EOM;                                    /*     and quit with I/O error status */
     }
 
+if (sim_tape_index_usable (uptr)) {                     /* if the object at this position is indexed */
+    struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+    int32 i = sim_tape_index_find (uptr, uptr->pos);
+
+    if ((i >= 0) && ((uint32)i < ctx->index_count)) {   /*   then it has already been validated */
+        *bc = ctx->index[i].bc;
+
+        if (*bc == MTR_TMK) {
+            uptr->pos += sizeof (t_mtrlnt);
+            return MTSE_TMK;
+            }
+
+        uptr->pos = sim_tape_index_obj_end (uptr, uptr->pos, *bc);
+        return MTSE_OK;                                 /* the data is read via the streaming buffer */
+        }
+    }
+
+if (sim_tape_stream_rdlntf (uptr, bc, &status))         /* if a record or tape mark was read from the buffer */
+    return status;                                      /*   then it has been validated and indexed */
+
 if (sim_tape_seek (uptr, uptr->pos)) {                  /* set the initial tape position; if it fails */
     MT_SET_PNU (uptr);                                  /*   then set position not updated */
     return sim_tape_ioerr (uptr);                       /*     and quit with I/O error status */
@@ -1542,6 +2095,11 @@ switch (f) {                                       /* otherwise the read method
         status = MTSE_FMT;
     }
 
+if (((status == MTSE_OK) || (status == MTSE_TMK)) &&    /* if a record or tape mark */
+    ((f == MTUF_F_STD) || (f == MTUF_F_E11)) &&         /*   was read without crossing a gap */
+    (uptr->pos == sim_tape_index_obj_end (uptr, start_pos, *bc)))
+    sim_tape_index_add (uptr, start_pos, *bc);          /*     then index it if it's next in line */
+
 return status;
 }
 
@@ -1622,6 +2180,23 @@ if ((uptr->flags & UNIT_ATT) == 0)                      /* if the unit is not at
 if (sim_tape_bot (uptr))                                /* if the unit is positioned at the BOT */
     return MTSE_BOT;                                    /*   then reading backward is not possible */
 
+if (sim_tape_index_usable (uptr)) {                     /* if the preceding object is indexed */
+    struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+    int32 i = sim_tape_index_find (uptr, uptr->pos);
+
+    if (i > 0) {                                        /*   then position to its start directly */
+        ppos = ctx->index[i - 1].pos;
+        *bc = ctx->index[i - 1].bc;
+        ctx->index_hint = (uint32)(i - 1);
+
+        uptr->pos = ppos;                               /* the data is read via the streaming buffer */
+        return (*bc == MTR_TMK) ? MTSE_TMK : MTSE_OK;
+        }
+    }
+
+if (sim_tape_stream_rdlntr (uptr, bc, &status))         /* if a record or tape mark was read from the buffer */
+    return status;                                      /*   then return it */
+
 switch (f) {                                            /* otherwise the read method depends on the tape format */
 
     case MTUF_F_STD:
@@ -1939,7 +2514,11 @@ if (rbc > max) {                                        /* rec out of range? */
     return MTSE_INVRL;
     }
 if (f < MTUF_F_ANSI) {
-    i = (t_mtrlnt) sim_fread (buf, sizeof (uint8), rbc, uptr->fileref); /* read record */
+    if ((f == MTUF_F_STD) || (f == MTUF_F_E11))             /* streamed format? */
+        i = (t_mtrlnt) sim_tape_stream_read (uptr, uptr->pos - sim_tape_index_obj_end (uptr, 0, tbc) + sizeof (t_mtrlnt),
+                                             buf, sizeof (uint8), rbc, FALSE);
+    else
+        i = (t_mtrlnt) sim_fread (buf, sizeof (uint8), rbc, uptr->fileref); /* read record */
     if (ferror (uptr->fileref)) {                           /* error? */
         MT_SET_PNU (uptr);
         uptr->pos = opos;
@@ -2012,7 +2591,10 @@ if (st != MTSE_OK) {
 if (rbc > max)                                          /* rec out of range? */
     return MTSE_INVRL;
 if (f < MTUF_F_ANSI) {
-    i = (t_mtrlnt) sim_fread (buf, sizeof (uint8), rbc, uptr->fileref); /* read record */
+    if ((f == MTUF_F_STD) || (f == MTUF_F_E11))             /* streamed format? */
+        i = (t_mtrlnt) sim_tape_stream_read (uptr, uptr->pos + sizeof (t_mtrlnt), buf, sizeof (uint8), rbc, TRUE);
+    else
+        i = (t_mtrlnt) sim_fread (buf, sizeof (uint8), rbc, uptr->fileref); /* read record */
     if (ferror (uptr->fileref))                             /* error? */
         return sim_tape_ioerr (uptr);
     }
@@ -2076,7 +2658,8 @@ if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
 if (sbc == 0)                                           /* nothing to do? */
     return MTSE_OK;
-if (sim_tape_seek (uptr, uptr->pos))                    /* set pos */
+if ((f != MTUF_F_STD) && (f != MTUF_F_E11) &&           /* streamed formats position as they write */
+    sim_tape_seek (uptr, uptr->pos))                    /* set pos */
     return MTSE_IOERR;
 switch (f) {                                            /* case on format */
 
@@ -2084,13 +2667,14 @@ switch (f) {                                            /* case on format */
         sbc = MTR_L ((bc + 1) & ~1);                    /* pad odd length */
         /* fall through into the E11 handler */
     case MTUF_F_E11:                                    /* E11 */
-        (void)sim_fwrite (&bc, sizeof (t_mtrlnt), 1, uptr->fileref);
-        (void)sim_fwrite (buf, sizeof (uint8), sbc, uptr->fileref);
-        (void)sim_fwrite (&bc, sizeof (t_mtrlnt), 1, uptr->fileref);
-        if (ferror (uptr->fileref)) {                   /* error? */
-            MT_SET_PNU (uptr);
+        sim_tape_index_truncate (uptr, uptr->pos);      /* discard the index beyond here */
+        if ((sim_tape_stream_write (uptr, uptr->pos, &bc, sizeof (t_mtrlnt), 1) != 1) ||
+            (sim_tape_stream_write (uptr, uptr->pos + sizeof (t_mtrlnt), buf, sizeof (uint8), sbc) != sbc) ||
+            (sim_tape_stream_write (uptr, uptr->pos + sizeof (t_mtrlnt) + sbc, &bc, sizeof (t_mtrlnt), 1) != 1)) {
+            MT_SET_PNU (uptr);                          /* error? */
             return sim_tape_ioerr (uptr);
             }
+        sim_tape_index_add (uptr, uptr->pos, bc);       /* index the new record */
         uptr->pos = uptr->pos + sbc + (2 * sizeof (t_mtrlnt));  /* move tape */
         break;
 
@@ -2182,12 +2766,13 @@ if (ctx == NULL)                                        /* if not properly attac
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
-(void)sim_tape_seek (uptr, uptr->pos);                  /* set pos */
-(void)sim_fwrite (&dat, sizeof (t_mtrlnt), 1, uptr->fileref);
-if (ferror (uptr->fileref)) {                           /* error? */
-    MT_SET_PNU (uptr);
+sim_tape_index_truncate (uptr, uptr->pos);              /* discard the index beyond here */
+if ((sim_tape_stream_write (uptr, uptr->pos, &dat, sizeof (t_mtrlnt), 1) != 1) ||
+    (sim_tape_stream_flush (uptr) != MTSE_OK)) {        /* write out streamed data at each marker */
+    MT_SET_PNU (uptr);                                  /* error? */
     return sim_tape_ioerr (uptr);
     }
+sim_tape_index_add (uptr, uptr->pos, dat);              /* index a tape mark */
 sim_debug_unit (MTSE_DBG_STR, uptr, "wr_lnt: lnt: %d, pos: %" T_ADDR_FMT "u\n", dat, uptr->pos);
 uptr->pos = uptr->pos + sizeof (t_mtrlnt);              /* move tape */
 if (uptr->pos > uptr->tape_eom)
@@ -2402,8 +2987,15 @@ else if (sim_tape_wrp (uptr))                           /* otherwise if the unit
 else if (gap_size == 0 || format != MTUF_F_STD)         /* otherwise if zero length or gaps aren't supported */
     return MTSE_OK;                                     /*   then take no action */
 
+if (sim_tape_stream_discard (uptr) != MTSE_OK) {        /* write out streamed data; if it fails */
+    MT_SET_PNU (uptr);                                  /*   then set position not updated */
+    return sim_tape_ioerr (uptr);                       /*     and quit with I/O error status */
+    }
+
 file_size = sim_fsize (uptr->fileref);                  /* get the file size */
 
+sim_tape_index_truncate (uptr, gap_pos);                /* discard the index beyond the gap start */
+
 if (sim_tape_seek (uptr, uptr->pos)) {                  /* position the tape; if it fails */
     MT_SET_PNU (uptr);                                  /*   then set position not updated */
     return sim_tape_ioerr (uptr);                       /*     and quit with I/O error status */
@@ -2604,6 +3196,11 @@ else if ((gap_size == 0) || (format != MTUF_F_STD))     /* otherwise if the gap
 
 gap_pos = uptr->pos;                                    /* save the starting position */
 
+if (sim_tape_stream_discard (uptr) != MTSE_OK)          /* write out streamed data; if it fails */
+    return sim_tape_ioerr (uptr);                       /*   then quit with I/O error status */
+
+sim_tape_index_truncate (uptr, (gap_pos > gap_size) ? gap_pos - gap_size : 0);  /* discard the index beyond the gap start */
+
 if (gap_size == meta_size) {                            /* if the request is for a single metadatum */
     if (sim_tape_bot (uptr))                            /*   then if the unit is positioned at the BOT */
         return MTSE_BOT;                                /*     then erasing backward is not possible */
@@ -2842,6 +3439,8 @@ if (ctx == NULL)                                        /* if not properly attac
 sim_debug_unit (ctx->dbit, uptr, "sim_tape_sprecsf(unit=%d, count=%d)\n", (int)(uptr-ctx->dptr->units), count);
 
 *skipped = 0;
+if (sim_tape_index_sprecsf (uptr, count, skipped, &st)) /* spaced using the index? */
+    return st;
 while (*skipped < count) {                              /* loopo */
     st = sim_tape_sprecf (uptr, &tbc);                  /* spc rec */
     if (st != MTSE_OK)
@@ -2938,6 +3537,8 @@ if (ctx == NULL)                                        /* if not properly attac
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 sim_debug_unit (ctx->dbit, uptr, "sim_tape_sprecsr(unit=%d, count=%d)\n", (int)(uptr-ctx->dptr->units), count);
 
+if (sim_tape_index_sprecsr (uptr, count, skipped, &st)) /* spaced using the index? */
+    return st;
 while (*skipped < count) {                              /* loopo */
     st = sim_tape_sprecr (uptr, &tbc);                  /* spc rec rev */
     if (st != MTSE_OK)
@@ -3498,6 +4099,7 @@ t_addr pos_r;
 t_addr pos_fa;
 t_addr pos_sa;
 t_mtrlnt max = MTR_MAXLEN;
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 
 if (!(uptr->flags & UNIT_ATT))
     return SCPE_UNATT;
@@ -3516,6 +4118,8 @@ if (rec_sizes == NULL) {
     return SCPE_MEM;
     }
 
+if (ctx != NULL)                                        /* compare the record by record reads */
+    ctx->index_suspend = TRUE;                          /*   while the index is being built */
 r = sim_tape_rewind (uptr);
 while (r == SCPE_OK) {
     if (stop_cpu) { /* SIGINT? */
@@ -3638,6 +4242,8 @@ if (!stop_cpu) {            /* if SIGINT didn't interrupt the scan */
 free (buf_f);
 free (buf_r);
 free (rec_sizes);
+if (ctx != NULL)
+    ctx->index_suspend = FALSE;
 uptr->pos = saved_pos;
 (void)sim_tape_seek (uptr, uptr->pos);
 return SCPE_OK;
@@ -4256,6 +4862,270 @@ return SCPE_OK;
 
 #include <setjmp.h>
 
+/* Compare spacing and reverse reads performed with and without the record index */
+
+struct index_test_result {
+    t_stat      st;
+    uint32      count1;
+    uint32      count2;
+    t_addr      pos;
+    t_bool      pnu;
+    };
+
+static int sim_tape_test_index_result (UNIT *uptr, struct index_test_result *res, int n, t_stat st, uint32 count1, uint32 count2)
+{
+res[n].st = st;
+res[n].count1 = count1;
+res[n].count2 = count2;
+res[n].pos = uptr->pos;
+res[n].pnu = MT_TST_PNU (uptr) ? TRUE : FALSE;
+return n + 1;
+}
+
+static int sim_tape_test_index_ops (UNIT *uptr, uint8 *buf, struct index_test_result *res)
+{
+int n = 0;
+uint32 a, b, c;
+t_mtrlnt bc;
+t_stat st;
+
+sim_tape_rewind (uptr);
+st = sim_tape_sprecsf (uptr, 3, &a);
+n = sim_tape_test_index_result (uptr, res, n, st, a, 0);
+st = sim_tape_sprecsf (uptr, 100000, &a);
+n = sim_tape_test_index_result (uptr, res, n, st, a, 0);
+st = sim_tape_sprecsr (uptr, 2, &a);
+n = sim_tape_test_index_result (uptr, res, n, st, a, 0);
+st = sim_tape_sprecsr (uptr, 100000, &a);
+n = sim_tape_test_index_result (uptr, res, n, st, a, 0);
+st = sim_tape_spfilef (uptr, 2, &a);
+n = sim_tape_test_index_result (uptr, res, n, st, a, 0);
+st = sim_tape_sprecsr (uptr, 1, &a);
+n = sim_tape_test_index_result (uptr, res, n, st, a, 0);
+st = sim_tape_rdrecr (uptr, buf, &bc, MTR_MAXLEN);
+n = sim_tape_test_index_result (uptr, res, n, st, bc, 0);
+st = sim_tape_rdrecf (uptr, buf, &bc, MTR_MAXLEN);
+n = sim_tape_test_index_result (uptr, res, n, st, bc, 0);
+st = sim_tape_position (uptr, MTPOS_M_REW | MTPOS_M_OBJ, 37, &a, 0, &b, &c);
+n = sim_tape_test_index_result (uptr, res, n, st, c, 0);
+st = sim_tape_spfilebyrecr (uptr, 1, &a, &b);
+n = sim_tape_test_index_result (uptr, res, n, st, a, b);
+st = sim_tape_position (uptr, MTPOS_M_REV | MTPOS_M_OBJ, 9, &a, 0, &b, &c);
+n = sim_tape_test_index_result (uptr, res, n, st, c, 0);
+st = sim_tape_spfilef (uptr, 100, &a);
+n = sim_tape_test_index_result (uptr, res, n, st, a, 0);
+st = sim_tape_sprecsr (uptr, 5, &a);
+n = sim_tape_test_index_result (uptr, res, n, st, a, 0);
+st = sim_tape_sprecsf (uptr, 100000, &a);
+n = sim_tape_test_index_result (uptr, res, n, st, a, 0);
+st = sim_tape_position (uptr, MTPOS_M_REW | MTPOS_M_DLE, 4, &a, 3, &b, &c);
+n = sim_tape_test_index_result (uptr, res, n, st, a, b);
+st = sim_tape_position (uptr, MTPOS_M_REV, 2, &a, 1, &b, &c);
+n = sim_tape_test_index_result (uptr, res, n, st, a, b);
+st = sim_tape_sprecsr (uptr, 100000, &a);
+n = sim_tape_test_index_result (uptr, res, n, st, a, 0);
+st = sim_tape_spfilebyrecr (uptr, 100, &a, &b);
+n = sim_tape_test_index_result (uptr, res, n, st, a, b);
+return n;
+}
+
+static t_stat sim_tape_test_index (UNIT *uptr, const char *filename, const char *format)
+{
+char args[256];
+struct tape_context *ctx;
+struct index_test_result indexed[32], direct[32];
+uint8 *buf;
+uint32 skipped;
+t_mtrlnt bc;
+int pass, i, n;
+t_stat r;
+
+sprintf (args, "%s %s.%s", format, filename, format);
+sim_tape_detach (uptr);
+sim_switches = SWMASK ('F');
+r = sim_tape_attach_ex (uptr, args, 0, 0);
+sim_switches = 0;
+if (r != SCPE_OK)
+    return r;
+ctx = (struct tape_context *)uptr->tape_ctx;
+buf = (uint8 *)calloc (1, MTR_MAXLEN);
+if (buf == NULL) {
+    sim_tape_detach (uptr);
+    return SCPE_MEM;
+    }
+for (pass = 0; pass < 3; pass++) {
+    if (pass == 1) {                        /* rewrite a record in the first file */
+        sim_tape_rewind (uptr);
+        sim_tape_sprecsf (uptr, 3, &skipped);
+        sim_tape_sprecf (uptr, &bc);
+        sim_tape_sprecr (uptr, &bc);
+        sim_tape_wrrecf (uptr, buf, bc);
+        }
+    if (pass == 2) {                        /* end the tape after a short second file */
+        sim_tape_rewind (uptr);
+        sim_tape_spfilef (uptr, 1, &skipped);
+        sim_tape_sprecsf (uptr, 3, &skipped);
+        sim_tape_wrtmk (uptr);
+        sim_tape_wreom (uptr);
+        }
+    n = sim_tape_test_index_ops (uptr, buf, indexed);
+    if (ctx->index_count == 0)
+        r = sim_messagef (SCPE_IERR, "%s format tape %s wasn't indexed\n", format, filename);
+    ctx->index_suspend = TRUE;
+    sim_tape_test_index_ops (uptr, buf, direct);
+    ctx->index_suspend = FALSE;
+    for (i = 0; (i < n) && (r == SCPE_OK); i++) {
+        if ((indexed[i].st != direct[i].st) || (indexed[i].count1 != direct[i].count1) ||
+            (indexed[i].count2 != direct[i].count2) || (indexed[i].pos != direct[i].pos) ||
+            (indexed[i].pnu != direct[i].pnu))
+            r = sim_messagef (SCPE_IERR, "%s format pass %d step %d: indexed status %d, counts %u/%u, pos %" T_ADDR_FMT "u%s vs status %d, counts %u/%u, pos %" T_ADDR_FMT "u%s\n",
+                                         format, pass, i,
+                                         indexed[i].st, indexed[i].count1, indexed[i].count2, indexed[i].pos, indexed[i].pnu ? " (PNU)" : "",
+                                         direct[i].st, direct[i].count1, direct[i].count2, direct[i].pos, direct[i].pnu ? " (PNU)" : "");
+        }
+    if (r != SCPE_OK)
+        break;
+    sim_messagef (SCPE_OK, "%s format pass %d: %d operations matched with %u objects indexed\n", format, pass, n, ctx->index_count);
+    }
+free (buf);
+sim_tape_detach (uptr);
+return r;
+}
+
+/* Write, read back and check the on disk layout of a tape using the streaming buffer */
+
+static t_mtrlnt sim_tape_test_stream_size (int rec)
+{
+if ((rec % 50) == 49)                       /* occasionally too large to buffer */
+    return 150000 + rec;
+return 1 + ((rec * 7919) % 3000);
+}
+
+static void sim_tape_test_stream_fill (uint8 *buf, int rec, t_mtrlnt size)
+{
+t_mtrlnt k;
+
+for (k = 0; k < size; k++)
+    buf[k] = (uint8)(rec + k);
+}
+
+static t_stat sim_tape_test_stream_check (uint8 *buf, int rec, t_mtrlnt size)
+{
+t_mtrlnt k;
+
+for (k = 0; k < size; k++)
+    if (buf[k] != (uint8)(rec + k))
+        return sim_messagef (SCPE_IERR, "record %d byte %u is 0x%02X, expected 0x%02X\n", rec, k, buf[k], (uint8)(rec + k));
+return SCPE_OK;
+}
+
+static t_stat sim_tape_test_stream (UNIT *uptr, const char *format)
+{
+const int records = 400;
+const int file_records = 40;
+char name[64], args[80];
+uint8 *buf = NULL, *fbuf = NULL;
+t_mtrlnt bc, size, meta;
+int rec, objects = 0;
+FILE *f = NULL;
+t_stat r = SCPE_OK;
+t_stat st;
+
+sprintf (name, "TapeTestStream.%s", format);
+sprintf (args, "%s %s", format, name);
+(void)remove (name);
+sim_tape_detach (uptr);
+sim_switches = SWMASK ('F') | SWMASK ('N') | SWMASK ('Q');
+r = sim_tape_attach_ex (uptr, args, 0, 0);
+sim_switches = 0;
+if (r != SCPE_OK)
+    return r;
+buf = (uint8 *)calloc (1, 2 * MTR_MAXLEN);
+fbuf = (uint8 *)calloc (1, 2 * MTR_MAXLEN);
+if ((buf == NULL) || (fbuf == NULL)) {
+    r = SCPE_MEM;
+    goto Done;
+    }
+for (rec = 0; rec < records; rec++) {       /* write the tape */
+    size = sim_tape_test_stream_size (rec);
+    sim_tape_test_stream_fill (buf, rec, size);
+    if (sim_tape_wrrecf (uptr, buf, size) != MTSE_OK) {
+        r = sim_messagef (SCPE_IERR, "writing record %d failed\n", rec);
+        goto Done;
+        }
+    ++objects;
+    if ((rec % file_records) == (file_records - 1)) {
+        sim_tape_wrtmk (uptr);
+        ++objects;
+        }
+    if (rec == 100) {                       /* read back data not yet written to the file */
+        if ((sim_tape_rdrecr (uptr, buf, &bc, 2 * MTR_MAXLEN) != MTSE_OK) ||
+            (bc != size) ||
+            (sim_tape_test_stream_check (buf, rec, bc) != SCPE_OK) ||
+            (sim_tape_rdrecf (uptr, buf, &bc, 2 * MTR_MAXLEN) != MTSE_OK)) {
+            r = sim_messagef (SCPE_IERR, "reading back record %d while writing failed\n", rec);
+            goto Done;
+            }
+        }
+    }
+sim_tape_wrtmk (uptr);
+++objects;
+sim_tape_rewind (uptr);                     /* read it forward */
+for (rec = 0; rec < records; rec++) {
+    st = sim_tape_rdrecf (uptr, buf, &bc, 2 * MTR_MAXLEN);
+    if (st == MTSE_TMK)
+        st = sim_tape_rdrecf (uptr, buf, &bc, 2 * MTR_MAXLEN);
+    if ((st != MTSE_OK) || (bc != sim_tape_test_stream_size (rec)) ||
+        (sim_tape_test_stream_check (buf, rec, bc) != SCPE_OK)) {
+        r = sim_messagef (SCPE_IERR, "forward read of record %d returned %s, length %u\n", rec, sim_tape_error_text (st), bc);
+        goto Done;
+        }
+    }
+for (rec = records - 1; rec >= 0; rec--) {  /* and in reverse */
+    st = sim_tape_rdrecr (uptr, buf, &bc, 2 * MTR_MAXLEN);
+    if (st == MTSE_TMK)
+        st = sim_tape_rdrecr (uptr, buf, &bc, 2 * MTR_MAXLEN);
+    if ((st != MTSE_OK) || (bc != sim_tape_test_stream_size (rec)) ||
+        (sim_tape_test_stream_check (buf, rec, bc) != SCPE_OK)) {
+        r = sim_messagef (SCPE_IERR, "reverse read of record %d returned %s, length %u\n", rec, sim_tape_error_text (st), bc);
+        goto Done;
+        }
+    }
+sim_tape_detach (uptr);
+f = fopen (name, "rb");                     /* check the file layout */
+if (f == NULL) {
+    r = sim_messagef (SCPE_OPENERR, "can't open %s\n", name);
+    goto Done;
+    }
+rec = 0;
+while (sim_fread (&meta, sizeof (meta), 1, f) == 1) {
+    --objects;
+    if (meta == MTR_TMK)
+        continue;
+    size = sim_tape_test_stream_size (rec);
+    if ((meta != size) ||
+        (sim_fread (fbuf, 1, (strcmp (format, "simh") == 0) ? (size + 1) & ~1 : size, f) == 0) ||
+        (sim_tape_test_stream_check (fbuf, rec, size) != SCPE_OK) ||
+        (sim_fread (&meta, sizeof (meta), 1, f) != 1) || (meta != size)) {
+        r = sim_messagef (SCPE_IERR, "%s record %d is malformed\n", name, rec);
+        goto Done;
+        }
+    ++rec;
+    }
+if ((rec != records) || (objects != 0))
+    r = sim_messagef (SCPE_IERR, "%s contains %d records and %d extra objects\n", name, rec, -objects);
+Done:
+if (f)
+    fclose (f);
+free (buf);
+free (fbuf);
+sim_tape_detach (uptr);
+(void)remove (name);
+if (r == SCPE_OK)
+    sim_messagef (SCPE_OK, "%s format streaming test: %d records written and read back\n", format, records);
+return r;
+}
+
 t_stat sim_tape_test (DEVICE *dptr)
 {
 int32 saved_switches = sim_switches;
@@ -4324,6 +5194,20 @@ sim_switches = saved_switches;
 if ((sim_switches & SWMASK ('D')) == 0)
     SIM_TEST(sim_tape_test_remove_tape_files (dptr->units, "TapeTestFile1"));
 
+sim_switches = saved_switches;
+SIM_TEST(sim_tape_test_create_tape_files (dptr->units, "TapeTestFile2", 6, 25, 300));
+
+SIM_TEST(sim_tape_test_index (dptr->units, "TapeTestFile2", "simh"));
+
+SIM_TEST(sim_tape_test_index (dptr->units, "TapeTestFile2", "e11"));
+
+sim_switches = saved_switches;
+SIM_TEST(sim_tape_test_remove_tape_files (dptr->units, "TapeTestFile2"));
+
+SIM_TEST(sim_tape_test_stream (dptr->units, "simh"));
+
+SIM_TEST(sim_tape_test_stream (dptr->units, "e11"));
+
 return SCPE_OK;
 }
 
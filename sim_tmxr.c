@@ -71,6 +71,7 @@
    tmxr_get_packet_ln_ex -              get packet from line with separater byte
    tmxr_poll_rx -                       poll receive
    tmxr_putc_ln -                       put character for line
+   tmxr_put_buffer_ln -                 put block of characters for line
    tmxr_put_packet_ln -                 put packet on line
    tmxr_put_packet_ln_ex -              put packet on line with separator byte
    tmxr_poll_tx -                       poll transmit
@@ -342,6 +343,13 @@
 
 #include <ctype.h>
 #include <math.h>
+#if defined (__linux) || defined (__linux__)
+#include <sys/epoll.h>
+#define TMXR_READY_EPOLL 1
+#if defined (SIM_ASYNCH_IO) && !defined (SIM_ASYNCH_MUX)
+#define TMXR_READY_WAKEUP 1                             /* input wakeups via the asynch queue */
+#endif
+#endif
 
 /* Telnet protocol constants - negatives are for init'ing signed char data */
 
@@ -441,6 +449,7 @@ static u_char mantra[] = {                  /* Telnet Option Negotiation Mantra
     };
 
 #define TMXR_GUARD  ((int32)(lp->serport ? 1 : sizeof(mantra)))/* buffer guard */
+#define TMXR_LINE_BUFSIZE(lp) ((lp)->bufsize ? (lp)->bufsize : TMXR_MAXBUF)/* unbuffered line buffer size */
 
 #define TMXR_LINE_DISABLED (-1)
 
@@ -471,9 +480,9 @@ lp->txdrp = lp->txstall = 0;
 tmxr_set_get_modem_bits (lp, 0, 0, NULL);
 if (lp->mp && (!lp->mp->buffered) && (!lp->txbfd)) {
     lp->txbfd = 0;
-    lp->txbsz = TMXR_MAXBUF;
+    lp->txbsz = TMXR_LINE_BUFSIZE (lp);
     lp->txb = (char *)realloc (lp->txb, lp->txbsz);
-    lp->rxbsz = TMXR_MAXBUF;
+    lp->rxbsz = TMXR_LINE_BUFSIZE (lp);
     lp->rxb = (char *)realloc(lp->rxb, lp->rxbsz);
     lp->rbr = (char *)realloc(lp->rbr, lp->rxbsz);
     }
@@ -695,25 +704,41 @@ else                                                    /* Telnet connection */
    Up to "length" characters are written from the character buffer associated
    with "lp".  The actual number of characters written is returned.  If an error
    occurred while writing, -1 is returned.
+
+   Data which wraps around the end of the buffer is written with a single
+   gathered write on stream sockets; otherwise only the data up to the end
+   of the buffer is written.
 */
 
 static int32 tmxr_write (TMLN *lp, int32 length)
 {
 int32 written = 0;
 int32 i = lp->txbpr;
+int32 contig = MIN (length, lp->txbsz - i);             /* data up to buffer wrap */
 
 if ((lp->txbps) && (sim_gtime () < lp->txnexttime) && (sim_is_running))
     return 0;
 
 if (lp->loopback)
-    return loop_write (lp, &(lp->txb[i]), length);
+    return loop_write (lp, &(lp->txb[i]), contig);
 
 if (lp->serport) {                                      /* serial port connection? */
-    written = sim_write_serial (lp->serport, &(lp->txb[i]), length);
+    written = sim_write_serial (lp->serport, &(lp->txb[i]), contig);
     }
 else {
     if (lp->sock) {                                     /* Telnet connection */
-        written = sim_write_sock (lp->sock, &(lp->txb[i]), length);
+        if ((contig < length) && (!lp->datagram)) {     /* wrapped stream data? */
+            const char *msgs[2];
+            int lens[2];
+
+            msgs[0] = &(lp->txb[i]);                    /* send both pieces at once */
+            lens[0] = contig;
+            msgs[1] = lp->txb;
+            lens[1] = length - contig;
+            written = sim_writev_sock (lp->sock, msgs, lens, 2);
+            }
+        else
+            written = sim_write_sock (lp->sock, &(lp->txb[i]), contig);
 
         if (written == SOCKET_ERROR) {                  /* did an error occur? */
             lp->txdone = TRUE;
@@ -726,9 +751,9 @@ else {
     else {
         if ((lp->conn == TMXR_LINE_DISABLED) ||
             ((lp->conn == 0) && lp->txbfd)){
-            written = length;                           /* Count here output timing is correct */
+            written = contig;                           /* Count here output timing is correct */
             if (lp->conn == TMXR_LINE_DISABLED)
-                lp->txdrp += length;                    /* Record as having been dropped on the floor */
+                lp->txdrp += contig;                    /* Record as having been dropped on the floor */
             }
         }
     }
@@ -876,6 +901,8 @@ if (mp->logfiletmpl[0])                                 /* logfile info */
     sprintf (growstring(&tptr, 7 + strlen (mp->logfiletmpl)), ",Log=%s", mp->logfiletmpl);
 if (mp->buffered)
     sprintf (growstring(&tptr, 10 + 10), ",Buffered=%d", mp->buffered);
+if (mp->bufsize)
+    sprintf (growstring(&tptr, 10 + 10), ",BufSize=%d", mp->bufsize);
 while ((*tptr == ',') || (*tptr == ' '))
     memmove (tptr, tptr+1, strlen(tptr+1)+1);
 for (i=0; i<mp->lines; ++i) {
@@ -936,6 +963,8 @@ if (lp->destination || lp->port || lp->txlogname || (lp->conn == TMXR_LINE_DISAB
         sprintf (growstring(&tptr, 32), ",Buffered=%d", lp->txbsz);
     if (!lp->txbfd && (lp->mp->buffered > 0))
         sprintf (growstring(&tptr, 32), ",UnBuffered");
+    if (lp->bufsize != lp->mp->bufsize)
+        sprintf (growstring(&tptr, 32), ",BufSize=%d", TMXR_LINE_BUFSIZE (lp));
     if (lp->mp->datagram != lp->datagram)
         sprintf (growstring(&tptr, 8), ",%s", lp->datagram ? "UDP" : "TCP");
     if (lp->mp->packet != lp->packet)
@@ -979,6 +1008,468 @@ mp->poll_interval = seconds;
 return SCPE_OK;
 }
 
+/* Socket readiness
+
+   On hosts with a large number of connected lines, asking each line's
+   socket for data on every receive poll costs a system call per line
+   even when nothing has arrived, and every listening socket is asked for
+   a new connection each connection poll.  Where the host provides epoll
+   (Linux), each multiplexer keeps its connected line sockets in one
+   readiness set and its listening sockets in another.  A receive or
+   connection poll first collects the sockets which have something
+   pending with a single epoll_wait() call, and then only reads from (or
+   accepts on) those.
+
+   Sockets are added to the sets as they are noticed by a poll and are
+   removed before they are closed.  Serial port and loopback lines, and
+   any socket which could not be added to a set, are polled directly
+   as before.  If the sets can't be created, all polls are direct.
+*/
+
+#if defined (TMXR_READY_EPOLL)
+
+#define TMXR_RDY_SOCK   1                               /* line socket readable */
+#define TMXR_RDY_LISTEN 2                               /* line listener readable */
+
+#define TMXR_RDY_MUX    0xFFFFFFFFu                     /* event tag for the mux listener */
+
+struct tmxr_ready {
+    int                 epfd;                           /* line socket set (-1 if unavailable) */
+    int                 lepfd;                          /* listener set */
+    int32               lines;                          /* line count when sets were created */
+    SOCKET              master;                         /* mux listener in the set */
+    t_bool              master_ready;                   /* mux listener readable */
+    SOCKET              *sock;                          /* line socket in the set (per line) */
+    SOCKET              *lmaster;                       /* line listener in the set (per line) */
+    uint8               *flags;                         /* TMXR_RDY_* readiness (per line) */
+    struct epoll_event  *events;                        /* epoll_wait result buffer */
+    int32               max_events;                     /* size of events */
+    t_bool              wakeup;                         /* line socket set watched for wakeups */
+    t_bool              armed;                          /* wakeup armed for the next arrival */
+    };
+
+static void tmxr_wakeup_forget (TMXR *mp);
+
+static void tmxr_ready_free (TMXR *mp)
+{
+struct tmxr_ready *rp = mp->ready;
+
+if (rp == NULL)
+    return;
+tmxr_wakeup_forget (mp);
+if (rp->epfd >= 0)
+    close (rp->epfd);
+if (rp->lepfd >= 0)
+    close (rp->lepfd);
+free (rp->sock);
+free (rp->lmaster);
+free (rp->flags);
+free (rp->events);
+free (rp);
+mp->ready = NULL;
+}
+
+/* Change the socket registered in one slot of a readiness set */
+
+static void tmxr_ready_watch (int epfd, SOCKET *slot, SOCKET sock, uint32 tag)
+{
+struct epoll_event ev;
+
+if (*slot == sock)
+    return;
+if (*slot)
+    epoll_ctl (epfd, EPOLL_CTL_DEL, *slot, &ev);
+*slot = 0;
+if (sock == 0)
+    return;
+memset (&ev, 0, sizeof (ev));
+ev.events = EPOLLIN;
+ev.data.u32 = tag;
+if (epoll_ctl (epfd, EPOLL_CTL_ADD, sock, &ev) == 0)
+    *slot = sock;
+}
+
+/* Bring the readiness sets in line with the multiplexer's sockets and
+   collect the line sockets (or the listeners) which are readable now.
+
+   Returns FALSE if no readiness set is available.
+*/
+
+static t_bool tmxr_ready_update (TMXR *mp, t_bool listeners)
+{
+struct tmxr_ready *rp = mp->ready;
+int32 i;
+int n;
+
+if ((rp != NULL) && (rp->lines != mp->lines))           /* line count changed? */
+    tmxr_ready_free (mp);                               /* start over */
+rp = mp->ready;
+if (rp == NULL) {
+    rp = (struct tmxr_ready *)calloc (1, sizeof (*rp));
+    if (rp == NULL)
+        return FALSE;
+    mp->ready = rp;
+    rp->lines = mp->lines;
+    rp->max_events = mp->lines + 1;
+    rp->sock = (SOCKET *)calloc (mp->lines + 1, sizeof (*rp->sock));
+    rp->lmaster = (SOCKET *)calloc (mp->lines + 1, sizeof (*rp->lmaster));
+    rp->flags = (uint8 *)calloc (mp->lines + 1, sizeof (*rp->flags));
+    rp->events = (struct epoll_event *)calloc (rp->max_events, sizeof (*rp->events));
+    rp->epfd = rp->lepfd = -1;
+    if (rp->sock && rp->lmaster && rp->flags && rp->events) {
+        rp->epfd = epoll_create (rp->max_events);
+        rp->lepfd = epoll_create (rp->max_events);
+        }
+    if ((rp->epfd < 0) || (rp->lepfd < 0)) {
+        if (rp->epfd >= 0)
+            close (rp->epfd);
+        if (rp->lepfd >= 0)
+            close (rp->lepfd);
+        rp->epfd = rp->lepfd = -1;
+        sim_debug (TMXR_DBG_CON, mp->dptr, "tmxr_ready_update() - readiness set unavailable, polling every line\n");
+        }
+    }
+if (rp->epfd < 0)
+    return FALSE;
+tmxr_ready_watch (rp->lepfd, &rp->master, mp->master, TMXR_RDY_MUX);
+for (i = 0; i < mp->lines; i++) {
+    TMLN *lp = mp->ldsc + i;
+
+    tmxr_ready_watch (rp->epfd, &rp->sock[i], (lp->serport || lp->loopback) ? 0 : lp->sock, (uint32)i);
+    tmxr_ready_watch (rp->lepfd, &rp->lmaster[i], lp->master, (uint32)i);
+    }
+n = epoll_wait (listeners ? rp->lepfd : rp->epfd, rp->events, rp->max_events, 0);
+for (i = 0; i < n; i++) {
+    uint32 tag = rp->events[i].data.u32;
+
+    if (tag == TMXR_RDY_MUX)
+        rp->master_ready = TRUE;
+    else
+        rp->flags[tag] |= listeners ? TMXR_RDY_LISTEN : TMXR_RDY_SOCK;
+    }
+return TRUE;
+}
+
+/* Determine whether a socket known to the readiness sets has nothing
+   pending.  The readiness indication is consumed, since the caller is
+   about to read (or accept) whatever is pending.
+*/
+
+static t_bool tmxr_ready_idle (TMXR *mp, TMLN *lp, t_bool listener)
+{
+struct tmxr_ready *rp = mp->ready;
+SOCKET sock;
+uint8 bit;
+int32 ln;
+
+if ((rp == NULL) || (rp->epfd < 0))
+    return FALSE;
+if (lp == NULL) {                                       /* mux listener? */
+    if ((mp->master == 0) || (rp->master != mp->master))
+        return FALSE;                                   /* not in the set - poll it */
+    if (!rp->master_ready)
+        return TRUE;
+    rp->master_ready = FALSE;
+    return FALSE;
+    }
+ln = (int32)(lp - mp->ldsc);
+sock = listener ? lp->master : lp->sock;
+if ((sock == 0) || (sock != (listener ? rp->lmaster[ln] : rp->sock[ln])))
+    return FALSE;                                       /* not in the set - poll it */
+bit = listener ? TMXR_RDY_LISTEN : TMXR_RDY_SOCK;
+if ((rp->flags[ln] & bit) == 0)
+    return TRUE;
+rp->flags[ln] &= ~bit;
+return FALSE;
+}
+
+/* Note that input reported on a line socket was left for a later poll */
+
+static void tmxr_ready_unread (TMXR *mp, TMLN *lp)
+{
+struct tmxr_ready *rp = mp->ready;
+int32 ln = (int32)(lp - mp->ldsc);
+
+if ((rp != NULL) && (rp->epfd >= 0) && lp->sock && (rp->sock[ln] == lp->sock))
+    rp->flags[ln] |= TMXR_RDY_SOCK;
+}
+
+/* Remove a socket which is about to be closed from the readiness sets */
+
+static void tmxr_ready_forget (TMXR *mp, SOCKET sock)
+{
+struct tmxr_ready *rp = mp ? mp->ready : NULL;
+int32 i;
+
+if ((rp == NULL) || (rp->epfd < 0) || (sock == 0))
+    return;
+if (rp->master == sock) {
+    tmxr_ready_watch (rp->lepfd, &rp->master, 0, 0);
+    rp->master_ready = FALSE;
+    }
+for (i = 0; i < rp->lines; i++) {
+    if (rp->sock[i] == sock) {
+        tmxr_ready_watch (rp->epfd, &rp->sock[i], 0, 0);
+        rp->flags[i] &= ~TMXR_RDY_SOCK;
+        }
+    if (rp->lmaster[i] == sock) {
+        tmxr_ready_watch (rp->lepfd, &rp->lmaster[i], 0, 0);
+        rp->flags[i] &= ~TMXR_RDY_LISTEN;
+        }
+    }
+}
+
+#else /* !defined (TMXR_READY_EPOLL) */
+
+static void tmxr_ready_free (TMXR *mp)
+{
+}
+
+static t_bool tmxr_ready_update (TMXR *mp, t_bool listeners)
+{
+return FALSE;
+}
+
+static t_bool tmxr_ready_idle (TMXR *mp, TMLN *lp, t_bool listener)
+{
+return FALSE;
+}
+
+static void tmxr_ready_unread (TMXR *mp, TMLN *lp)
+{
+}
+
+static void tmxr_ready_forget (TMXR *mp, SOCKET sock)
+{
+}
+
+#endif /* defined (TMXR_READY_EPOLL) */
+
+/* Input wakeups
+
+   Multiplexer devices poll for input from a unit scheduled at a fixed
+   rate, so a character arriving just after a poll waits a full poll
+   interval (or longer, while the simulator is idling) before it is
+   seen.  While the simulator runs with asynchronous I/O enabled, a
+   wakeup thread watches the line socket readiness set of each
+   multiplexer.  When a receive poll finds that everything reported has
+   been read, the set is armed for a single wakeup; if input then
+   arrives before the next poll, the thread activates that line's
+   polling unit immediately via the asynchronous event queue (which
+   also ends any idle sleep).
+
+   A set is not armed while reported input is still waiting to be read
+   (the line's receive buffer is full or receive is disabled), so input
+   which the device isn't ready to accept can't cause repeated wakeups.
+   Units statically flagged TMUF_NOASYNCH are left to their regular
+   polling.  The thread is started by the first arming while running and
+   stopped when the simulator stops.
+*/
+
+#if defined (TMXR_READY_WAKEUP)
+
+static int tmxr_wakeup_epfd = -1;                       /* set of readiness sets */
+static int tmxr_wakeup_pipe[2] = {-1, -1};              /* closed to stop the thread */
+static pthread_t tmxr_wakeup_thread;
+static pthread_mutex_t tmxr_wakeup_lock = PTHREAD_MUTEX_INITIALIZER;
+static t_bool tmxr_wakeup_running = FALSE;
+static TMXR **tmxr_wakeup_muxes = NULL;                 /* multiplexers watched */
+static int32 tmxr_wakeup_count = 0;
+
+static void *
+_tmxr_wakeup (void *arg)
+{
+struct epoll_event events[16];
+struct epoll_event *lev = NULL;
+UNIT **units = NULL;
+int32 lev_size = 0;
+
+/* Boost Priority for this I/O thread vs the CPU instruction execution 
+   thread which, in general, won't be readily yielding the processor when 
+   this thread needs to run */
+sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+
+while (1) {
+    int i, n = epoll_wait (tmxr_wakeup_epfd, events, 16, -1);
+
+    if ((n < 0) && (errno != EINTR))
+        break;
+    for (i = 0; i < n; i++) {
+        TMXR *mp = (TMXR *)events[i].data.ptr;
+        struct tmxr_ready *rp = NULL;
+        int32 j, k, nl, nunits = 0;
+
+        if (mp == NULL)                                 /* stop requested? */
+            goto Done;
+        pthread_mutex_lock (&tmxr_wakeup_lock);
+        for (j = 0; j < tmxr_wakeup_count; j++)         /* still watched? */
+            if (tmxr_wakeup_muxes[j] == mp)
+                rp = mp->ready;
+        if (rp != NULL) {
+            rp->armed = FALSE;
+            if (lev_size < rp->max_events) {
+                free (lev);
+                free (units);
+                lev = (struct epoll_event *)calloc (rp->max_events, sizeof (*lev));
+                units = (UNIT **)calloc (rp->max_events, sizeof (*units));
+                lev_size = (lev && units) ? rp->max_events : 0;
+                }
+            nl = lev_size ? epoll_wait (rp->epfd, lev, lev_size, 0) : 0;
+            for (j = 0; j < nl; j++) {
+                int32 ln = (int32)lev[j].data.u32;
+                UNIT *uptr = mp->ldsc[ln].uptr ? mp->ldsc[ln].uptr : mp->uptr;
+
+                for (k = 0; k < nunits; k++)            /* activate each unit once */
+                    if (units[k] == uptr)
+                        break;
+                if ((k < nunits) || (uptr == NULL) || !(uptr->dynflags & UNIT_TM_POLL))
+                    continue;
+                units[nunits++] = uptr;
+                sim_debug (TMXR_DBG_ASY, mp->dptr, "_tmxr_wakeup() - Line %d input, activating %s\n", ln, sim_uname (uptr));
+                sim_activate_abs (uptr, 0);
+                }
+            }
+        pthread_mutex_unlock (&tmxr_wakeup_lock);
+        }
+    }
+Done:
+free (lev);
+free (units);
+return NULL;
+}
+
+static void tmxr_wakeup_start (void)
+{
+struct epoll_event ev;
+pthread_attr_t attr;
+int r;
+
+if (tmxr_wakeup_running)
+    return;
+tmxr_wakeup_epfd = epoll_create (16);
+if (tmxr_wakeup_epfd < 0)
+    return;
+if (pipe (tmxr_wakeup_pipe)) {
+    close (tmxr_wakeup_epfd);
+    tmxr_wakeup_epfd = -1;
+    return;
+    }
+memset (&ev, 0, sizeof (ev));
+ev.events = EPOLLIN;
+ev.data.ptr = NULL;                                     /* stop indication */
+epoll_ctl (tmxr_wakeup_epfd, EPOLL_CTL_ADD, tmxr_wakeup_pipe[0], &ev);
+pthread_attr_init (&attr);
+pthread_attr_setscope (&attr, PTHREAD_SCOPE_SYSTEM);
+r = pthread_create (&tmxr_wakeup_thread, &attr, _tmxr_wakeup, NULL);
+pthread_attr_destroy (&attr);
+if (r == 0) {
+    tmxr_wakeup_running = TRUE;
+    return;
+    }
+close (tmxr_wakeup_pipe[0]);
+close (tmxr_wakeup_pipe[1]);
+close (tmxr_wakeup_epfd);
+tmxr_wakeup_epfd = -1;
+}
+
+static void tmxr_wakeup_stop (void)
+{
+int32 i;
+
+if (!tmxr_wakeup_running)
+    return;
+close (tmxr_wakeup_pipe[1]);                            /* wake the thread with EOF */
+pthread_join (tmxr_wakeup_thread, NULL);
+tmxr_wakeup_running = FALSE;
+pthread_mutex_lock (&tmxr_wakeup_lock);
+for (i = 0; i < tmxr_wakeup_count; i++)
+    if (tmxr_wakeup_muxes[i]->ready)
+        tmxr_wakeup_muxes[i]->ready->wakeup = tmxr_wakeup_muxes[i]->ready->armed = FALSE;
+free (tmxr_wakeup_muxes);
+tmxr_wakeup_muxes = NULL;
+tmxr_wakeup_count = 0;
+pthread_mutex_unlock (&tmxr_wakeup_lock);
+close (tmxr_wakeup_pipe[0]);
+close (tmxr_wakeup_epfd);
+tmxr_wakeup_epfd = -1;
+}
+
+/* Arm a wakeup for the next input arriving on a multiplexer */
+
+static void tmxr_wakeup_arm (TMXR *mp)
+{
+struct tmxr_ready *rp = mp->ready;
+struct epoll_event ev;
+int32 i;
+
+if ((rp == NULL) || (rp->epfd < 0) || rp->armed || (mp->uptr == NULL) ||
+    (mp->uptr->flags & TMUF_NOASYNCH) || !(mp->uptr->dynflags & UNIT_TM_POLL) ||
+    !sim_asynch_enabled || !sim_is_running)
+    return;
+for (i = 0; i < rp->lines; i++)
+    if (rp->flags[i] & TMXR_RDY_SOCK)                   /* input left unread? */
+        return;
+tmxr_wakeup_start ();
+if (!tmxr_wakeup_running)
+    return;
+pthread_mutex_lock (&tmxr_wakeup_lock);
+memset (&ev, 0, sizeof (ev));
+ev.events = EPOLLIN | EPOLLONESHOT;
+ev.data.ptr = (void *)mp;
+if (!rp->wakeup) {                                      /* first arming? */
+    TMXR **muxes = (TMXR **)realloc (tmxr_wakeup_muxes, (tmxr_wakeup_count + 1) * sizeof (*muxes));
+
+    if ((muxes != NULL) &&
+        (epoll_ctl (tmxr_wakeup_epfd, EPOLL_CTL_ADD, rp->epfd, &ev) == 0)) {
+        tmxr_wakeup_muxes = muxes;
+        tmxr_wakeup_muxes[tmxr_wakeup_count++] = mp;
+        rp->wakeup = rp->armed = TRUE;
+        }
+    else if (muxes != NULL)
+        tmxr_wakeup_muxes = muxes;
+    }
+else
+    if (epoll_ctl (tmxr_wakeup_epfd, EPOLL_CTL_MOD, rp->epfd, &ev) == 0)
+        rp->armed = TRUE;
+pthread_mutex_unlock (&tmxr_wakeup_lock);
+}
+
+/* Stop watching a multiplexer whose readiness sets are going away */
+
+static void tmxr_wakeup_forget (TMXR *mp)
+{
+struct tmxr_ready *rp = mp->ready;
+struct epoll_event ev;
+int32 i;
+
+if (!rp->wakeup)
+    return;
+pthread_mutex_lock (&tmxr_wakeup_lock);
+epoll_ctl (tmxr_wakeup_epfd, EPOLL_CTL_DEL, rp->epfd, &ev);
+for (i = 0; i < tmxr_wakeup_count; i++)
+    if (tmxr_wakeup_muxes[i] == mp) {
+        tmxr_wakeup_muxes[i] = tmxr_wakeup_muxes[--tmxr_wakeup_count];
+        break;
+        }
+rp->wakeup = rp->armed = FALSE;
+pthread_mutex_unlock (&tmxr_wakeup_lock);
+}
+
+#else /* !defined (TMXR_READY_WAKEUP) */
+
+static void tmxr_wakeup_arm (TMXR *mp)
+{
+}
+
+#if defined (TMXR_READY_EPOLL)
+static void tmxr_wakeup_forget (TMXR *mp)
+{
+}
+#endif
+
+#endif /* defined (TMXR_READY_WAKEUP) */
+
+
 /* Poll for new connection
 
    Called from unit service routine to test for new connection
@@ -1051,6 +1542,7 @@ srand((unsigned int)poll_time);
 tmxr_debug_trace (mp, "tmxr_poll_conn()");
 
 mp->last_poll_time = poll_time;
+tmxr_ready_update (mp, TRUE);                           /* find listeners with pending connections */
 
 /* Check for a pending Telnet/tcp connection */
 
@@ -1061,6 +1553,8 @@ if (mp->master) {
         address = mp->ring_ipad;
         mp->ring_ipad = NULL;
         }
+    else if (tmxr_ready_idle (mp, NULL, FALSE))         /* nothing pending? */
+        newsock = INVALID_SOCKET;
     else
         newsock = sim_accept_conn_ex (mp->master, &address, (mp->packet ? SIM_SOCK_OPT_NODELAY : 0));/* poll connect */
 
@@ -1222,7 +1716,8 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
                     }
                 break;
             case 1:
-                if (lp->master) {                                   /* Check for a pending Telnet/tcp connection */
+                if (lp->master &&                                   /* Check for a pending Telnet/tcp connection */
+                    !tmxr_ready_idle (mp, lp, TRUE)) {
                     while (INVALID_SOCKET != (newsock = sim_accept_conn_ex (lp->master, &address, (lp->packet ? SIM_SOCK_OPT_NODELAY : 0)))) {/* got a live one? */
                         char *sockname, *peername;
 
@@ -1344,6 +1839,7 @@ if (lp->serport) {
     }
 else                                                    /* Telnet connection */
     if (lp->sock) {
+        tmxr_ready_forget (lp->mp, lp->sock);           /* drop from readiness set */
         sim_close_sock (lp->sock);                      /* close socket */
         free (lp->telnet_sent_opts);
         lp->telnet_sent_opts = NULL;
@@ -2021,11 +2517,14 @@ int32 i, nbytes, j;
 TMLN *lp;
 
 tmxr_debug_trace (mp, "tmxr_poll_rx()");
+tmxr_ready_update (mp, FALSE);                          /* find sockets with pending data */
 for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
     lp = mp->ldsc + i;                                  /* get line desc */
     if (!(lp->sock || lp->serport || lp->loopback) || 
         !(lp->rcve))                                    /* skip if not connected */
         continue;
+    if (tmxr_ready_idle (mp, lp, FALSE))                /* nothing arrived? */
+        continue;
 
     nbytes = 0;
     if (lp->rxbpi == 0)                                 /* need input? */
@@ -2034,6 +2533,8 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
     else if (lp->tsta)                                  /* in Telnet seq? */
         nbytes = tmxr_read (lp,                         /* yes, read to end */
             lp->rxbsz - lp->rxbpi);
+    else
+        tmxr_ready_unread (mp, lp);                     /* leave input for a later poll */
 
     if (nbytes < 0) {                                   /* line error? */
         if (!lp->datagram) {                            /* ignore errors reading UDP sockets */
@@ -2252,6 +2753,7 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
     if (lp->rxbpi == lp->rxbpr)                         /* if buf empty, */
         lp->rxbpi = lp->rxbpr = 0;                      /* reset pointers */
     }                                                   /* end for */
+tmxr_wakeup_arm (mp);                                   /* wake early for the next input */
 }
 
 
@@ -2349,6 +2851,99 @@ if ((lp->conn && (TXBUF_AVAIL(lp) > 1)) ||              /* connected and room fo
 return SCPE_STALL;                                      /* char not sent */
 }
 
+/* Store a block of characters in line buffer
+
+   Inputs:
+        *lp     =       pointer to line descriptor
+        *buf    =       pointer to characters
+        size    =       number of characters
+        *count  =       pointer to count of characters stored (or NULL)
+
+   Outputs:
+        status  =       ok, connection lost, or stall
+
+   Implementation notes:
+
+    1. The characters are handled as though each had been passed to 
+       tmxr_putc_ln, but on a connected line without expect rules whole 
+       runs of them are copied into the transmit buffer at once.  Devices 
+       doing bulk (DMA) output should use this and let the line buffer be 
+       sized to suit with the BufSize attach option.
+    2. On a rate limited line the data is paced as it leaves the buffer,
+       and the line transmit is disabled until the time for the data has 
+       passed, just as after tmxr_putc_ln.
+    3. If only some of the characters fit, SCPE_STALL is returned with 
+       *count set to the number stored.  The rest should be offered again 
+       once the line transmit is enabled.
+*/
+
+t_stat tmxr_put_buffer_ln (TMLN *lp, const uint8 *buf, size_t size, size_t *count)
+{
+size_t stored = 0;
+t_stat r = SCPE_OK;
+
+tmxr_debug_trace_line (lp, "tmxr_put_buffer_ln()");
+if ((lp->conn == FALSE) || lp->serport ||               /* not a plain line? */
+    (lp->expect.size > 0) || (!sim_is_running)) {
+    while ((stored < size) &&                           /* one at a time */
+           (SCPE_OK == (r = tmxr_putc_ln (lp, buf[stored]))))
+        ++stored;
+    if (count)
+        *count = stored;
+    return r;
+    }
+if ((lp->xmte == 0) && (TXBUF_AVAIL(lp) > 1) &&
+    ((lp->txbps == 0) || (lp->txnexttime <= sim_gtime ())))
+    lp->xmte = 1;                                       /* enable line transmit */
+while (stored < size) {
+    int32 avail = TXBUF_AVAIL(lp) - 1;                  /* free buffer space */
+    int32 n = (int32)MIN (size - stored, (size_t)avail);
+    const uint8 *iac = NULL;
+
+    if (n <= 0)
+        break;
+    if (!lp->notelnet)                                  /* telnet IAC must be doubled */
+        iac = (const uint8 *)memchr (buf + stored, TN_IAC, n);
+    if (iac == buf + stored) {                          /* IAC next? */
+        if (avail < 2)
+            break;
+        TXBUF_CHAR (lp, TN_IAC);
+        TXBUF_CHAR (lp, TN_IAC);
+        n = 1;
+        }
+    else {
+        int32 first;
+
+        if (iac)                                        /* copy up to the IAC */
+            n = (int32)(iac - (buf + stored));
+        first = MIN (n, lp->txbsz - lp->txbpi);         /* copy in up to two pieces */
+        memcpy (&lp->txb[lp->txbpi], buf + stored, first);
+        memcpy (lp->txb, buf + stored + first, n - first);
+        lp->txbpi = (lp->txbpi + n) % lp->txbsz;
+        }
+    if (lp->txlog) {                                    /* log if available */
+        extern TMLN *sim_oline;                         /* Make sure to avoid recursion */
+        TMLN *save_oline = sim_oline;                   /* when logging to a socket */
+
+        sim_oline = NULL;                               /* save output socket */
+        fwrite (buf + stored, 1, n, lp->txlog);         /* log to actual file */
+        sim_oline = save_oline;                         /* resture output socket */
+        }
+    stored += n;
+    }
+if (((!lp->txbfd) && 
+     (TXBUF_AVAIL (lp) <= TMXR_GUARD)) ||               /* near full? */
+    (lp->txbps))                                        /* or we're rate limiting output */
+    lp->xmte = 0;                                       /* disable line transmit until space available or character time has passed */
+if (stored < size) {
+    ++lp->txstall; lp->xmte = 0;                        /* no room, dsbl line */
+    r = SCPE_STALL;
+    }
+if (count)
+    *count = stored;
+return r;
+}
+
 /* Store packet in line buffer
 
    Inputs:
@@ -2457,15 +3052,16 @@ t_stat r;
 tmxr_debug_trace_line (lp, "tmxr_send_buffered_data()");
 nbytes = tmxr_tqln(lp);                                 /* avail bytes */
 if (nbytes) {                                           /* >0? write */
-    if (lp->txbpr < lp->txbpi)                          /* no wrap? */
-        sbytes = tmxr_write (lp, nbytes);               /* write all data */
-    else
-        sbytes = tmxr_write (lp, lp->txbsz - lp->txbpr);/* write to end buf */
+    int32 contig = MIN (nbytes, lp->txbsz - lp->txbpr); /* data up to buffer wrap */
+
+    sbytes = tmxr_write (lp, nbytes);                   /* write all data (or to end buf) */
     if (sbytes >= 0) {                                  /* ok? */
-        tmxr_debug (TMXR_DBG_XMT, lp, "Sent", &(lp->txb[lp->txbpr]), sbytes);
+        tmxr_debug (TMXR_DBG_XMT, lp, "Sent", &(lp->txb[lp->txbpr]), MIN (sbytes, contig));
+        if (sbytes > contig)                            /* wrapped data sent too? */
+            tmxr_debug (TMXR_DBG_XMT, lp, "Sent", lp->txb, sbytes - contig);
         lp->txbpr = (lp->txbpr + sbytes);               /* update remove ptr */
         if (lp->txbpr >= lp->txbsz)                     /* wrap? */
-            lp->txbpr = 0;
+            lp->txbpr -= lp->txbsz;
         lp->txcnt = lp->txcnt + sbytes;                 /* update counts */
         nbytes = nbytes - sbytes;
         if ((nbytes == 0) && (lp->datagram))            /* if Empty buffer on datagram line */
@@ -2539,6 +3135,7 @@ return 0;                           /* not done */
 static void _mux_detach_line (TMLN *lp, t_bool close_listener, t_bool close_connecting)
 {
 if (close_listener && lp->master) {
+    tmxr_ready_forget (lp->mp, lp->master);
     sim_close_sock (lp->master);
     lp->master = 0;
     free (lp->port);
@@ -2719,6 +3316,7 @@ int32 i, line, nextline = -1;
 char tbuf[CBUFSIZE], listen[CBUFSIZE], destination[CBUFSIZE], 
      logfiletmpl[CBUFSIZE], buffered[CBUFSIZE], hostport[CBUFSIZE], 
      port[CBUFSIZE], option[CBUFSIZE], speed[CBUFSIZE], dev_name[CBUFSIZE];
+int32 bufsize;
 SOCKET sock;
 SERHANDLE serport;
 CONST char *tptr = cptr;
@@ -2757,6 +3355,7 @@ while (*tptr) {
     packet = mp->packet;
     if (mp->buffered)
         sprintf(buffered, "%d", mp->buffered);
+    bufsize = mp->bufsize;
     if (line != -1) {
         notelnet = listennotelnet = mp->notelnet;
         nomessage = listennomessage = mp->nomessage;
@@ -2810,6 +3409,16 @@ while (*tptr) {
                     }
                 continue;
                 }
+            if (0 == MATCH_CMD (gbuf, "BUFSIZE")) {
+                if ((NULL == cptr) || ('\0' == *cptr))
+                    return sim_messagef (SCPE_2FARG, "Missing BufSize Specifier\n");
+                bufsize = (int32) get_uint (cptr, 10, 1024*1024, &r);
+                if (r || (bufsize < TMXR_MAXBUF))
+                    return sim_messagef (SCPE_ARG, "Invalid BufSize Specifier: %s\n", cptr);
+                if (bufsize == TMXR_MAXBUF)
+                    bufsize = 0;                        /* default size */
+                continue;
+                }
             if (0 == MATCH_CMD (gbuf, "NOLOG")) {
                 if ((NULL != cptr) && ('\0' != *cptr))
                     return sim_messagef (SCPE_2MARG, "Unexpected NoLog Specifier: %s\n", cptr);
@@ -2987,17 +3596,19 @@ while (*tptr) {
                 }
             }
         mp->buffered = atoi(buffered);
+        mp->bufsize = bufsize;
         for (i = 0; i < mp->lines; i++) { /* initialize line buffers */
             lp = mp->ldsc + i;
+            lp->bufsize = bufsize;
             if (mp->buffered) {
                 lp->txbsz = mp->buffered;
                 lp->txbfd = 1;
                 lp->rxbsz = mp->buffered;
                 }
             else {
-                lp->txbsz = TMXR_MAXBUF;
+                lp->txbsz = TMXR_LINE_BUFSIZE (lp);
                 lp->txbfd = 0;
-                lp->rxbsz = TMXR_MAXBUF;
+                lp->rxbsz = TMXR_LINE_BUFSIZE (lp);
                 }
             lp->txbpi = lp->txbpr = 0;
             lp->txb = (char *)realloc(lp->txb, lp->txbsz);
@@ -3023,6 +3634,7 @@ while (*tptr) {
             if (sock == INVALID_SOCKET)                     /* open error */
                 return sim_messagef (SCPE_OPENERR, "Can't open network socket for listen port: %s\n", listen);
             if (mp->port) {                                 /* close prior listener */
+                tmxr_ready_forget (mp, mp->master);
                 sim_close_sock (mp->master);
                 mp->master = 0;
                 free (mp->port);
@@ -3078,6 +3690,7 @@ while (*tptr) {
             if (serport != INVALID_HANDLE) {
                 _mux_detach_line (lp, TRUE, TRUE);
                 if (lp->mp && lp->mp->master) {             /* if existing listener, close it */
+                    tmxr_ready_forget (lp->mp, lp->mp->master);
                     sim_close_sock (lp->mp->master);
                     lp->mp->master = 0;
                     free (lp->mp->port);
@@ -3159,8 +3772,9 @@ while (*tptr) {
                 return sim_messagef (r, "Can't open log file: %s\n", logfiletmpl);
                 }
             }
+        lp->bufsize = bufsize;
         if (buffered[0] == '\0') {
-            lp->rxbsz = lp->txbsz = TMXR_MAXBUF;
+            lp->rxbsz = lp->txbsz = TMXR_LINE_BUFSIZE (lp);
             lp->txbfd = 0;
             }
         else {
@@ -3915,6 +4529,8 @@ if (sim_tmxr_poll_running) {
     }
 else
     pthread_mutex_unlock (&sim_tmxr_poll_lock);
+#elif defined (TMXR_READY_WAKEUP)
+tmxr_wakeup_stop ();
 #endif
 return SCPE_OK;
 }
@@ -4355,6 +4971,7 @@ if (mp->ring_sock != INVALID_SOCKET) {
     mp->ring_ipad = NULL;
     mp->ring_start_time = 0;
     }
+tmxr_ready_free (mp);                                   /* release readiness set */
 _tmxr_remove_from_open_list (mp);
 return SCPE_OK;
 }
@@ -4589,6 +5206,9 @@ if (single_line) {          /* Single Line Multiplexer */
     fprintf (st, "Line buffering can be disabled for the %s device with:\n\n", dptr->name);
     fprintf (st, "   sim> ATTACH %s NoBuffer\n\n", dptr->name);
     fprintf (st, "The default buffer size is 32k bytes, the max buffer size is 1024k bytes\n\n");
+    fprintf (st, "The size of the transmit and receive buffers of an unbuffered line can be\n");
+    fprintf (st, "raised from the default 256 bytes, which can help bulk output, with:\n\n");
+    fprintf (st, "   sim> ATTACH %s BufSize=bufsize\n\n", dptr->name);
     fprintf (st, "The outbound traffic the %s device can be logged to a file with:\n", dptr->name);
     fprintf (st, "   sim> ATTACH %s Log=LogFileName\n\n", dptr->name);
     fprintf (st, "File logging can be disabled for the %s device with:\n\n", dptr->name);
@@ -4624,6 +5244,11 @@ else {
         fprintf (st, "Line buffering for all lines on the %s device can be disabled with:\n\n", dptr->name);
     fprintf (st, "   sim> ATTACH %s NoBuffer\n\n", dptr->name);
     fprintf (st, "The default buffer size is 32k bytes, the max buffer size is 1024k bytes\n\n");
+    fprintf (st, "The size of the transmit and receive buffers of unbuffered lines can be\n");
+    fprintf (st, "raised from the default 256 bytes, which can help bulk output, for all\n");
+    fprintf (st, "lines or for a specific line with:\n\n");
+    fprintf (st, "   sim> ATTACH %s BufSize=bufsize\n", dptr->name);
+    fprintf (st, "   sim> ATTACH %s Line=n,BufSize=bufsize\n\n", dptr->name);
     fprintf (st, "The outbound traffic for the lines of the %s device can be logged to files\n", dptr->name);
     fprintf (st, "with:\n\n");
     fprintf (st, "   sim> ATTACH %s Log=LogFileName\n\n", dptr->name);
@@ -5624,6 +6249,200 @@ if ((dptr) && (dbits & dptr->dctrl)) {
 
 #include <setjmp.h>
 
+/* Exercise socket readiness driven receive polling: only lines whose
+   client sent something may deliver data, and a line whose socket is
+   closed and replaced (possibly by the same descriptor number) must keep
+   receiving */
+
+static t_stat tmxr_ready_test (DEVICE *dptr, TMXR *tmxr)
+{
+SOCKET clients[8];
+int nclients = (tmxr->lines < 8) ? tmxr->lines : 8;
+int i, tries;
+int32 ln, c, count;
+char cmd[CBUFSIZE];
+t_stat stat = SCPE_OK;
+
+tmxr->modem_control = FALSE;
+for (i = 0; i < tmxr->lines; i++)
+    tmxr->ldsc[i].modem_control = FALSE;
+sprintf (cmd, "%s -u localhost:65502;notelnet", dptr->name);
+if (attach_cmd (0, cmd) != SCPE_OK)
+    return sim_messagef (SCPE_IERR, "can't attach %s\n", cmd);
+tmxr = (TMXR *)dptr->units->tmxr;
+for (i = 0; i < nclients; i++)
+    clients[i] = INVALID_SOCKET;
+for (i = 0; (i < nclients + 1) && (stat == SCPE_OK); i++) {
+    int client = (i < nclients) ? i : 1;            /* finally replace client 1's connection */
+
+    if (i == nclients) {
+        sim_close_sock (clients[client]);
+        for (tries = 0; tries < 100; tries++) {     /* wait for the disconnect to be seen */
+            tmxr_poll_rx (tmxr);
+            if (tmxr->ldsc[client].sock == 0)
+                break;
+            sim_os_ms_sleep (10);
+            }
+        }
+    clients[client] = sim_connect_sock ("", "localhost", "65502");
+    for (tries = 0, ln = -1; (tries < 100) && (ln < 0); tries++) {
+        sim_os_ms_sleep (10);
+        ln = tmxr_poll_conn (tmxr);
+        }
+    if (ln != client)
+        stat = sim_messagef (SCPE_IERR, "client %d connected to line %d\n", client, ln);
+    tmxr->ldsc[client].rcve = 1;
+    tmxr->ldsc[client].rxbps = 0;
+    }
+for (i = 0; (i < nclients) && (stat == SCPE_OK); i++) {
+    if (i & 1)                                      /* odd numbered clients send data */
+        sim_write_sock (clients[i], "ready", 5);
+    }
+for (tries = 0; (tries < 100) && (stat == SCPE_OK); tries++) {
+    sim_os_ms_sleep (10);
+    tmxr_poll_rx (tmxr);
+    for (i = 1, count = 0; i < nclients; i += 2)
+        count += tmxr->ldsc[i].rxbpi - tmxr->ldsc[i].rxbpr;
+    if (count == 5 * (nclients / 2))
+        break;
+    }
+for (i = 0; (i < nclients) && (stat == SCPE_OK); i++) {
+    for (count = 0; (c = tmxr_getc_ln (&tmxr->ldsc[i])) & TMXR_VALID; count++)
+        if ((c & 0377) != (int32)"ready"[count % 5])
+            stat = sim_messagef (SCPE_IERR, "line %d received 0x%X\n", i, c & 0377);
+    if (count != ((i & 1) ? 5 : 0))
+        stat = sim_messagef (SCPE_IERR, "line %d received %d characters, expected %d\n", i, count, (i & 1) ? 5 : 0);
+    }
+#if defined (TMXR_READY_EPOLL)
+if ((stat == SCPE_OK) && ((tmxr->ready == NULL) || (tmxr->ready->epfd < 0)))
+    stat = sim_messagef (SCPE_IERR, "readiness set was not used\n");
+#endif
+for (i = 0; i < nclients; i++)
+    if (clients[i] != INVALID_SOCKET)
+        sim_close_sock (clients[i]);
+detach_cmd (0, dptr->name);
+if (stat == SCPE_OK)
+    sim_messagef (SCPE_OK, "%d lines received input selectively\n", nclients);
+return stat;
+}
+
+/* Bulk line output: characters stored with tmxr_putc_ln or with
+   tmxr_put_buffer_ln must arrive intact (telnet IACs doubled) with default
+   and enlarged line buffers.  The throughput of each is reported */
+
+#define TMXR_BULK_BYTES (8*1024*1024)
+
+static t_stat tmxr_bulk_test (DEVICE *dptr, TMXR *tmxr)
+{
+static const struct {
+    const char  *options;                           /* attach options */
+    t_bool      bulk;                               /* store with tmxr_put_buffer_ln */
+    size_t      bytes;                              /* data to send */
+    } cases[] = {
+        {"notelnet",                        FALSE,  TMXR_BULK_BYTES},
+        {"notelnet",                        TRUE,   TMXR_BULK_BYTES},
+        {"notelnet,BufSize=65536",          FALSE,  TMXR_BULK_BYTES},
+        {"notelnet,BufSize=65536",          TRUE,   TMXR_BULK_BYTES},
+        {"telnet;nomessage,BufSize=4096",   TRUE,   TMXR_BULK_BYTES/8},
+        {"telnet;nomessage,BufSize=256",    FALSE,  TMXR_BULK_BYTES/8},
+        };
+uint8 *data = (uint8 *)malloc (TMXR_BULK_BYTES);
+uint8 rbuf[16384];
+char cmd[CBUFSIZE];
+size_t c, i;
+t_stat stat = SCPE_OK;
+
+if (data == NULL)
+    return SCPE_MEM;
+for (i = 0; i < TMXR_BULK_BYTES; i++)               /* pattern including IAC bytes */
+    data[i] = (uint8)((i * 7) + (i >> 9));
+for (c = 0; (c < sizeof (cases) / sizeof (cases[0])) && (stat == SCPE_OK); c++) {
+    SOCKET client;
+    TMLN *lp;
+    int32 ln = -1, rbytes;
+    int tries;
+    size_t sent = 0, checked = 0, skip = 0;
+    t_bool iac_seen = FALSE, telnet;
+    double start, elapsed;
+
+    tmxr->modem_control = FALSE;
+    for (i = 0; i < (size_t)tmxr->lines; i++)
+        tmxr->ldsc[i].modem_control = FALSE;
+    sprintf (cmd, "%s -u localhost:65503;%s", dptr->name, cases[c].options);
+    if (attach_cmd (0, cmd) != SCPE_OK) {
+        stat = sim_messagef (SCPE_IERR, "can't attach %s\n", cmd);
+        break;
+        }
+    tmxr = (TMXR *)dptr->units->tmxr;
+    client = sim_connect_sock_ex (NULL, "localhost:65503", NULL, NULL, 0);
+    for (tries = 0; (tries < 100) && (ln < 0); tries++) {
+        sim_os_ms_sleep (10);
+        ln = tmxr_poll_conn (tmxr);
+        }
+    if (ln < 0) {
+        stat = sim_messagef (SCPE_IERR, "no connection for %s\n", cmd);
+        sim_close_sock (client);
+        detach_cmd (0, dptr->name);
+        break;
+        }
+    lp = &tmxr->ldsc[ln];
+    lp->txbps = 0;
+    telnet = !lp->notelnet;
+    if (telnet)
+        skip = sizeof (mantra);                     /* negotiation sent at connect */
+    sim_is_running = TRUE;                          /* output as when running */
+    start = sim_timenow_double ();
+    while ((checked < cases[c].bytes) && (stat == SCPE_OK)) {
+        if ((sent < cases[c].bytes) && lp->xmte) {
+            if (cases[c].bulk) {
+                size_t stored;
+
+                tmxr_put_buffer_ln (lp, data + sent, cases[c].bytes - sent, &stored);
+                sent += stored;
+                }
+            else {
+                while ((sent < cases[c].bytes) && lp->xmte &&
+                       (SCPE_OK == tmxr_putc_ln (lp, data[sent])))
+                    ++sent;
+                }
+            }
+        tmxr_poll_tx (tmxr);
+        while ((stat == SCPE_OK) && 
+               ((rbytes = sim_read_sock (client, (char *)rbuf, sizeof (rbuf))) > 0)) {
+            for (i = 0; (i < (size_t)rbytes) && (stat == SCPE_OK); i++) {
+                if (skip) {
+                    --skip;
+                    continue;
+                    }
+                if (checked >= cases[c].bytes)
+                    stat = sim_messagef (SCPE_IERR, "%s: extra data received\n", cmd);
+                else if (rbuf[i] != data[checked])
+                    stat = sim_messagef (SCPE_IERR, "%s: received 0x%02X at %d, expected 0x%02X\n", cmd, rbuf[i], (int)checked, data[checked]);
+                else if (telnet && (rbuf[i] == TN_IAC) && !iac_seen)
+                    iac_seen = TRUE;                /* doubled IAC follows */
+                else {
+                    iac_seen = FALSE;
+                    ++checked;
+                    }
+                }
+            }
+        if (rbytes < 0)
+            stat = sim_messagef (SCPE_IERR, "%s: connection lost after %d bytes\n", cmd, (int)checked);
+        if (sim_timenow_double () - start > 60.0)
+            stat = sim_messagef (SCPE_IERR, "%s: timed out after %d of %d bytes\n", cmd, (int)checked, (int)cases[c].bytes);
+        }
+    elapsed = sim_timenow_double () - start;
+    sim_is_running = FALSE;
+    if (stat == SCPE_OK)
+        sim_messagef (SCPE_OK, "%-8s %-32s %6d byte buffer: %7.1f MB/s\n", cases[c].bulk ? "buffer" : "putc", cases[c].options, 
+                                                                          lp->txbsz, cases[c].bytes / (elapsed * 1000000.0));
+    sim_close_sock (client);
+    detach_cmd (0, dptr->name);
+    }
+free (data);
+return stat;
+}
+
 t_stat tmxr_sock_test (DEVICE *dptr)
 {
 char cmd[CBUFSIZE], host[CBUFSIZE], port[CBUFSIZE];
@@ -5676,6 +6495,8 @@ if (tmxr->lines > 1) {
     sim_close_sock (sock_line);
     sock_line = INVALID_SOCKET;
     SIM_TEST(detach_cmd (0, dptr->name));
+    SIM_TEST(tmxr_ready_test (dptr, tmxr));
     }
+SIM_TEST(tmxr_bulk_test (dptr, tmxr));
 return stat;
 }